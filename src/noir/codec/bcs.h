@@ -215,6 +215,19 @@ datastream<Stream>& operator>>(datastream<Stream>& ds, std::string& v) {
   return ds;
 }
 
+// Pairs
+template<typename Stream, typename T, typename U>
+datastream<Stream>& operator<<(datastream<Stream>& ds, const std::pair<T, U>& v) {
+  ds << v.first << v.second;
+  return ds;
+}
+
+template<typename Stream, typename T, typename U>
+datastream<Stream>& operator>>(datastream<Stream>& ds, std::pair<T, U>& v) {
+  ds >> v.first >> v.second;
+  return ds;
+}
+
 // Tuples
 template<typename Stream, typename... Ts>
 datastream<Stream>& operator<<(datastream<Stream>& ds, const std::tuple<Ts...>& v) {
@@ -0,0 +1,245 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#pragma once
+#include <boost/functional/hash.hpp>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <vector>
+
+namespace noir {
+
+/// \brief fixed-capacity concurrent cache evicting with the CLOCK (second chance) algorithm
+///
+/// Slots are allocated once at construction and split into segments, each with its own lock, clock hand and
+/// open-addressing index, so nothing is allocated afterwards unless K or T do. Lookups take a segment's shared lock and
+/// only set the slot's reference bit; put evicts the first unreferenced slot past the hand, clearing reference bits on
+/// the way. Caches under min_segment_slots * 2 slots use a single segment and so evict in exact CLOCK order.
+template<typename K, typename T, typename Hash = boost::hash<K>>
+class clock_cache {
+public:
+  static constexpr size_t min_segment_slots = 1024;
+
+  explicit clock_cache(size_t capacity = 100000, size_t max_segments = 16)
+    : capacity_(capacity),
+      segments_(std::clamp<size_t>(capacity / min_segment_slots, 1, std::max<size_t>(max_segments, 1))) {
+    auto num_segments = segments_.size();
+    for (size_t i = 0; i < num_segments; i++) {
+      segments_[i].init(capacity / num_segments + (i < capacity % num_segments));
+    }
+  }
+
+  size_t size() const {
+    size_t count = 0;
+    for (const auto& seg : segments_) {
+      count += seg.count.load(std::memory_order_relaxed);
+    }
+    return count;
+  }
+
+  size_t capacity() const {
+    return capacity_;
+  }
+
+  bool has(const K& key) const {
+    auto h = Hash{}(key);
+    auto& seg = segment_for(h);
+    std::shared_lock lock(seg.mtx);
+    return seg.find(key, h) != npos;
+  }
+
+  /// \brief returns a copy of the cached item and marks it as recently used
+  std::optional<T> get(const K& key) {
+    auto h = Hash{}(key);
+    auto& seg = segment_for(h);
+    std::shared_lock lock(seg.mtx);
+    if (auto pos = seg.find(key, h); pos != npos) {
+      auto& s = seg.slots[seg.index[pos]];
+      s.referenced.store(true, std::memory_order_relaxed);
+      return s.value;
+    }
+    return std::nullopt;
+  }
+
+  /// \brief inserts or updates an item, evicting another one if the segment is full
+  /// \return true if key was not in the cache
+  bool put(const K& key, const T& item) {
+    auto h = Hash{}(key);
+    auto& seg = segment_for(h);
+    std::unique_lock lock(seg.mtx);
+    if (auto pos = seg.find(key, h); pos != npos) {
+      auto& s = seg.slots[seg.index[pos]];
+      s.value = item;
+      s.referenced.store(true, std::memory_order_relaxed);
+      return false;
+    }
+    if (!seg.capacity) {
+      return true;
+    }
+    auto slot = seg.free.empty() ? seg.evict() : seg.pop_free();
+    auto& s = seg.slots[slot];
+    s.key = key;
+    s.value = item;
+    s.hash = h;
+    s.used = true;
+    s.referenced.store(false, std::memory_order_relaxed);
+    seg.insert_index(slot);
+    seg.count.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  bool del(const K& key) {
+    auto h = Hash{}(key);
+    auto& seg = segment_for(h);
+    std::unique_lock lock(seg.mtx);
+    auto pos = seg.find(key, h);
+    if (pos == npos) {
+      return false;
+    }
+    seg.release(pos);
+    return true;
+  }
+
+  void reset() {
+    for (auto& seg : segments_) {
+      std::unique_lock lock(seg.mtx);
+      seg.clear();
+    }
+  }
+
+private:
+  static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+  struct slot {
+    K key{};
+    T value{};
+    size_t hash = 0;
+    bool used = false;
+    std::atomic<bool> referenced = false;
+
+    void reset() {
+      key = K{};
+      value = T{};
+      used = false;
+      referenced.store(false, std::memory_order_relaxed);
+    }
+  };
+
+  struct segment {
+    mutable std::shared_mutex mtx;
+    std::unique_ptr<slot[]> slots;
+    std::vector<uint32_t> index; // positions in slots, npos when empty; at least twice as large as capacity
+    std::vector<uint32_t> free; // unused slots, lowest last
+    size_t capacity = 0;
+    size_t hand = 0;
+    std::atomic<size_t> count = 0;
+
+    void init(size_t cap) {
+      capacity = cap;
+      slots = std::make_unique<slot[]>(cap);
+      index.resize(std::bit_ceil(std::max<size_t>(cap * 2, 2)));
+      free.reserve(cap);
+      clear();
+    }
+
+    void clear() {
+      for (size_t i = 0; i < capacity; i++) {
+        if (slots[i].used) {
+          slots[i].reset();
+        }
+      }
+      std::fill(index.begin(), index.end(), npos);
+      free.clear();
+      for (size_t i = 0; i < capacity; i++) {
+        free.push_back(uint32_t(capacity - 1 - i));
+      }
+      hand = 0;
+      count = 0;
+    }
+
+    size_t mask() const {
+      return index.size() - 1;
+    }
+
+    /// returns the position of key in index, or npos
+    uint32_t find(const K& key, size_t h) const {
+      for (auto pos = h & mask();; pos = (pos + 1) & mask()) {
+        auto i = index[pos];
+        if (i == npos) {
+          return npos;
+        }
+        if (slots[i].hash == h && slots[i].key == key) {
+          return uint32_t(pos);
+        }
+      }
+    }
+
+    void insert_index(uint32_t i) {
+      auto pos = slots[i].hash & mask();
+      while (index[pos] != npos) {
+        pos = (pos + 1) & mask();
+      }
+      index[pos] = i;
+    }
+
+    uint32_t pop_free() {
+      auto i = free.back();
+      free.pop_back();
+      return i;
+    }
+
+    /// clears index[pos] and its slot; later entries of the probe run are shifted back so lookups need no tombstones
+    void erase_index(size_t pos) {
+      slots[index[pos]].reset();
+      index[pos] = npos;
+      count.fetch_sub(1, std::memory_order_relaxed);
+      for (auto next = (pos + 1) & mask(); index[next] != npos; next = (next + 1) & mask()) {
+        auto home = slots[index[next]].hash & mask();
+        // moves the entry at next into the hole unless its home lies cyclically in (pos, next]
+        if (((next - home) & mask()) >= ((next - pos) & mask())) {
+          index[pos] = index[next];
+          index[next] = npos;
+          pos = next;
+        }
+      }
+    }
+
+    void release(uint32_t pos) {
+      auto i = index[pos];
+      erase_index(pos);
+      free.push_back(i);
+    }
+
+    /// frees the first unreferenced slot past the hand and returns it
+    uint32_t evict() {
+      for (;;) {
+        auto i = uint32_t(hand);
+        hand = (hand + 1) % capacity;
+        auto& s = slots[i];
+        if (!s.used || s.referenced.exchange(false, std::memory_order_relaxed)) {
+          continue;
+        }
+        erase_index(find(s.key, s.hash));
+        return i;
+      }
+    }
+  };
+
+  segment& segment_for(size_t h) const {
+    // index lookups use the low bits of h, so the segment is picked from mixed high bits
+    return segments_[((h * 0x9e3779b97f4a7c15ull) >> 32) % segments_.size()];
+  }
+
+  size_t capacity_;
+  mutable std::vector<segment> segments_;
+};
+
+} // namespace noir
@@ -0,0 +1,74 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#include <catch2/catch_all.hpp>
+#include <noir/common/clock_cache.h>
+#include <random>
+#include <thread>
+
+using namespace noir;
+
+TEST_CASE("clock_cache: eviction", "[noir][common]") {
+  auto c = clock_cache<int, int>(4);
+  for (auto i = 0; i < 4; i++) {
+    CHECK(c.put(i, i));
+  }
+  CHECK(c.size() == 4);
+
+  // 0 and 1 are referenced, so the hand passes over them and evicts 2
+  CHECK(c.get(0) == 0);
+  CHECK(!c.put(1, 10));
+  CHECK(c.put(4, 4));
+  CHECK(c.size() == 4);
+  CHECK(!c.has(2));
+  CHECK(c.get(1) == 10);
+
+  // a deleted slot is reused before anything is evicted
+  CHECK(c.del(3));
+  CHECK(!c.del(3));
+  CHECK(c.put(5, 5));
+  CHECK(c.has(0));
+  CHECK(c.has(1));
+  CHECK(c.has(4));
+
+  c.reset();
+  CHECK(c.size() == 0);
+  CHECK(!c.has(0));
+  CHECK(c.put(0, 0));
+}
+
+TEST_CASE("clock_cache: segments", "[noir][common]") {
+  auto capacity = 10000;
+  auto c = clock_cache<uint64_t, uint64_t>(capacity);
+
+  auto mismatches = std::atomic<int>(0);
+  auto threads = std::vector<std::thread>();
+  for (auto t = 0; t < 8; t++) {
+    threads.emplace_back([&, t]() {
+      auto gen = std::mt19937_64(t);
+      for (auto i = 0; i < 100000; i++) {
+        auto key = gen() % (capacity * 3);
+        if (i % 3 == 0) {
+          c.put(key, key);
+        } else if (i % 7 == 0) {
+          c.del(key);
+        } else if (auto value = c.get(key); value && *value != key) {
+          mismatches++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  CHECK(mismatches == 0);
+  CHECK(c.size() <= c.capacity());
+  size_t found = 0;
+  for (uint64_t key = 0; key < capacity * 3; key++) {
+    found += c.has(key);
+  }
+  CHECK(found == c.size());
+}
@@ -18,6 +18,11 @@ void MempoolConfig::bind(CLI::App& root) {
 #   1) "v0" - The legacy non-prioritized mempool reactor.
 #   2) "v1" (default) - The prioritized mempool reactor.)");
   mempool->add_option("--recheck", recheck);
+  mempool->add_option("--recheck-window", recheck_window, R"(
+# Maximum number of recheck requests waiting for a response from the app.
+# Rechecking stops sending new requests until the oldest one is answered.)");
+  mempool->add_option("--recheck-batch-size", recheck_batch_size, R"(
+# Number of recheck requests sent to the app before each flush.)");
   mempool->add_option("--broadcast", broadcast);
   mempool->add_option("--size", size, "Maximum number of transactions in the mempool");
   mempool->add_option("--max-txs-bytes", max_txs_bytes, R"(
@@ -51,6 +56,11 @@ void MempoolConfig::bind(CLI::App& root) {
 # Note, if ttl-duration is also defined, a transaction will be removed if it
 # has existed in the mempool at least ttl-num-blocks number of blocks or if
 # it's insertion time into the mempool is beyond ttl-duration.)");
+  mempool->add_option("--journal-path", journal_path, R"(
+# journal-path, if non-empty, is the file admitted transactions are journaled to,
+# relative to the root directory unless absolute. On startup, transactions in the
+# journal are put back into the mempool and rechecked, instead of waiting for
+# them to be gossiped again.)");
 }
 
 } // namespace noir::config
@@ -12,6 +12,8 @@ struct MempoolConfig {
   std::string version;
   std::string root_dir;
   bool recheck;
+  int recheck_window;
+  int recheck_batch_size;
   bool broadcast;
   int size;
   int64_t max_txs_bytes;
@@ -21,10 +23,13 @@ struct MempoolConfig {
   int max_batch_bytes;
   std::chrono::system_clock::duration ttl_duration;
   int64_t ttl_num_blocks;
+  std::string journal_path;
 
   MempoolConfig() {
     version = "v1";
     recheck = true;
+    recheck_window = 256;
+    recheck_batch_size = 64;
     broadcast = true;
     size = 5000;
     max_txs_bytes = 1024 * 1024 * 1024; // 1GB
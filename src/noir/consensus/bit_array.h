@@ -9,6 +9,7 @@
 #include <tendermint/libs/bits/types.pb.h>
 
 #include <algorithm>
+#include <bit>
 #include <memory>
 #include <mutex>
 #include <random>
@@ -16,18 +17,21 @@
 
 namespace noir::consensus {
 
+/// \brief bit set packed into 64-bit words, wire compatible with tendermint's BitArray
+/// Bits beyond `bits` in the last word are always kept zero, so set operations and popcounts can work on whole
+/// words without masking each step.
 struct bit_array : public std::enable_shared_from_this<bit_array> {
   int bits{};
-  std::vector<bool> elem;
+  std::vector<uint64_t> elems;
   std::mutex mtx;
 
   bit_array() = default;
-  bit_array(const bit_array& b): bits(b.bits), elem(b.elem) {}
+  bit_array(const bit_array& b): bits(b.bits), elems(b.elems) {}
 
   static std::shared_ptr<bit_array> new_bit_array(int bits_) {
     auto ret = std::make_shared<bit_array>();
     ret->bits = bits_;
-    ret->elem.resize(bits_);
+    ret->elems.resize(ret->num_elems(bits_));
     return ret;
   }
 
@@ -50,9 +54,9 @@ struct bit_array : public std::enable_shared_from_this<bit_array> {
       return false;
     }
     std::scoped_lock g(mtx);
-    if (i >= bits)
+    if (i < 0 || i >= bits)
       return false;
-    return elem[i];
+    return (elems[i / 64] >> (i % 64)) & 1;
   }
 
   bool set_index(int i, bool v) {
@@ -60,9 +64,12 @@ struct bit_array : public std::enable_shared_from_this<bit_array> {
       return false;
     }
     std::scoped_lock g(mtx);
-    if (i >= bits)
+    if (i < 0 || i >= bits)
       return false;
-    elem[i] = v;
+    if (v)
+      elems[i / 64] |= uint64_t(1) << (i % 64);
+    else
+      elems[i / 64] &= ~(uint64_t(1) << (i % 64));
     return true;
   }
 
@@ -70,7 +77,10 @@ struct bit_array : public std::enable_shared_from_this<bit_array> {
     if (this == nullptr || o == nullptr)
       return nullptr;
     std::scoped_lock<std::mutex, std::mutex> g(mtx, o->mtx);
-    elem = o->elem;
+    auto smaller = std::min(elems.size(), o->elems.size());
+    std::copy_n(o->elems.begin(), smaller, elems.begin());
+    std::fill(elems.begin() + smaller, elems.end(), 0);
+    mask_tail();
     return shared_from_this();
   }
 
@@ -79,10 +89,12 @@ struct bit_array : public std::enable_shared_from_this<bit_array> {
       return nullptr;
     std::scoped_lock<std::mutex, std::mutex> g(mtx, o->mtx);
     auto c = copy_bits(bits);
-    auto smaller = std::min(elem.size(), o->elem.size());
-    for (auto i = 0; i < smaller; i++)
-      c->elem[i] = c->elem[i] & (~o->elem[i]); // and not
-    return c; // TODO: check if sub is correctly implemented
+    auto smaller = std::min(elems.size(), o->elems.size());
+    auto* dst = c->elems.data();
+    const auto* src = o->elems.data();
+    for (size_t i = 0; i < smaller; i++)
+      dst[i] &= ~src[i]; // and not
+    return c;
   }
 
   /// \brief returns a bit_array resulting from a bitwise OR of two bit_arrays
@@ -95,9 +107,10 @@ struct bit_array : public std::enable_shared_from_this<bit_array> {
       return copy();
     std::scoped_lock<std::mutex, std::mutex> g(mtx, o->mtx);
     auto c = copy_bits(std::max(bits, o->bits));
-    auto smaller = std::min(elem.size(), o->elem.size());
-    for (auto i = 0; i < smaller; i++)
-      c->elem[i] = c->elem[i] | (o->elem[i]); // or
+    auto* dst = c->elems.data();
+    const auto* src = o->elems.data();
+    for (size_t i = 0; i < o->elems.size(); i++)
+      dst[i] |= src[i]; // or
     return c;
   }
 
@@ -106,8 +119,9 @@ struct bit_array : public std::enable_shared_from_this<bit_array> {
       return nullptr;
     std::scoped_lock g(mtx);
     auto c = copy();
-    for (auto&& e : c->elem)
-      e = !e;
+    for (auto& e : c->elems)
+      e = ~e;
+    c->mask_tail();
     return c;
   }
 
@@ -116,15 +130,15 @@ struct bit_array : public std::enable_shared_from_this<bit_array> {
       return nullptr;
     auto copy = std::make_shared<bit_array>();
     copy->bits = bits;
-    copy->elem = elem;
+    copy->elems = elems;
     return copy;
   }
 
+  /// \brief returns a copy resized to bits_, truncating or zero-extending the current bits
   std::shared_ptr<bit_array> copy_bits(int bits_) const {
-    auto ret = std::make_shared<bit_array>();
-    ret->bits = bits_;
-    ret->elem.resize(bits_);
-    std::copy(elem.begin(), elem.begin() + bits_, ret->elem.begin());
+    auto ret = new_bit_array(bits_);
+    std::copy_n(elems.begin(), std::min(elems.size(), ret->elems.size()), ret->elems.begin());
+    ret->mask_tail();
     return ret;
   }
 
@@ -132,13 +146,17 @@ struct bit_array : public std::enable_shared_from_this<bit_array> {
     return (bits_ + 63) / 64;
   }
 
+  /// \brief clears the unused high bits of the last word
+  void mask_tail() {
+    if (bits % 64 != 0 && !elems.empty())
+      elems.back() &= (uint64_t(1) << (bits % 64)) - 1;
+  }
+
   std::string string() const {
-    std::string ret{};
-    for (auto e : elem) {
-      if (e)
-        ret.append("x");
-      else
-        ret.append("_");
+    std::string ret(std::max(bits, 0), '_');
+    for (auto i = 0; i < bits; i++) {
+      if ((elems[i / 64] >> (i % 64)) & 1)
+        ret[i] = 'x';
     }
     return ret;
   }
@@ -147,39 +165,43 @@ struct bit_array : public std::enable_shared_from_this<bit_array> {
     auto num_bytes = (bits + 7) / 8;
     Bytes bs;
     bs.raw().reserve(num_bytes);
-    for (auto i = 0; i < bits; i += 8) {
-      uint8_t byte_{};
-      for (auto j = 0; j < 8 && (j + i) < bits; j++) {
-        if (elem[j + i]) {
-          byte_ |= 1 << j;
-        } else {
-          byte_ &= ~(1 << j);
-        }
-      }
-      bs.raw().push_back(static_cast<unsigned char>(byte_));
-    }
+    for (auto i = 0; i < num_bytes; i++)
+      bs.raw().push_back(static_cast<unsigned char>(elems[i / 8] >> ((i % 8) * 8)));
     return bs;
   }
 
   /// \brief returns a random index for a bit. If there is no value, returns 0, false
   std::tuple<int, bool> pick_random() {
-    if (this == nullptr || elem.empty())
+    if (this == nullptr || elems.empty())
       return {0, false};
     std::scoped_lock g(mtx);
-    auto true_indices = get_true_indices();
-    if (true_indices.empty())
+    int total{0};
+    for (auto e : elems)
+      total += std::popcount(e);
+    if (total == 0)
       return {0, false};
-    std::vector<int> result;
-    std::sample(
-      true_indices.begin(), true_indices.end(), std::back_inserter(result), 1, std::mt19937{std::random_device{}()});
-    return {result[0], true};
+
+    static thread_local std::mt19937 rng{std::random_device{}()};
+    auto n = std::uniform_int_distribution<int>(0, total - 1)(rng);
+    for (size_t i = 0; i < elems.size(); i++) {
+      auto e = elems[i];
+      auto count = std::popcount(e);
+      if (n >= count) {
+        n -= count;
+        continue;
+      }
+      for (; n > 0; n--)
+        e &= e - 1; // drop the lowest set bit
+      return {static_cast<int>(i * 64) + std::countr_zero(e), true};
+    }
+    return {0, false};
   }
 
   std::vector<int> get_true_indices() {
     std::vector<int> ret;
-    for (auto i = 0; i < elem.size(); i++) {
-      if (elem[i])
-        ret.push_back(i);
+    for (size_t i = 0; i < elems.size(); i++) {
+      for (auto e = elems[i]; e != 0; e &= e - 1)
+        ret.push_back(static_cast<int>(i * 64) + std::countr_zero(e));
     }
     return ret;
   }
@@ -196,56 +218,30 @@ struct bit_array : public std::enable_shared_from_this<bit_array> {
   inline friend T& operator>>(T& ds, bit_array& v) {
     ds >> v.bits;
     auto num_bytes = (v.bits + 7) / 8;
-    v.elem.resize(v.bits);
+    v.elems.assign(v.num_elems(v.bits), 0);
     Bytes bs(num_bytes);
     ds >> bs;
-    int i{0};
-    for (const auto& byte_ : bs) {
-      for (auto j = 0; j < 8; j++) {
-        if ((byte_ >> j) & 1)
-          v.set_index(i, true);
-        else
-          v.set_index(i, false);
-        i++;
-      }
-    }
+    for (size_t i = 0; i < bs.size() && i / 8 < v.elems.size(); i++)
+      v.elems[i / 8] |= uint64_t(bs[i]) << ((i % 8) * 8);
+    v.mask_tail();
     return ds;
   }
 
   static std::unique_ptr<::tendermint::libs::bits::BitArray> to_proto(const bit_array& b) {
     auto ret = std::make_unique<::tendermint::libs::bits::BitArray>();
     ret->set_bits(b.bits);
-
-    size_t elems_size = b.num_elems(b.bits);
-    std::vector<uint64_t> elems(elems_size);
-    auto bz = b.get_bytes();
-    int bz_i{0};
-    for (auto& elem : elems) {
-      elem = 0;
-      for (auto i = 0; i < 8 && bz_i < bz.size(); i++, bz_i++)
-        elem |= (uint64_t)bz[bz_i] << (i * 8);
-    }
-
     auto pb_elem = ret->mutable_elems();
-    for (const auto& e : elems)
+    pb_elem->Reserve(b.elems.size());
+    for (const auto& e : b.elems)
       pb_elem->Add(e);
     return ret;
   }
 
   static std::shared_ptr<bit_array> from_proto(const ::tendermint::libs::bits::BitArray& pb) {
-    auto ret = std::make_shared<bit_array>();
-    ret->bits = pb.bits();
-    ret->elem.resize(ret->bits);
-    int i{0};
-    for (auto e : pb.elems()) {
-      for (auto j = 0; j < 64; j++) {
-        if ((e >> j) & 1)
-          ret->set_index(i, true);
-        else
-          ret->set_index(i, false);
-        i++;
-      }
-    }
+    auto ret = new_bit_array(pb.bits());
+    auto smaller = std::min<size_t>(ret->elems.size(), pb.elems_size());
+    std::copy_n(pb.elems().begin(), smaller, ret->elems.begin());
+    ret->mask_tail();
     return ret;
   }
 };
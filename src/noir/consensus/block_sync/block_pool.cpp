@@ -8,9 +8,28 @@
 #include <noir/common/overloaded.h>
 #include <noir/consensus/block_sync/block_pool.h>
 #include <tendermint/blocksync/types.pb.h>
+#include <google/protobuf/io/coded_stream.h>
 
 namespace noir::consensus::block_sync {
 
+namespace {
+  /// \brief frames an already encoded block as Message{block_response: BlockResponse{block: bz}} without parsing it
+  Bytes encode_block_response(const Bytes& bz) {
+    using google::protobuf::io::CodedOutputStream;
+    constexpr uint8_t block_tag = (1 << 3) | 2; // BlockResponse.block, length-delimited
+    constexpr uint8_t block_response_tag = (3 << 3) | 2; // Message.block_response, length-delimited
+    uint32_t inner_size = 1 + CodedOutputStream::VarintSize32(bz.size()) + bz.size();
+    Bytes ret(1 + CodedOutputStream::VarintSize32(inner_size) + inner_size);
+    auto p = ret.data();
+    *p++ = block_response_tag;
+    p = CodedOutputStream::WriteVarint32ToArray(inner_size, p);
+    *p++ = block_tag;
+    p = CodedOutputStream::WriteVarint32ToArray(bz.size(), p);
+    std::copy(bz.begin(), bz.end(), p);
+    return ret;
+  }
+} // namespace
+
 std::tuple<std::shared_ptr<block>, std::shared_ptr<block>> block_pool::peek_two_blocks() {
   std::scoped_lock g(mtx);
   std::shared_ptr<block> first(nullptr);
@@ -188,6 +207,12 @@ void block_pool::transmit_new_envelope(const std::string& to, const p2p::bs_reac
   new_env->broadcast = false; // always false for block_sync
   new_env->id = p2p::BlockSync;
 
+  if (auto* res = std::get_if<consensus::block_response>(&bs_msg); res) {
+    new_env->message = encode_block_response(res->block_);
+    xmt_mq_channel.publish(priority, new_env);
+    return;
+  }
+
   // Use protobuf
   ::tendermint::blocksync::Message pb_msg;
   std::visit(
@@ -198,10 +223,7 @@ void block_pool::transmit_new_envelope(const std::string& to, const p2p::bs_reac
         auto req = pb_msg.mutable_block_request();
         req->set_height(msg.height);
       },
-      [&pb_msg](const consensus::block_response& msg) {
-        auto res = pb_msg.mutable_block_response();
-        *res->mutable_block() = codec::protobuf::decode<::tendermint::types::Block>(msg.block_);
-      },
+      [](const consensus::block_response& msg) {}, // framed by encode_block_response
       [&pb_msg](const consensus::status_request& msg) { auto req = pb_msg.mutable_status_request(); },
       [&pb_msg](const consensus::status_response& msg) {
         auto res = pb_msg.mutable_status_response();
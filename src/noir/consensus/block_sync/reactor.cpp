@@ -202,10 +202,9 @@ void reactor::switch_to_consensus_ticker() {
 }
 
 void reactor::respond_to_peer(std::shared_ptr<consensus::block_request> msg, const std::string& peer_id) {
-  block block_;
-  if (store->load_block(msg->height, block_)) {
-    auto response = block_response{};
-    response.block_ = codec::protobuf::encode(*block::to_proto(block_)); // serialized when put into a response
+  auto response = block_response{};
+  // stored block data is already protobuf-encoded, so serve it as is without a parse/re-encode round trip
+  if (store->load_block_bytes(msg->height, response.block_)) {
     pool->transmit_new_envelope(peer_id, response);
     return;
   }
@@ -49,9 +49,11 @@ struct base_config {
   std::string node_key;
   std::string abci;
   bool filter_peers;
+  size_t block_cache_size; ///< number of decoded blocks, metas and commits kept by block_store
 
   static base_config get_default() {
     base_config cfg;
+    cfg.block_cache_size = 128;
     cfg.genesis = "genesis.json";
     cfg.node_key = "node_key.json";
     cfg.mode = Full;
@@ -66,6 +68,7 @@ struct consensus_config {
   std::string root_dir;
   std::string wal_path;
   std::string wal_file; ///< overrides WalPath if set
+  bool wal_group_commit; ///< coalesces concurrent WAL writes into batched write and fsync
 
   std::chrono::system_clock::duration timeout_propose;
   std::chrono::system_clock::duration timeout_propose_delta;
@@ -88,6 +91,7 @@ struct consensus_config {
   static consensus_config get_default() {
     consensus_config cfg;
     cfg.wal_path = std::string(default_data_dir) + "/" + "cs.wal";
+    cfg.wal_group_commit = false;
     cfg.timeout_propose = std::chrono::milliseconds{3000};
     cfg.timeout_propose_delta = std::chrono::milliseconds{500};
     cfg.timeout_prevote = std::chrono::milliseconds{1000};
@@ -181,9 +185,9 @@ struct config {
 } // namespace noir::consensus
 
 NOIR_REFLECT(noir::consensus::base_config, chain_id, root_dir, proxy_app, moniker, mode, fast_sync_mode, db_backend,
-  db_path, log_level, log_format, genesis, node_key, abci, filter_peers);
-NOIR_REFLECT(noir::consensus::consensus_config, root_dir, wal_path, wal_file, timeout_propose, timeout_propose_delta,
-  timeout_prevote, timeout_prevote_delta, timeout_precommit, timeout_precommit_delta, timeout_commit,
-  skip_timeout_commit, create_empty_blocks, create_empty_blocks_interval, peer_gossip_sleep_duration,
+  db_path, log_level, log_format, genesis, node_key, abci, filter_peers, block_cache_size);
+NOIR_REFLECT(noir::consensus::consensus_config, root_dir, wal_path, wal_file, wal_group_commit, timeout_propose,
+  timeout_propose_delta, timeout_prevote, timeout_prevote_delta, timeout_precommit, timeout_precommit_delta,
+  timeout_commit, skip_timeout_commit, create_empty_blocks, create_empty_blocks_interval, peer_gossip_sleep_duration,
   peer_query_maj_23_sleep_duration, double_sign_check_height);
 NOIR_REFLECT(noir::consensus::config, base, consensus, priv_validator);
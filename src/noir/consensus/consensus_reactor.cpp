@@ -142,6 +142,17 @@ void consensus_reactor::process_peer_msg(p2p::envelope_ptr info) {
       },
       [&ps](p2p::proposal_pol_message& msg) { ps->apply_proposal_pol_message(msg); },
       [this, &ps, &from](p2p::block_part_message& msg) {
+        std::unique_lock<std::mutex> lock(cs_state->mtx);
+        std::shared_ptr<part_set> parts;
+        if (msg.height == cs_state->rs.height)
+          parts = cs_state->rs.proposal_block_parts;
+        lock.unlock();
+
+        // Check the proof here, in parallel with other peers, so that consensus_state only compares the part's bytes
+        // while holding its lock. Invalid parts are rejected when consensus_state adds them.
+        if (parts)
+          parts->verify_part(std::make_shared<part>(part{msg.index, msg.bytes_, msg.proof}));
+
         ps->set_has_proposal_block_part(msg.height, msg.round, msg.index);
         internal_mq_channel.publish(
           appbase::priority::medium, std::make_shared<p2p::internal_msg_info>(p2p::internal_msg_info{msg, from}));
@@ -153,8 +164,20 @@ void consensus_reactor::process_peer_msg(p2p::envelope_ptr info) {
         auto height = cs_state->rs.height;
         auto val_size = cs_state->rs.validators->size();
         auto last_commit_size = cs_state->rs.last_commit->get_size();
+        std::shared_ptr<vote_set> votes;
+        if (msg.height == height && msg.type == p2p::Prevote)
+          votes = cs_state->rs.votes->prevotes(msg.round);
+        else if (msg.height == height && msg.type == p2p::Precommit)
+          votes = cs_state->rs.votes->precommits(msg.round);
+        else if (msg.height + 1 == height && msg.type == p2p::Precommit && last_commit_size > 0)
+          votes = cs_state->rs.last_commit;
         lock.unlock();
 
+        // Verify the signature here, in parallel with other peers, so that consensus_state only updates the tally
+        // while holding its lock. Errors are reported when consensus_state adds the vote.
+        if (votes)
+          votes->verify_vote(vote{msg});
+
         ps->ensure_vote_bit_arrays(height, val_size);
         ps->ensure_vote_bit_arrays(height - 1, last_commit_size);
         ps->set_has_vote(msg);
@@ -203,7 +203,8 @@ bool consensus_state::load_wal_file() {
     } else {
       fs::create_directories(wal_file_path);
     }
-    wal_ = std::make_unique<base_wal>(wal_file_path.string(), wal_head_name, wal_file_num, wal_file_size);
+    wal_ = std::make_unique<base_wal>(
+      wal_file_path.string(), wal_head_name, wal_file_num, wal_file_size, cs_config.wal_group_commit);
   } catch (...) {
     elog("failed to start wal");
     return false;
@@ -1045,7 +1046,7 @@ void consensus_state::set_proposal(p2p::proposal_message& msg) {
   }
 
   // Verify signature
-  auto sign_bytes = proposal::proposal_sign_bytes(local_state.chain_id, *proposal::to_proto({msg}));
+  auto sign_bytes = proposal::proposal_sign_bytes(local_state.chain_id, msg);
   if (!rs.validators->get_proposer()->pub_key_.verify_signature(sign_bytes, msg.signature)) {
     elog("set_proposal; error invalid proposal signature");
     return;
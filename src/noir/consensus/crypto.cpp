@@ -4,8 +4,11 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 //
 #include <noir/common/check.h>
+#include <noir/common/thread_pool.h>
 #include <noir/consensus/common.h>
 #include <noir/consensus/crypto.h>
+#include <atomic>
+#include <thread>
 
 extern "C" {
 #include <sodium.h>
@@ -35,6 +38,14 @@ namespace detail {
       return true;
     return false;
   }
+
+  /// batches up to this size are verified on the calling thread
+  constexpr size_t batch_chunk_size{16};
+
+  named_thread_pool& verify_pool() {
+    static named_thread_pool pool("sigver", std::max(1u, std::thread::hardware_concurrency()));
+    return pool;
+  }
 } // namespace detail
 
 Bytes pub_key::address() {
@@ -74,4 +85,51 @@ std::string priv_key::get_type() const {
   return std::string(key_type);
 }
 
+size_t batch_verifier::add(const pub_key& key, Bytes msg, Bytes sig) {
+  entries_.push_back({key.key, std::move(msg), std::move(sig)});
+  return entries_.size() - 1;
+}
+
+bool batch_verifier::verify_entry(size_t index) const {
+  const auto& e = entries_[index];
+  if (e.sig.size() != signature_size || e.key.size() != pub_key_size)
+    return false;
+  return detail::verify(e.sig, e.msg, e.key);
+}
+
+std::optional<size_t> batch_verifier::verify() const {
+  auto total = entries_.size();
+  if (total <= detail::batch_chunk_size) {
+    for (size_t i = 0; i < total; ++i) {
+      if (!verify_entry(i))
+        return i;
+    }
+    return std::nullopt;
+  }
+
+  // Chunks ahead of the lowest failure found so far still run so that the reported index is the first invalid one
+  std::atomic<size_t> first_invalid{total};
+  std::vector<std::future<void>> futures;
+  futures.reserve((total + detail::batch_chunk_size - 1) / detail::batch_chunk_size);
+  for (size_t begin = 0; begin < total; begin += detail::batch_chunk_size) {
+    auto end = std::min(begin + detail::batch_chunk_size, total);
+    futures.push_back(async_thread_pool(detail::verify_pool().get_executor(), [this, begin, end, &first_invalid]() {
+      for (auto i = begin; i < end && i < first_invalid.load(std::memory_order_relaxed); ++i) {
+        if (!verify_entry(i)) {
+          auto cur = first_invalid.load(std::memory_order_relaxed);
+          while (i < cur && !first_invalid.compare_exchange_weak(cur, i, std::memory_order_relaxed)) {
+          }
+          return;
+        }
+      }
+    }));
+  }
+  for (auto& f : futures)
+    f.get();
+
+  if (auto ret = first_invalid.load(); ret < total)
+    return ret;
+  return std::nullopt;
+}
+
 } // namespace noir::consensus
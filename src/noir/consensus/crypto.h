@@ -8,6 +8,7 @@
 #include <noir/common/refl.h>
 #include <noir/core/result.h>
 #include <tendermint/crypto/keys.pb.h>
+#include <optional>
 
 namespace noir::consensus {
 
@@ -72,6 +73,36 @@ struct priv_key {
   }
 };
 
+/// \brief verifies a set of ed25519 signatures, spreading them across a shared thread pool
+class batch_verifier {
+public:
+  /// \brief adds a signature to the batch
+  /// \param[in] key public key of the signer
+  /// \param[in] msg signed message
+  /// \param[in] sig signature to verify
+  /// \return index of the signature within the batch
+  size_t add(const pub_key& key, Bytes msg, Bytes sig);
+
+  size_t size() const {
+    return entries_.size();
+  }
+
+  /// \brief verifies all signatures added so far
+  /// \return index of the first invalid signature, std::nullopt if all signatures are valid
+  std::optional<size_t> verify() const;
+
+private:
+  struct entry {
+    Bytes key;
+    Bytes msg;
+    Bytes sig;
+  };
+
+  bool verify_entry(size_t index) const;
+
+  std::vector<entry> entries_;
+};
+
 } // namespace noir::consensus
 
 NOIR_REFLECT(noir::consensus::pub_key, key);
@@ -215,7 +215,7 @@ Result<void> evidence_pool::verify_light_client_attack(const light_client_attack
   std::shared_ptr<validator_set> common_vals) {
   if (common_header->header->height != ev.conflicting_block->s_header->header->height) {
     auto commit_ = ev.conflicting_block->s_header->commit;
-    auto ok = common_vals->verify_commit_light_trusting(trusted_header->header->chain_id, commit_); // TODO: check
+    auto ok = common_vals->verify_commit_light_trusting(trusted_header->header->chain_id, commit_, default_trust_level);
     if (!ok)
       return Error::format("skipping verification of conflicting block failed: {}", ok.error());
   } else if (ev.conflicting_header_is_invalid(trusted_header->header)) {
@@ -9,42 +9,43 @@ namespace noir::consensus::merkle {
 
 constexpr int max_aunts{100};
 
-std::pair<std::vector<std::shared_ptr<proof_node>>, std::shared_ptr<proof_node>> trails_from_bytes_list(
-  const bytes_list& items) {
-  switch (items.size()) {
-  case 0:
-    return {{}, std::make_shared<proof_node>(proof_node{get_empty_hash()})};
-  case 1: {
-    auto trail = std::make_shared<proof_node>(proof_node{leaf_hash_opt(items[0])});
-    return {{trail}, trail};
-  }
+namespace {
+  template<typename Item>
+  std::pair<Bytes, std::vector<std::shared_ptr<proof>>> proofs_from_items(std::span<const Item> items) {
+    if (items.empty())
+      return {get_empty_hash(), {}};
+
+    std::vector<node_hash> nodes;
+    std::vector<size_t> offsets;
+    hash_levels(items, nodes, offsets);
+    auto levels = offsets.size();
+
+    // aunts are collected from the leaf up; a node carried up without a sibling contributes none
+    std::vector<std::shared_ptr<proof>> proofs(items.size());
+    for (size_t i = 0; i < items.size(); i++) {
+      auto p = std::make_shared<proof>();
+      p->total = static_cast<int64_t>(items.size());
+      p->index = static_cast<int64_t>(i);
+      p->leaf_hash = {nodes[i].begin(), nodes[i].end()};
+      p->aunts.reserve(levels - 1);
+      auto index = i;
+      for (size_t l = 0; l + 1 < levels; l++, index /= 2) {
+        auto sibling = index ^ 1;
+        if (sibling < offsets[l + 1] - offsets[l])
+          p->aunts.emplace_back(nodes[offsets[l] + sibling].begin(), nodes[offsets[l] + sibling].end());
+      }
+      proofs[i] = std::move(p);
+    }
+    return {{nodes.back().begin(), nodes.back().end()}, std::move(proofs)};
   }
-  auto k = get_split_point(items.size());
-  auto [lefts, left_root] = trails_from_bytes_list({items.begin(), items.begin() + k});
-  auto [rights, right_root] = trails_from_bytes_list({items.begin() + k, items.end()});
-  auto root_hash = inner_hash_opt(left_root->hash, right_root->hash);
-  auto root = std::make_shared<proof_node>(proof_node{root_hash});
-  left_root->parent = root;
-  left_root->right = right_root;
-  right_root->parent = root;
-  right_root->left = left_root;
-  std::vector<std::shared_ptr<proof_node>> left_right;
-  left_right.reserve(lefts.size() + rights.size() + 1);
-  left_right.insert(left_right.end(), lefts.begin(), lefts.end());
-  left_right.insert(left_right.end(), rights.begin(), rights.end());
-  return {left_right, root};
+} // namespace
+
+std::pair<Bytes, std::vector<std::shared_ptr<proof>>> proofs_from_bytes_list(std::span<const Bytes> items) {
+  return proofs_from_items(items);
 }
 
-std::pair<Bytes, std::vector<std::shared_ptr<proof>>> proofs_from_bytes_list(const bytes_list& items) {
-  auto [trails, root_spn] = trails_from_bytes_list(items);
-  Bytes root_hash = root_spn->hash;
-  std::vector<std::shared_ptr<proof>> proofs;
-  proofs.resize(items.size());
-  for (auto i = 0; i < trails.size(); i++) {
-    proofs[i] = std::make_shared<proof>(
-      proof{static_cast<int64_t>(items.size()), i, trails[i]->hash, trails[i]->flatten_aunts()});
-  }
-  return {root_hash, proofs};
+std::pair<Bytes, std::vector<std::shared_ptr<proof>>> proofs_from_byte_slices(std::span<const byte_slice> items) {
+  return proofs_from_items(items);
 }
 
 } // namespace noir::consensus::merkle
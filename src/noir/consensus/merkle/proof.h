@@ -18,7 +18,7 @@ struct proof {
   Bytes leaf_hash{};
   bytes_list aunts{};
 
-  std::optional<std::string> verify(const Bytes& root_hash, const Bytes& leaf) {
+  std::optional<std::string> verify(const Bytes& root_hash, const Bytes& leaf) const {
     if (total < 0)
       return "proof total must be positive";
     if (index < 0)
@@ -58,37 +58,13 @@ struct proof {
   }
 };
 
-struct proof_node {
-  Bytes hash{};
-  std::shared_ptr<proof_node> parent{};
-  std::shared_ptr<proof_node> left{};
-  std::shared_ptr<proof_node> right{};
-
-  /// \brief returns inner hashes for the item corresponding to leaf, starting from a leaf proof_node
-  bytes_list flatten_aunts() {
-    if (!parent && !left && !right)
-      return {};
-    bytes_list inner_hashes{};
-    proof_node* cur = this;
-    while (cur != nullptr) {
-      if (cur->left != nullptr)
-        inner_hashes.push_back(cur->left->hash);
-      if (cur->right != nullptr)
-        inner_hashes.push_back(cur->right->hash);
-      cur = cur->parent.get();
-    }
-    return inner_hashes;
-  }
-};
-
-/// \brief recursively constructs merkle proofs
-std::pair<std::vector<std::shared_ptr<proof_node>>, std::shared_ptr<proof_node>> trails_from_bytes_list(
-  const bytes_list& items);
-
 /// \brief computes inclusion proof for given list
 /// \param items list of items used for generating proof
 /// \return list of proofs; proof[0] is the proof for list[0]
-std::pair<Bytes, std::vector<std::shared_ptr<proof>>> proofs_from_bytes_list(const bytes_list& items);
+std::pair<Bytes, std::vector<std::shared_ptr<proof>>> proofs_from_bytes_list(std::span<const Bytes> items);
+
+/// \brief computes inclusion proofs for items viewed in place, without copying them into Bytes
+std::pair<Bytes, std::vector<std::shared_ptr<proof>>> proofs_from_byte_slices(std::span<const byte_slice> items);
 
 } // namespace noir::consensus::merkle
 
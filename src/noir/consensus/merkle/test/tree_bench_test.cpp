@@ -0,0 +1,51 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#include <catch2/catch_all.hpp>
+#include <noir/consensus/merkle/proof.h>
+#include <noir/consensus/types/block.h>
+#include <noir/crypto/rand.h>
+
+using namespace noir;
+using namespace noir::consensus;
+
+TEST_CASE("MerkleTreeBenchmarks", "[noir][consensus]") {
+  static constexpr int num_txs = 10000;
+  static constexpr int tx_size = 250;
+
+  block_data data;
+  data.txs.resize(num_txs);
+  for (auto& tx : data.txs) {
+    tx = Bytes(tx_size);
+    crypto::rand_bytes(tx);
+  }
+
+  merkle::bytes_list tx_hashes;
+  for (const auto& tx : data.txs)
+    tx_hashes.push_back(crypto::Sha256()(tx));
+
+  BENCHMARK("HashFromBytesList") {
+    return merkle::hash_from_bytes_list(tx_hashes);
+  };
+
+  BENCHMARK("ProofsFromBytesList") {
+    return merkle::proofs_from_bytes_list(tx_hashes);
+  };
+
+  BENCHMARK("BlockDataHash") {
+    data.hash = {};
+    return data.get_hash();
+  };
+
+  auto [root_hash, proofs] = merkle::proofs_from_bytes_list(tx_hashes);
+  BENCHMARK("VerifyProofs") {
+    size_t valid = 0;
+    for (auto i = 0; i < num_txs; i++) {
+      if (!proofs[i]->verify(root_hash, tx_hashes[i]))
+        valid++;
+    }
+    return valid;
+  };
+}
@@ -87,3 +87,36 @@ TEST_CASE("merkle_tree: Verify proof", "[noir][consensus]") {
     proof->aunts = orig_aunts;
   }
 }
+
+namespace {
+
+/// recursive split-point construction that the bottom-up engine must agree with
+Bytes reference_hash(std::span<const Bytes> items) {
+  if (items.empty())
+    return get_empty_hash();
+  if (items.size() == 1)
+    return leaf_hash_opt(items[0]);
+  auto k = get_split_point(items.size());
+  return inner_hash_opt(reference_hash(items.first(k)), reference_hash(items.subspan(k)));
+}
+
+} // namespace
+
+TEST_CASE("merkle_tree: Bottom-up hashing matches split recursion", "[noir][consensus]") {
+  bytes_list items;
+  for (auto n = 0; n <= 300; n++) {
+    auto root_hash = hash_from_bytes_list(items);
+    CHECK(root_hash == reference_hash(items));
+
+    auto [proof_root, proofs] = proofs_from_bytes_list(items);
+    CHECK(proof_root == root_hash);
+    CHECK(proofs.size() == items.size());
+    for (auto i = 0; i < items.size(); i++) {
+      CHECK(proofs[i]->aunts.size() <= std::bit_width(items.size()));
+      CHECK(!proofs[i]->verify(root_hash, items[i]).has_value());
+    }
+    Bytes item(n % 7);
+    std::fill(item.begin(), item.end(), static_cast<unsigned char>(n));
+    items.push_back(item);
+  }
+}
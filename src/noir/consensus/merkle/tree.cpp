@@ -3,38 +3,103 @@
 // Copyright (c) 2022 Haderech Pte. Ltd.
 // SPDX-License-Identifier: AGPL-3.0-or-later
 //
+#include <noir/common/thread_pool.h>
 #include <noir/consensus/merkle/tree.h>
-#include <functional>
+#include <algorithm>
+#include <thread>
 
 namespace noir::consensus::merkle {
 
-using hash_func = std::function<Bytes(std::span<const unsigned char>)>;
-hash_func hash = [](std::span<const unsigned char> in) {
-  return crypto::Sha256()(in); ///< use Sha256 for now; may use a different algorithm in the future
-};
+namespace {
+  const unsigned char leaf_prefix = 0x00;
+  const unsigned char inner_prefix = 0x01;
 
-const char leaf_prefix = '\x00';
-const char inner_prefix = '\x01';
+  /// levels with fewer nodes than this are hashed on the calling thread
+  constexpr size_t parallel_min_nodes{2048};
+  constexpr size_t parallel_chunk_size{512};
+  /// leaf levels holding at least this many bytes are hashed on hash_pool regardless of their length
+  constexpr size_t parallel_min_bytes{256 * 1024};
+  constexpr size_t parallel_chunk_bytes{64 * 1024};
+
+  /// returns the hash context reused for every node hashed on this thread
+  crypto::Sha256& hasher() {
+    static thread_local crypto::Sha256 sha; ///< use Sha256 for now; may use a different algorithm in the future
+    return sha;
+  }
+
+  named_thread_pool& hash_pool() {
+    static named_thread_pool pool("merkle", std::max(1u, std::thread::hardware_concurrency()));
+    return pool;
+  }
+
+  /// calls f(begin, end) over chunks of [0, n), spreading them over hash_pool when parallel is set
+  template<typename F>
+  void for_each_chunk(size_t n, size_t chunk_size, bool parallel, F&& f) {
+    if (!parallel || n <= chunk_size) {
+      f(size_t(0), n);
+      return;
+    }
+    std::vector<std::future<void>> futures;
+    futures.reserve((n + chunk_size - 1) / chunk_size);
+    for (size_t begin = 0; begin < n; begin += chunk_size) {
+      auto end = std::min(begin + chunk_size, n);
+      futures.push_back(async_thread_pool(hash_pool().get_executor(), [&f, begin, end]() { f(begin, end); }));
+    }
+    for (auto& fut : futures)
+      fut.get();
+  }
+
+  template<typename Item>
+  void hash_leaves(std::span<const Item> items, node_hash* out) {
+    size_t bytes{0};
+    for (const auto& item : items)
+      bytes += item.size();
+    // a chunk covers about parallel_chunk_bytes of input, so a few large block parts still spread over the pool
+    auto chunk_size =
+      std::clamp<size_t>(parallel_chunk_bytes * items.size() / std::max<size_t>(bytes, 1), 1, parallel_chunk_size);
+    auto parallel = items.size() >= parallel_min_nodes || bytes >= parallel_min_bytes;
+    for_each_chunk(items.size(), chunk_size, parallel, [&](size_t begin, size_t end) {
+      for (auto i = begin; i < end; ++i)
+        leaf_hash_to({items[i].data(), items[i].size()}, out[i]);
+    });
+  }
+
+  /// hashes adjacent pairs of in[0, n) into out, carrying an odd last node up as is
+  /// \return number of nodes in the next level
+  size_t hash_level(const node_hash* in, size_t n, node_hash* out) {
+    auto pairs = n / 2;
+    for_each_chunk(pairs, parallel_chunk_size, pairs >= parallel_min_nodes, [&](size_t begin, size_t end) {
+      for (auto i = begin; i < end; ++i)
+        inner_hash_to({in[2 * i].data(), in[2 * i].size()}, {in[2 * i + 1].data(), in[2 * i + 1].size()}, out[i]);
+    });
+    if (n % 2)
+      out[pairs] = in[n - 1];
+    return pairs + n % 2;
+  }
+} // namespace
 
 Bytes get_empty_hash() {
-  return hash({});
+  return hasher().init().final();
 }
 
 Bytes leaf_hash_opt(const Bytes& leaf) {
-  Bytes buff;
-  buff.raw().reserve(leaf.size() + 1);
-  buff.raw().push_back(leaf_prefix);
-  buff.raw().insert(buff.end(), leaf.begin(), leaf.end());
-  return hash(buff);
+  node_hash out;
+  leaf_hash_to({leaf.data(), leaf.size()}, out);
+  return {out.begin(), out.end()};
 }
 
 Bytes inner_hash_opt(const Bytes& left, const Bytes& right) {
-  Bytes buff;
-  buff.raw().reserve(left.size() + right.size() + 1);
-  buff.raw().push_back(inner_prefix);
-  buff.raw().insert(buff.end(), left.begin(), left.end());
-  buff.raw().insert(buff.end(), right.begin(), right.end());
-  return hash(buff);
+  node_hash out;
+  inner_hash_to({left.data(), left.size()}, {right.data(), right.size()}, out);
+  return {out.begin(), out.end()};
+}
+
+void leaf_hash_to(std::span<const unsigned char> leaf, node_hash& out) {
+  hasher().init().update({&leaf_prefix, 1}).update(leaf).final({out.data(), out.size()});
+}
+
+void inner_hash_to(std::span<const unsigned char> left, std::span<const unsigned char> right, node_hash& out) {
+  hasher().init().update({&inner_prefix, 1}).update(left).update(right).final({out.data(), out.size()});
 }
 
 size_t get_split_point(size_t length) {
@@ -46,45 +111,94 @@ size_t get_split_point(size_t length) {
   return k;
 }
 
-Bytes hash_from_bytes_list(const bytes_list& list) {
-  switch (list.size()) {
-  case 0:
+// Pairing nodes level by level and carrying an odd last node up unchanged yields the same tree as splitting the list
+// at get_split_point recursively, since every left subtree produced by the split is a complete power of two.
+Bytes hash_from_bytes_list(std::span<const Bytes> list) {
+  if (list.empty())
     return get_empty_hash();
-  case 1:
-    return leaf_hash_opt(list[0]);
+
+  // leaves go to the front of the buffer and each level alternates between the front and the back half
+  auto n = list.size();
+  std::vector<node_hash> buf(n + (n + 1) / 2);
+  node_hash* cur = buf.data();
+  node_hash* next = buf.data() + n;
+  hash_leaves(list, cur);
+  while (n > 1) {
+    n = hash_level(cur, n, next);
+    std::swap(cur, next);
   }
-  auto k = get_split_point(list.size());
-  auto left = hash_from_bytes_list({list.begin(), list.begin() + k});
-  auto right = hash_from_bytes_list({list.begin() + k, list.end()});
-  return inner_hash_opt(left, right);
+  return {cur->begin(), cur->end()};
+}
+
+namespace {
+  template<typename Item>
+  void hash_levels_impl(std::span<const Item> items, std::vector<node_hash>& nodes, std::vector<size_t>& offsets) {
+    nodes.clear();
+    offsets.clear();
+    if (items.empty())
+      return;
+
+    auto n = items.size();
+    size_t total = n;
+    for (auto size = n; size > 1; size = (size + 1) / 2)
+      total += (size + 1) / 2;
+    nodes.resize(total);
+    offsets.push_back(0);
+    hash_leaves(items, nodes.data());
+    size_t offset = 0;
+    while (n > 1) {
+      auto next = hash_level(nodes.data() + offset, n, nodes.data() + offset + n);
+      offset += n;
+      offsets.push_back(offset);
+      n = next;
+    }
+  }
+} // namespace
+
+void hash_levels(std::span<const Bytes> items, std::vector<node_hash>& nodes, std::vector<size_t>& offsets) {
+  hash_levels_impl(items, nodes, offsets);
+}
+
+void hash_levels(std::span<const byte_slice> items, std::vector<node_hash>& nodes, std::vector<size_t>& offsets) {
+  hash_levels_impl(items, nodes, offsets);
 }
 
-Bytes compute_hash_from_aunts(int64_t index, int64_t total, Bytes leaf_hash, bytes_list inner_hashes) {
+Bytes compute_hash_from_aunts(int64_t index, int64_t total, const Bytes& leaf_hash, const bytes_list& inner_hashes) {
   if (index >= total || index < 0 || total <= 0)
     return {};
-  switch (total) {
-  case 0:
-    check(false, "cannot call compute_hash_from_aunts with 0 total");
-  case 1:
-    if (!inner_hashes.empty())
+
+  // walk down from the root to find the side the leaf takes at each depth; the aunt for depth d is the d-th from back
+  uint64_t right_sides{0};
+  size_t depth{0};
+  while (total > 1) {
+    if (depth >= inner_hashes.size())
       return {};
-    return leaf_hash;
+    auto num_left = static_cast<int64_t>(get_split_point(total));
+    if (index < num_left) {
+      total = num_left;
+    } else {
+      right_sides |= uint64_t(1) << depth;
+      index -= num_left;
+      total -= num_left;
+    }
+    ++depth;
   }
-  if (inner_hashes.empty())
+  if (depth != inner_hashes.size())
     return {};
-  auto num_left = get_split_point(total);
-  if (index < num_left) {
-    auto left_hash =
-      compute_hash_from_aunts(index, num_left, leaf_hash, {inner_hashes.begin(), inner_hashes.end() - 1});
-    if (left_hash.empty())
-      return {};
-    return inner_hash_opt(left_hash, inner_hashes[inner_hashes.size() - 1]);
+  if (depth == 0)
+    return leaf_hash;
+
+  node_hash hash;
+  std::span<const unsigned char> cur{leaf_hash.data(), leaf_hash.size()};
+  for (auto d = depth; d-- > 0;) {
+    const auto& aunt = inner_hashes[inner_hashes.size() - 1 - d];
+    if (right_sides & (uint64_t(1) << d))
+      inner_hash_to({aunt.data(), aunt.size()}, cur, hash);
+    else
+      inner_hash_to(cur, {aunt.data(), aunt.size()}, hash);
+    cur = {hash.data(), hash.size()};
   }
-  auto right_hash = compute_hash_from_aunts(
-    index - num_left, total - num_left, leaf_hash, {inner_hashes.begin(), inner_hashes.end() - 1});
-  if (right_hash.empty())
-    return {};
-  return inner_hash_opt(inner_hashes[inner_hashes.size() - 1], right_hash);
+  return {hash.begin(), hash.end()};
 }
 
 } // namespace noir::consensus::merkle
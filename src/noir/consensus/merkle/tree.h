@@ -10,21 +10,40 @@
 #include <noir/crypto/hash.h>
 
 #include <bit>
+#include <span>
 
 namespace noir::consensus::merkle {
 
 using bytes_list = std::vector<Bytes>;
 
+/// \brief hash of a single tree node
+using node_hash = Bytes32;
+
+/// \brief leaf data viewed in place, e.g. a block part inside the encoded block
+using byte_slice = std::span<const unsigned char>;
+
 Bytes get_empty_hash();
 
 Bytes leaf_hash_opt(const Bytes& leaf);
 
 Bytes inner_hash_opt(const Bytes& left, const Bytes& right);
 
+/// \brief writes the leaf hash of leaf to out without allocating
+void leaf_hash_to(std::span<const unsigned char> leaf, node_hash& out);
+
+/// \brief writes the inner hash of left and right to out without allocating
+void inner_hash_to(std::span<const unsigned char> left, std::span<const unsigned char> right, node_hash& out);
+
 size_t get_split_point(size_t length);
 
-Bytes hash_from_bytes_list(const bytes_list& list);
+Bytes hash_from_bytes_list(std::span<const Bytes> list);
+
+/// \brief hashes every level of the tree over items bottom-up
+/// \param nodes receives the hashes of all levels, leaves first and the root last
+/// \param offsets receives the index in nodes where each level starts
+void hash_levels(std::span<const Bytes> items, std::vector<node_hash>& nodes, std::vector<size_t>& offsets);
+void hash_levels(std::span<const byte_slice> items, std::vector<node_hash>& nodes, std::vector<size_t>& offsets);
 
-Bytes compute_hash_from_aunts(int64_t index, int64_t total, Bytes leaf_hash, bytes_list inner_hashes);
+Bytes compute_hash_from_aunts(int64_t index, int64_t total, const Bytes& leaf_hash, const bytes_list& inner_hashes);
 
 } // namespace noir::consensus::merkle
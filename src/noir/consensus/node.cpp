@@ -53,7 +53,7 @@ std::unique_ptr<node> node::make_node(appbase::application& app,
 
   auto dbs = std::make_shared<noir::consensus::db_store>(session);
   auto proxy_app = create_and_start_proxy_app(new_config->base.proxy_app);
-  auto bls = std::make_shared<noir::consensus::block_store>(session);
+  auto bls = std::make_shared<noir::consensus::block_store>(session, new_config->base.block_cache_size);
   auto ev_bus = std::make_shared<noir::consensus::events::event_bus>(app);
 
   state state_ = load_state_from_db_or_genesis(dbs, new_genesis_doc);
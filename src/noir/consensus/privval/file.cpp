@@ -220,13 +220,12 @@ Result<void> sign_internal(T& obj, const Bytes& sign_bytes, file_pv& pv, sign_st
 }
 
 Result<void> file_pv::sign_vote_internal(const std::string& chain_id, noir::consensus::vote& vote) {
-  return sign_internal<noir::consensus::vote>(
-    vote, vote::vote_sign_bytes(chain_id, *vote::to_proto(vote)), *this, vote_to_step(vote));
+  return sign_internal<noir::consensus::vote>(vote, vote::vote_sign_bytes(chain_id, vote), *this, vote_to_step(vote));
 }
 
 Result<void> file_pv::sign_proposal_internal(const std::string& chain_id, noir::p2p::proposal_message& msg) {
   return sign_internal<noir::p2p::proposal_message>(
-    msg, proposal::proposal_sign_bytes(chain_id, *proposal::to_proto({msg})), *this, sign_step::propose);
+    msg, proposal::proposal_sign_bytes(chain_id, msg), *this, sign_step::propose);
 }
 
 void file_pv::save_signed(int64_t height, int32_t round, sign_step step, const Bytes& sign_bytes, const Bytes& sig) {
@@ -0,0 +1,195 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#pragma once
+#include <noir/common/bytes.h>
+#include <noir/consensus/types/block.h>
+#include <noir/consensus/types/block_meta.h>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+#include <boost/multi_index_container.hpp>
+#include <atomic>
+#include <mutex>
+
+namespace noir::consensus {
+
+/// \addtogroup consensus
+/// \{
+
+/// \brief LRU cache of decoded objects keyed by height and, optionally, by hash
+/// Holds at most capacity entries. Values are shared immutably, so callers may keep them after eviction.
+template<typename T>
+class height_lru_cache {
+public:
+  explicit height_lru_cache(size_t capacity): capacity(capacity) {}
+
+  std::shared_ptr<const T> get(int64_t height) {
+    std::scoped_lock g{mtx};
+    auto& by_height = entries.template get<by_height_tag>();
+    if (auto it = by_height.find(height); it != by_height.end()) {
+      touch(entries.template project<0>(it));
+      return it->value;
+    }
+    return nullptr;
+  }
+
+  std::shared_ptr<const T> get_by_hash(const Bytes& hash) {
+    std::scoped_lock g{mtx};
+    auto& by_hash = entries.template get<by_hash_tag>();
+    if (auto it = by_hash.find(hash); it != by_hash.end()) {
+      touch(entries.template project<0>(it));
+      return it->value;
+    }
+    return nullptr;
+  }
+
+  void put(int64_t height, const Bytes& hash, std::shared_ptr<const T> value) {
+    if (capacity == 0) {
+      return;
+    }
+    std::scoped_lock g{mtx};
+    auto& by_height = entries.template get<by_height_tag>();
+    if (auto it = by_height.find(height); it != by_height.end()) {
+      by_height.erase(it);
+    }
+    if (entries.size() >= capacity) {
+      entries.pop_front();
+    }
+    entries.push_back({height, hash, std::move(value)});
+  }
+
+  /// \brief removes the entry at the given height
+  void erase(int64_t height) {
+    std::scoped_lock g{mtx};
+    entries.template get<by_height_tag>().erase(height);
+  }
+
+  /// \brief removes all entries below the given height
+  void erase_below(int64_t height) {
+    std::scoped_lock g{mtx};
+    for (auto it = entries.begin(); it != entries.end();) {
+      it = it->height < height ? entries.erase(it) : std::next(it);
+    }
+  }
+
+  void clear() {
+    std::scoped_lock g{mtx};
+    entries.clear();
+  }
+
+  size_t size() {
+    std::scoped_lock g{mtx};
+    return entries.size();
+  }
+
+private:
+  struct entry {
+    int64_t height;
+    Bytes hash;
+    std::shared_ptr<const T> value;
+  };
+  struct by_height_tag {};
+  struct by_hash_tag {};
+
+  // clang-format off
+  using entries_type = boost::multi_index_container<
+    entry,
+    boost::multi_index::indexed_by<
+      boost::multi_index::sequenced<>,
+      boost::multi_index::hashed_unique<boost::multi_index::tag<by_height_tag>,
+        boost::multi_index::member<entry, int64_t, &entry::height>>,
+      boost::multi_index::hashed_non_unique<boost::multi_index::tag<by_hash_tag>,
+        boost::multi_index::member<entry, Bytes, &entry::hash>>
+    >
+  >;
+  // clang-format on
+
+  void touch(typename entries_type::iterator it) {
+    entries.relocate(entries.end(), it);
+  }
+
+  std::mutex mtx;
+  size_t capacity;
+  entries_type entries;
+};
+
+/// \brief Cache of decoded blocks, block metas and commits shared by all copies of a block_store
+/// Capacity is given in number of heights per object type.
+class block_cache {
+public:
+  struct stats {
+    uint64_t hits;
+    uint64_t misses;
+  };
+
+  explicit block_cache(size_t capacity): blocks(capacity), metas(capacity), commits(capacity) {}
+
+  std::shared_ptr<const block> get_block(int64_t height) {
+    return count(blocks.get(height));
+  }
+  std::shared_ptr<const block> get_block_by_hash(const Bytes& hash) {
+    return count(blocks.get_by_hash(hash));
+  }
+  void put_block(int64_t height, const Bytes& hash, std::shared_ptr<const block> bl) {
+    blocks.put(height, hash, std::move(bl));
+  }
+
+  std::shared_ptr<const block_meta> get_block_meta(int64_t height) {
+    return count(metas.get(height));
+  }
+  void put_block_meta(int64_t height, std::shared_ptr<const block_meta> bl_meta) {
+    auto hash = bl_meta->bl_id.hash;
+    metas.put(height, hash, std::move(bl_meta));
+  }
+
+  std::shared_ptr<const commit> get_commit(int64_t height) {
+    return count(commits.get(height));
+  }
+  void put_commit(int64_t height, std::shared_ptr<const commit> commit_) {
+    commits.put(height, {}, std::move(commit_));
+  }
+
+  /// \brief invalidates all objects at the given height, e.g. when save_signed_header overwrites them
+  void invalidate(int64_t height) {
+    blocks.erase(height);
+    metas.erase(height);
+    commits.erase(height);
+  }
+
+  /// \brief invalidates all objects below the given height, called after pruning
+  void invalidate_below(int64_t height) {
+    blocks.erase_below(height);
+    metas.erase_below(height);
+    commits.erase_below(height);
+  }
+
+  void clear() {
+    blocks.clear();
+    metas.clear();
+    commits.clear();
+  }
+
+  stats get_stats() const {
+    return {hits.load(std::memory_order_relaxed), misses.load(std::memory_order_relaxed)};
+  }
+
+private:
+  template<typename T>
+  std::shared_ptr<const T> count(std::shared_ptr<const T> value) {
+    (value ? hits : misses).fetch_add(1, std::memory_order_relaxed);
+    return value;
+  }
+
+  height_lru_cache<block> blocks;
+  height_lru_cache<block_meta> metas;
+  height_lru_cache<commit> commits;
+  std::atomic<uint64_t> hits{0};
+  std::atomic<uint64_t> misses{0};
+};
+
+/// \}
+
+} // namespace noir::consensus
@@ -7,6 +7,7 @@
 #include <noir/common/for_each.h>
 #include <noir/common/hex.h>
 #include <noir/consensus/common.h>
+#include <noir/consensus/store/block_cache.h>
 #include <noir/consensus/types/block.h>
 #include <noir/consensus/types/block_meta.h>
 #include <noir/consensus/types/light_block.h>
@@ -20,9 +21,10 @@ namespace noir::consensus {
 /// \{
 
 /// \brief BlockStore is a simple low level store for blocks.
-/// There are three types of information stored:
+/// There are four types of information stored:
 ///  - BlockMeta:   Meta information about each block
 ///  - Block part:  Parts of each block, aggregated w/ PartSet
+///  - Block data:  Protobuf-encoded block as a single contiguous value, for serving whole blocks
 ///  - Commit:      The commit part of each block, for gossiping precommit votes
 ///
 /// Currently the precommit signatures are duplicated in the Block parts as
@@ -31,47 +33,37 @@ namespace noir::consensus {
 ///
 /// The store can be assumed to contain all contiguous blocks between base and height (inclusive).
 ///
+/// Recently loaded blocks, block metas and commits are kept decoded in a block_cache shared by copies of the store.
+///
 /// \note: BlockStore methods will panic if they encounter errors deserializing loaded data, indicating probable
 /// corruption on disk.
 class block_store {
   using db_session_type = noir::db::session::session<noir::db::session::rocksdb_t>;
 
 public:
-  explicit block_store(std::shared_ptr<db_session_type> session_): db_session_(std::move(session_)) {}
+  static constexpr size_t default_cache_size = 128;
+
+  explicit block_store(std::shared_ptr<db_session_type> session_, size_t cache_size = default_cache_size)
+    : db_session_(std::move(session_)), cache_(std::make_shared<block_cache>(cache_size)),
+      state_(std::make_shared<store_state>()) {
+    load_store_state();
+  }
 
-  block_store(block_store&& other) noexcept: db_session_(std::move(other.db_session_)) {}
-  block_store(const block_store& other) noexcept: db_session_(other.db_session_) {}
+  block_store(block_store&& other) noexcept
+    : db_session_(std::move(other.db_session_)), cache_(std::move(other.cache_)), state_(std::move(other.state_)) {}
+  block_store(const block_store& other) noexcept
+    : db_session_(other.db_session_), cache_(other.cache_), state_(other.state_) {}
 
   /// \brief gets the first known contiguous block height, or 0 for empty block stores.
   /// \return base height
   int64_t base() const {
-    auto begin_it = db_session_->lower_bound_from_bytes(encode_key<prefix::block_meta>(1));
-    auto end_it = db_session_->lower_bound_from_bytes(encode_key<prefix::block_meta>(0x1ll << 63));
-    if (begin_it == end_it) {
-      return 0;
-    }
-    auto tmp = begin_it.key();
-    Bytes key_{std::vector<unsigned char>{tmp.begin(), tmp.end()}};
-    int64_t height_;
-    check(decode_block_meta_key(key_, height_),
-      fmt::format("unable to decode base key={}", to_string(key_))); // TODO: handle panic in consensus
-    return height_;
+    return state_->base.load(std::memory_order_acquire);
   }
 
   /// \brief gets the last known contiguous block height, or 0 for empty block stores.
   /// \return height
   int64_t height() const {
-    auto begin_it = db_session_->lower_bound_from_bytes(encode_key<prefix::block_meta>(0));
-    auto end_it = db_session_->lower_bound_from_bytes(encode_key<prefix::block_meta>(0x1ll << 63));
-    if (begin_it == end_it) { // no iterator found
-      return 0;
-    }
-    auto tmp = (--end_it).key();
-    Bytes key_{std::vector<unsigned char>{tmp.begin(), tmp.end()}};
-    int64_t height_;
-    check(decode_block_meta_key(key_, height_),
-      fmt::format("unable to decode height key={}", to_string(key_))); // TODO: handle panic in consensus
-    return height_;
+    return state_->height.load(std::memory_order_acquire);
   }
 
   /// \brief gets the number of blocks in the block store.
@@ -85,16 +77,11 @@ public:
   /// \param[out] block_meta loaded block_meta object
   /// \return true on success, false otherwise
   bool load_base_meta(block_meta& bl_meta) const {
-    auto tmp_it = db_session_->lower_bound_from_bytes(encode_key<prefix::block_meta>(1));
-    auto tmp_bytes = tmp_it.key();
-    Bytes key_{std::vector<unsigned char>{tmp_bytes.begin(), tmp_bytes.end()}};
-    int64_t height_;
-    if (!decode_block_meta_key(key_, height_) || ((*tmp_it).second == std::nullopt)) {
+    auto base_ = base();
+    if (base_ == 0) {
       return false;
     }
-    tmp_bytes = (*tmp_it).second.value();
-    bl_meta = decode<block_meta>(Bytes{std::vector<unsigned char>{tmp_bytes.begin(), tmp_bytes.end()}});
-    return true;
+    return load_block_meta(base_, bl_meta);
   }
 
   /// \brief loads the block with the given height.
@@ -102,27 +89,32 @@ public:
   /// \param[out] bl loaded block object
   /// \return true on success, false otherwise
   bool load_block(int64_t height_, block& bl) const {
-    block_meta bl_meta{};
-    if (!load_block_meta(height_, bl_meta)) {
+    auto ret = load_block(height_);
+    if (!ret) {
       return false;
     }
-    auto parts_total = bl_meta.bl_id.parts.total;
-    part part_{};
+    bl = *ret;
+    return true;
+  }
+
+  /// \brief loads the block with the given height.
+  /// \param[in] height_ height to load
+  /// \return shared decoded block, nullptr if not found
+  std::shared_ptr<const block> load_block(int64_t height_) const {
+    if (auto ret = cache_->get_block(height_); ret) {
+      return ret;
+    }
     Bytes data{};
-    for (auto i = 0; i < parts_total; ++i) {
-      // If the part is missing (e.g. since it has been deleted after we
-      // loaded the block meta) we consider the whole block to be missing.
-      if (!load_block_part(height_, i, part_)) {
-        return false;
-      }
-      data.raw().insert(data.end(), part_.bytes_.begin(), part_.bytes_.end());
+    if (!load_block_bytes(height_, data)) {
+      return nullptr;
     }
     // bl = decode<block>(data);
     // Note : data is always serialized using protobuf via block::make_part_set
     ::tendermint::types::Block pb;
     pb.ParseFromArray(data.data(), data.size());
-    bl = *block::from_proto(pb);
-    return true;
+    auto ret = block::from_proto(pb);
+    cache_->put_block(height_, ret->get_hash(), ret);
+    return ret;
   }
 
   /// \brief loads the block with the given hash.
@@ -130,12 +122,79 @@ public:
   /// \param[out] bl loaded block object
   /// \return true on success, false otherwise
   bool load_block_by_hash(const Bytes& hash, block& bl) const {
+    auto ret = load_block_by_hash(hash);
+    if (!ret) {
+      return false;
+    }
+    bl = *ret;
+    return true;
+  }
+
+  /// \brief loads the block with the given hash.
+  /// \param[in] hash hash to load
+  /// \return shared decoded block, nullptr if not found
+  std::shared_ptr<const block> load_block_by_hash(const Bytes& hash) const {
+    if (auto ret = cache_->get_block_by_hash(hash); ret) {
+      return ret;
+    }
+    auto tmp = db_session_->read_from_bytes(encode_key<prefix::block_hash>(hash.raw()));
+    if (!tmp.has_value()) {
+      return nullptr;
+    }
+    auto height_ = decode_val(tmp.value());
+    return load_block(height_);
+  }
+
+  /// \brief loads the protobuf-encoded block with the given height without parsing it.
+  /// The block is read as a single value; blocks saved before block data was stored are reassembled from their parts
+  /// with a single batched read.
+  /// \param[in] height_ height to load
+  /// \param[out] data encoded block
+  /// \return true on success, false otherwise
+  bool load_block_bytes(int64_t height_, Bytes& data) const {
+    if (auto tmp = db_session_->read_from_bytes(encode_key<prefix::block_data>(height_));
+        tmp.has_value() && tmp.value().size() > 0) {
+      data = std::move(tmp.value());
+      return true;
+    }
+
+    block_meta bl_meta{};
+    if (!load_block_meta(height_, bl_meta)) {
+      return false;
+    }
+    auto parts_total = bl_meta.bl_id.parts.total;
+    std::vector<db::session::shared_bytes> keys;
+    keys.reserve(parts_total);
+    for (auto i = 0; i < parts_total; ++i) {
+      auto key_ = encode_key<prefix::block_part>(height_, i);
+      keys.emplace_back(key_.data(), key_.size());
+    }
+    // If a part is missing (e.g. since it has been deleted after we
+    // loaded the block meta) we consider the whole block to be missing.
+    auto [kvs, not_found] = db_session_->read(keys);
+    if (!not_found.empty() || kvs.size() != parts_total) {
+      return false;
+    }
+    data.raw().clear();
+    data.raw().reserve(std::max<int64_t>(bl_meta.bl_size, 0));
+    for (const auto& kv : kvs) {
+      auto part_ = decode<part>({reinterpret_cast<const unsigned char*>(kv.second.data()), kv.second.size()});
+      data.raw().insert(data.end(), part_.bytes_.begin(), part_.bytes_.end());
+    }
+    return true;
+  }
+
+  /// \brief loads the protobuf-encoded block with the given hash without parsing it.
+  /// \param[in] hash hash to load
+  /// \param[out] data encoded block
+  /// \return true on success, false otherwise
+  bool load_block_bytes_by_hash(const Bytes& hash, Bytes& data) const {
     auto tmp = db_session_->read_from_bytes(encode_key<prefix::block_hash>(hash.raw()));
     if (!tmp.has_value()) {
       return false;
     }
     auto height_ = decode_val(tmp.value());
-    return load_block(height_, bl);
+    return load_block_bytes(height_, data);
   }
 
   /// \brief loads the Part at the given index from the block at the given height.
@@ -157,27 +216,64 @@ public:
   /// \param[out] block_meta_ loaded block_meta object
   /// \return true on success, false otherwise
   bool load_block_meta(int64_t height_, block_meta& block_meta_) const {
-    auto tmp = db_session_->read_from_bytes(encode_key<prefix::block_meta>(height_));
-    if ((!tmp.has_value()) || tmp.value().size() == 0) {
+    auto ret = load_block_meta(height_);
+    if (!ret) {
       return false;
     }
-    block_meta_ = decode<block_meta>(tmp.value());
+    block_meta_ = *ret;
     return true;
   }
 
+  /// \brief loads the BlockMeta for the given height.
+  /// \param[in] height_ height to load
+  /// \return shared decoded block_meta, nullptr if not found
+  std::shared_ptr<const block_meta> load_block_meta(int64_t height_) const {
+    if (auto ret = cache_->get_block_meta(height_); ret) {
+      return ret;
+    }
+    auto tmp = db_session_->read_from_bytes(encode_key<prefix::block_meta>(height_));
+    if ((!tmp.has_value()) || tmp.value().size() == 0) {
+      return nullptr;
+    }
+    auto ret = std::make_shared<const block_meta>(decode<block_meta>(tmp.value()));
+    cache_->put_block_meta(height_, ret);
+    return ret;
+  }
+
   /// \brief loads the Commit for the given height.
   /// \param[in] height_ height to load part
   /// \param[out] commit_ loaded commit object
   /// \return true on success, false otherwise
   bool load_block_commit(int64_t height_, commit& commit_) const {
-    auto tmp = db_session_->read_from_bytes(encode_key<prefix::block_commit>(height_));
-    if ((!tmp.has_value()) || tmp.value().size() == 0) {
+    auto ret = load_block_commit(height_);
+    if (!ret) {
       return false;
     }
-    commit_ = decode<commit>(tmp.value());
+    commit_ = *ret;
     return true;
   }
 
+  /// \brief loads the Commit for the given height.
+  /// \param[in] height_ height to load part
+  /// \return shared decoded commit, nullptr if not found
+  std::shared_ptr<const commit> load_block_commit(int64_t height_) const {
+    if (auto ret = cache_->get_commit(height_); ret) {
+      return ret;
+    }
+    auto tmp = db_session_->read_from_bytes(encode_key<prefix::block_commit>(height_));
+    if ((!tmp.has_value()) || tmp.value().size() == 0) {
+      return nullptr;
+    }
+    auto ret = std::make_shared<const commit>(decode<commit>(tmp.value()));
+    cache_->put_commit(height_, ret);
+    return ret;
+  }
+
+  /// \brief gets hit/miss counters of the decoded object cache
+  block_cache::stats cache_stats() const {
+    return cache_->get_stats();
+  }
+
   /// \brief loads the last locally seen Commit before being cannonicalized.
   /// This is useful when we've seen a commit,
   /// but there has not yet been a new block at `height + 1` that includes this commit in its block.last_commit.
@@ -218,10 +314,14 @@ public:
     // typically load the block meta first as an indication that the block exists
     // and then go on to load block parts - we must make sure the block is
     // complete as soon as the block meta is written.
+    Bytes data{};
+    data.raw().reserve(parts_.byte_size);
     for (auto i = 0; i < parts_.total; i++) {
       const auto part = parts_.get_part(i);
       save_block_part(height_, i, *part, batch);
+      data.raw().insert(data.end(), part->bytes_.begin(), part->bytes_.end());
     }
+    batch.emplace_back(encode_key<prefix::block_data>(height_), std::move(data));
 
     {
       block_meta bl_meta = block_meta::new_block_meta(bl, bl_parts);
@@ -238,8 +338,17 @@ public:
       auto buf = encode(seen_commit);
       batch.emplace_back(encode_key<prefix::seen_commit>(), buf);
     }
+    auto base_ = base();
+    if (base_ == 0) {
+      base_ = height_;
+    }
+    batch.emplace_back(encode_key<prefix::store_state>(), encode_store_state(base_, height_));
     db_session_->write_from_bytes(batch);
     db_session_->commit();
+    state_->base.store(base_, std::memory_order_release);
+    state_->height.store(height_, std::memory_order_release);
+    cache_->invalidate(height_);
+    cache_->invalidate(height_ - 1);
     return true;
   }
 
@@ -282,6 +391,7 @@ public:
     buf = encode(header.commit);
     db_session_->write_from_bytes(encode_key<prefix::block_commit>(height_), buf);
     db_session_->commit();
+    cache_->invalidate(height_);
     return true;
   }
 
@@ -301,6 +411,14 @@ public:
       return false;
     }
 
+    // Batches below are not atomic, so advance the persisted base first to make sure no one tries to access
+    // blocks which are about to be removed.
+    if (height_ > base()) {
+      db_session_->write_from_bytes(encode_key<prefix::store_state>(), encode_store_state(height_, height()));
+      db_session_->commit();
+      state_->base.store(height_, std::memory_order_release);
+    }
+
     auto remove_block_hash = [&](const auto& k, const auto& v) {
       block_meta bm{};
       bm = decode<block_meta>(v);
@@ -317,11 +435,17 @@ public:
     }
     // check(pruned == tmp);
     tmp = 0;
+    if (!prune_range(
+          encode_key<prefix::block_data>(0), encode_key<prefix::block_data>(height_), std::nullopt, tmp)) {
+      return false;
+    }
+    tmp = 0;
     if (!prune_range(
           encode_key<prefix::block_commit>(0), encode_key<prefix::block_commit>(height_), std::nullopt, tmp)) {
       return false;
     }
     // check(pruned == tmp);
+    cache_->invalidate_below(height_);
 
     return true;
   }
@@ -334,9 +458,19 @@ private:
     block_commit = 2,
     seen_commit = 3,
     block_hash = 4,
+    block_data = 5,
+    store_state = 6,
+  };
+
+  /// base and height of the store, mirrored by the store_state record
+  struct store_state {
+    std::atomic<int64_t> base{0};
+    std::atomic<int64_t> height{0};
   };
 
   std::shared_ptr<db_session_type> db_session_;
+  std::shared_ptr<block_cache> cache_;
+  std::shared_ptr<store_state> state_;
 
   static inline Bytes encode_val(int64_t val) {
     auto hex_ = hex::decode(fmt::format("{:016x}", static_cast<uint64_t>(val)));
@@ -388,6 +522,42 @@ private:
     return lhs;
   }
 
+  static Bytes encode_store_state(int64_t base_, int64_t height_) {
+    auto buf = encode_val(base_);
+    auto rhs = encode_val(height_);
+    buf.raw().insert(buf.end(), rhs.begin(), rhs.end());
+    return buf;
+  }
+
+  /// loads base and height from the store_state record, falling back to scanning block metas for stores written
+  /// before the record existed
+  void load_store_state() {
+    auto tmp = db_session_->read_from_bytes(encode_key<prefix::store_state>());
+    if (tmp.has_value() && tmp.value().size() == 2 * sizeof(int64_t)) {
+      const auto& buf = tmp.value();
+      state_->base.store(decode_val(Bytes{std::vector<unsigned char>{buf.begin(), buf.begin() + sizeof(int64_t)}}));
+      state_->height.store(decode_val(Bytes{std::vector<unsigned char>{buf.begin() + sizeof(int64_t), buf.end()}}));
+      return;
+    }
+
+    auto begin_it = db_session_->lower_bound_from_bytes(encode_key<prefix::block_meta>(1));
+    auto end_it = db_session_->lower_bound_from_bytes(encode_key<prefix::block_meta>(0x1ll << 63));
+    if (begin_it == end_it) {
+      return;
+    }
+    int64_t base_, height_;
+    auto tmp_base = begin_it.key();
+    Bytes base_key{std::vector<unsigned char>{tmp_base.begin(), tmp_base.end()}};
+    check(decode_block_meta_key(base_key, base_),
+      fmt::format("unable to decode base key={}", to_string(base_key))); // TODO: handle panic in consensus
+    auto tmp_height = (--end_it).key();
+    Bytes height_key{std::vector<unsigned char>{tmp_height.begin(), tmp_height.end()}};
+    check(decode_block_meta_key(height_key, height_),
+      fmt::format("unable to decode height key={}", to_string(height_key))); // TODO: handle panic in consensus
+    state_->base.store(base_);
+    state_->height.store(height_);
+  }
+
   static bool decode_block_meta_key(const Bytes& key, int64_t& height_) {
     static constexpr size_t size_ = sizeof(char) + sizeof(int64_t);
     if ((key.size() != size_) || (key[0] != static_cast<char>(prefix::block_meta))) {
@@ -0,0 +1,136 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#include <catch2/catch_all.hpp>
+#include <noir/codec/protobuf.h>
+#include <noir/consensus/common_test.h>
+#include <noir/consensus/state.h>
+#include <noir/consensus/store/block_store.h>
+#include <noir/consensus/store/store_test.h>
+
+using namespace noir;
+using namespace noir::consensus;
+
+namespace {
+
+state make_genesis_state() {
+  auto config_ = config::get_default();
+  config_.base.chain_id = "test_block_store_bench";
+  config_.base.root_dir = "/tmp/test_block_store_bench";
+  config_.consensus.root_dir = config_.base.root_dir;
+  config_.priv_validator.root_dir = config_.base.root_dir;
+  auto [gen_doc, priv_vals] = rand_genesis_doc(config_, 1, false, 10);
+  return state::make_genesis_state(gen_doc);
+}
+
+/// fills the store with blocks of tx_num txs of tx_size bytes each, split into default sized parts
+std::vector<Bytes> fill_block_store(block_store& bls, int64_t num_blocks, int tx_num, size_t tx_size) {
+  auto genesis_state = make_genesis_state();
+  auto new_commit_ = std::make_shared<commit>();
+  std::vector<Bytes> hashes;
+  for (int64_t height = 1; height <= num_blocks; ++height) {
+    std::vector<tx> txs(tx_num);
+    for (auto& t : txs) {
+      t = gen_random_bytes(tx_size);
+    }
+    auto [bl_, p_set_] = genesis_state.make_block(height, txs, new_commit_, {}, {});
+    bl_->header.height = height;
+    p_set_ = bl_->make_part_set(block_part_size_bytes);
+    bls.save_block(*bl_, *p_set_, make_commit(10, tstamp{}));
+    hashes.push_back(bl_->get_hash());
+  }
+  return hashes;
+}
+
+/// looks up the first and last block meta keys with iterators, as base() and height() used to
+int64_t scan_size(const std::shared_ptr<noir::db::session::session<noir::db::session::rocksdb_t>>& session) {
+  auto meta_key = [](int64_t height) {
+    auto hex_ = hex::decode(fmt::format("{:016x}", static_cast<uint64_t>(height)));
+    Bytes key{};
+    key.raw().push_back(0); // prefix::block_meta
+    key.raw().insert(key.end(), hex_.begin(), hex_.end());
+    return key;
+  };
+  auto begin_it = session->lower_bound_from_bytes(meta_key(1));
+  auto end_it = session->lower_bound_from_bytes(meta_key(0x1ll << 63));
+  if (begin_it == end_it) {
+    return 0;
+  }
+  auto base = begin_it.key();
+  auto height = (--end_it).key();
+  return static_cast<int64_t>(base.size() + height.size());
+}
+
+} // namespace
+
+TEST_CASE("BlockStoreBenchmarks", "[noir][consensus]") {
+  static constexpr int64_t num_blocks = 100;
+  block_store bls(make_session(true, "/tmp/block_store_bench"));
+  auto hashes = fill_block_store(bls, num_blocks, 1000, 250); // ~250KB blocks
+
+  BENCHMARK("ServeBlockByHeight_LoadAndEncode") {
+    size_t total = 0;
+    for (int64_t height = 1; height <= num_blocks; ++height) {
+      block bl{};
+      bls.load_block(height, bl);
+      total += codec::protobuf::encode(*block::to_proto(bl)).size();
+    }
+    return total;
+  };
+
+  BENCHMARK("ServeBlockByHeight_Bytes") {
+    size_t total = 0;
+    for (int64_t height = 1; height <= num_blocks; ++height) {
+      Bytes bz{};
+      bls.load_block_bytes(height, bz);
+      total += bz.size();
+    }
+    return total;
+  };
+
+  BENCHMARK("ServeBlockByHash_LoadAndEncode") {
+    size_t total = 0;
+    for (const auto& hash : hashes) {
+      block bl{};
+      bls.load_block_by_hash(hash, bl);
+      total += codec::protobuf::encode(*block::to_proto(bl)).size();
+    }
+    return total;
+  };
+
+  BENCHMARK("ServeBlockByHash_Bytes") {
+    size_t total = 0;
+    for (const auto& hash : hashes) {
+      Bytes bz{};
+      bls.load_block_bytes_by_hash(hash, bz);
+      total += bz.size();
+    }
+    return total;
+  };
+}
+
+TEST_CASE("BlockStoreBaseHeightBenchmarks", "[noir][consensus]") {
+  static constexpr int64_t num_blocks = 1000;
+  static constexpr int calls = 1000;
+  auto session = make_session(true, "/tmp/block_store_base_height_bench");
+  block_store bls(session);
+  fill_block_store(bls, num_blocks, 1, 32);
+
+  BENCHMARK("Size_Iterators") {
+    int64_t total = 0;
+    for (int i = 0; i < calls; ++i) {
+      total += scan_size(session);
+    }
+    return total;
+  };
+
+  BENCHMARK("Size_StoreState") {
+    int64_t total = 0;
+    for (int i = 0; i < calls; ++i) {
+      total += bls.size();
+    }
+    return total;
+  };
+}
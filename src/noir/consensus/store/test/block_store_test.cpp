@@ -4,6 +4,7 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 //
 #include <catch2/catch_all.hpp>
+#include <noir/codec/protobuf.h>
 #include <noir/consensus/common_test.h>
 #include <noir/consensus/state.h>
 #include <noir/consensus/store/block_store.h>
@@ -40,10 +41,34 @@ static inline void comp_hdr(noir::consensus::block_header& ret_hdr, noir::consen
 };
 
 TEST_CASE("block_store: base/height", "[noir][consensus]") {
-  noir::consensus::block_store bls(make_session());
+  auto session = make_session();
+  noir::consensus::block_store bls(session);
   SECTION("initialize") {
     CHECK(bls.base() == 0x0ll);
     CHECK(bls.height() == 0ll);
+    CHECK(bls.size() == 0ll);
+  }
+
+  SECTION("persist") {
+    auto genesis_state = make_genesis_state();
+    auto new_commit_ = std::make_shared<noir::consensus::commit>();
+    for (auto height = 1; height <= 5; ++height) {
+      auto bl_ = noir::consensus::ev::make_block(height, genesis_state, new_commit_);
+      auto p_set_ = bl_->make_part_set(64);
+      CHECK(bls.save_block(*bl_, *p_set_, noir::consensus::make_commit(10, noir::tstamp{})) == true);
+    }
+    uint64_t num_pruned{0};
+    CHECK(bls.prune_blocks(3, num_pruned) == true);
+    CHECK(bls.base() == 3ll);
+    CHECK(bls.height() == 5ll);
+
+    noir::consensus::block_store reopened(session);
+    CHECK(reopened.base() == 3ll);
+    CHECK(reopened.height() == 5ll);
+    CHECK(reopened.size() == 3ll);
+    noir::consensus::block_meta base_meta{};
+    CHECK(reopened.load_base_meta(base_meta) == true);
+    CHECK(base_meta.header.height == 3ll);
   }
 }
 
@@ -106,6 +131,14 @@ TEST_CASE("block_store: save/load_block", "[noir][consensus]") {
       CHECK(bls.load_block_by_hash(bl_->get_hash(), ret) == true);
       CHECK(ret.get_hash() == bl_->get_hash());
     }
+    {
+      noir::Bytes ret{};
+      auto exp = noir::codec::protobuf::encode(*noir::consensus::block::to_proto(*bl_));
+      CHECK(bls.load_block_bytes(height, ret) == true);
+      CHECK(ret == exp);
+      CHECK(bls.load_block_bytes_by_hash(bl_->get_hash(), ret) == true);
+      CHECK(ret == exp);
+    }
 
     {
       noir::consensus::block_meta ret{};
@@ -161,11 +194,14 @@ TEST_CASE("block_store: prune_block", "[noir][consensus]") {
 
   auto check_block = [&](int start, int prune, int max, int skip) {
     noir::consensus::block tmp_block{};
+    noir::Bytes tmp_bytes{};
     for (auto i = start; i < prune; i += skip) {
       CHECK(bls.load_block(i, tmp_block) == false);
+      CHECK(bls.load_block_bytes(i, tmp_bytes) == false);
     }
     for (auto i = prune; i < max; i += skip) {
       CHECK(bls.load_block(i, tmp_block) == true);
+      CHECK(bls.load_block_bytes(i, tmp_bytes) == true);
     }
   };
   check_block(1, 1200, 1500, 10);
@@ -200,4 +236,65 @@ TEST_CASE("block_store: prune_block", "[noir][consensus]") {
   check_block(1300, 1500, 1500, 1);
 }
 
+TEST_CASE("block_store: cache", "[noir][consensus]") {
+  noir::consensus::block_store bls(make_session(), 4);
+  auto genesis_state = make_genesis_state();
+
+  auto new_commit_ = std::make_shared<noir::consensus::commit>();
+  for (auto height = 1; height <= 10; ++height) {
+    auto bl_ = noir::consensus::ev::make_block(height, genesis_state, new_commit_);
+    auto p_set_ = bl_->make_part_set(64);
+    auto seen_commit_ = noir::consensus::make_commit(10, noir::tstamp{});
+    CHECK(bls.save_block(*bl_, *p_set_, seen_commit_) == true);
+  }
+
+  SECTION("hit and miss") {
+    auto first = bls.load_block(5);
+    REQUIRE(first);
+    auto stats = bls.cache_stats();
+    CHECK(stats.hits == 0);
+    CHECK(stats.misses == 1);
+
+    auto second = bls.load_block(5);
+    CHECK(second == first);
+    stats = bls.cache_stats();
+    CHECK(stats.hits == 1);
+    CHECK(stats.misses == 1);
+
+    auto meta = bls.load_block_meta(5);
+    REQUIRE(meta);
+    CHECK(bls.load_block_meta(5) == meta);
+    CHECK(bls.load_block_by_hash(meta->bl_id.hash) == first);
+    auto commit_ = bls.load_block_commit(4);
+    REQUIRE(commit_);
+    CHECK(bls.load_block_commit(4) == commit_);
+
+    CHECK(!bls.load_block(11));
+    CHECK(!bls.load_block_meta(11));
+  }
+
+  SECTION("eviction") {
+    auto first = bls.load_block(1);
+    for (auto height = 2; height <= 5; ++height) {
+      bls.load_block(height);
+    }
+    auto misses = bls.cache_stats().misses;
+    auto reloaded = bls.load_block(1);
+    CHECK(bls.cache_stats().misses == misses + 1);
+    CHECK(reloaded != first);
+    CHECK(reloaded->header.height == first->header.height);
+  }
+
+  SECTION("invalidate on prune") {
+    REQUIRE(bls.load_block(3));
+    REQUIRE(bls.load_block_meta(3));
+    uint64_t num_pruned{0};
+    CHECK(bls.prune_blocks(5, num_pruned) == true);
+    CHECK(!bls.load_block(3));
+    CHECK(!bls.load_block_meta(3));
+    CHECK(!bls.load_block_commit(3));
+    CHECK(bls.load_block(5));
+  }
+}
+
 } // namespace
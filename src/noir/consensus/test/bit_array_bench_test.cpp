@@ -0,0 +1,73 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#include <catch2/catch_all.hpp>
+#include <noir/consensus/bit_array.h>
+#include <random>
+
+using namespace noir;
+using namespace noir::consensus;
+
+namespace {
+
+std::shared_ptr<bit_array> random_bit_array(int bits, int percent, std::mt19937& rng) {
+  auto ret = bit_array::new_bit_array(bits);
+  for (auto i = 0; i < bits; i++) {
+    ret->set_index(i, static_cast<int>(rng() % 100) < percent);
+  }
+  return ret;
+}
+
+} // namespace
+
+TEST_CASE("BitArrayBenchmarks", "[noir][consensus]") {
+  static constexpr int num_bits = 10000;
+  std::mt19937 rng{1};
+
+  // our votes are nearly complete while the peer is still catching up, as in pick_send_vote
+  auto ours = random_bit_array(num_bits, 90, rng);
+  auto peers = random_bit_array(num_bits, 50, rng);
+  auto sparse = random_bit_array(num_bits, 1, rng);
+
+  BENCHMARK("Sub") {
+    return ours->sub(peers);
+  };
+
+  BENCHMARK("Or") {
+    return ours->or_op(peers);
+  };
+
+  BENCHMARK("Not") {
+    return peers->not_op();
+  };
+
+  BENCHMARK("PickRandom") {
+    return ours->pick_random();
+  };
+
+  BENCHMARK("PickRandom_Sparse") {
+    return sparse->pick_random();
+  };
+
+  BENCHMARK("PickSendVote") {
+    return ours->sub(peers)->pick_random();
+  };
+
+  BENCHMARK_ADVANCED("VoteSetBits")(Catch::Benchmark::Chronometer meter) {
+    // same steps as peer_state::apply_vote_set_bits_message
+    auto votes = peers->copy();
+    auto msg_votes = sparse->copy();
+    meter.measure([&] { return votes->update(votes->sub(ours)->or_op(msg_votes)); });
+  };
+
+  BENCHMARK("ToProto") {
+    return bit_array::to_proto(*ours);
+  };
+
+  auto pb = bit_array::to_proto(*ours);
+  BENCHMARK("FromProto") {
+    return bit_array::from_proto(*pb);
+  };
+}
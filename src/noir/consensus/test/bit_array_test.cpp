@@ -7,6 +7,7 @@
 #include <noir/common/hex.h>
 #include <noir/consensus/bit_array.h>
 #include <noir/core/codec.h>
+#include <set>
 
 using namespace noir;
 using namespace noir::consensus;
@@ -155,6 +156,30 @@ TEST_CASE("bit_array: Check operations", "[noir][consensus]") {
     CHECK(ba->get_index(0));
     CHECK(ba->get_index(4) == false);
   }
+
+  SECTION("not keeps unused bits clear") {
+    auto ba = bit_array::new_bit_array(70)->not_op();
+    CHECK(ba->get_true_indices().size() == 70);
+    CHECK(ba->get_bytes().size() == 9);
+    CHECK(ba->get_bytes()[8] == 0x3f);
+    CHECK(bit_array::to_proto(*ba)->elems(1) == 0x3f);
+  }
+
+  SECTION("pick_random") {
+    auto ba = bit_array::new_bit_array(200);
+    CHECK(std::get<1>(ba->pick_random()) == false);
+    ba->set_index(3, true);
+    ba->set_index(130, true);
+    ba->set_index(199, true);
+    CHECK(ba->get_true_indices() == std::vector<int>{3, 130, 199});
+    std::set<int> picked;
+    for (auto i = 0; i < 100; i++) {
+      auto [index, ok] = ba->pick_random();
+      CHECK(ok);
+      picked.insert(index);
+    }
+    CHECK(picked == std::set<int>{3, 130, 199});
+  }
 }
 
 TEST_CASE("bit_array: serialization", "[noir][consensus]") {
@@ -38,3 +38,31 @@ TEST_CASE("crypto: encode keys", "[noir][consensus]") {
   CHECK(base64::encode(pub_key_.key.data(), pub_key_.key.size()) == "tb5rjQ6RNY9zg96Fww9opbrSc6/fqVOSTbXpT2Cgt8g=");
   CHECK(addr == "BEB5FACCA0E17CF6C63DED5475A6E266120E692A");
 }
+
+TEST_CASE("crypto: batch verify ed25519", "[noir][consensus]") {
+  auto num_sigs = GENERATE(0, 1, 16, 17, 200);
+  std::vector<priv_key> keys;
+  batch_verifier verifier;
+  for (auto i = 0; i < num_sigs; ++i) {
+    auto& key = keys.emplace_back(priv_key::new_priv_key());
+    auto msg = from_hex(fmt::format("{:08x}", i));
+    CHECK(verifier.add(key.get_pub_key(), msg, key.sign(msg)) == i);
+  }
+  CHECK(verifier.size() == num_sigs);
+  CHECK(!verifier.verify().has_value());
+
+  if (num_sigs > 1) {
+    auto bad_index = num_sigs / 2;
+    batch_verifier bad;
+    for (auto i = 0; i < num_sigs; ++i) {
+      auto msg = from_hex(fmt::format("{:08x}", i));
+      auto sig = keys[i].sign(msg);
+      if (i >= bad_index)
+        sig[0] ^= 0x01;
+      bad.add(keys[i].get_pub_key(), msg, sig);
+    }
+    auto invalid = bad.verify();
+    REQUIRE(invalid.has_value());
+    CHECK(*invalid == bad_index);
+  }
+}
@@ -0,0 +1,142 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#include <catch2/catch_all.hpp>
+#include <noir/common/hex.h>
+#include <noir/consensus/wal.h>
+#include <noir/core/codec.h>
+#include <noir/crypto/rand.h>
+#include <iostream>
+
+using namespace noir;
+using namespace noir::consensus;
+
+namespace {
+
+wal_message make_vote_like_msg(int64_t height, int32_t index) {
+  Bytes bytes(128);
+  crypto::rand_bytes(bytes);
+  p2p::block_part_message bp_msg{.height = height, .round = 0, .index = static_cast<uint32_t>(index), .bytes_ = bytes};
+  return {p2p::internal_msg_info{.msg = bp_msg}};
+}
+
+/// frames msg as wal_encoder did before CRC32C framing: zero CRC and a length header formatted through hex
+bool legacy_encode_frame(const timed_wal_message& msg, Bytes& frame) {
+  auto dat = noir::encode(msg);
+  if (dat.size() > wal_file_manager::max_msg_size_bytes) {
+    return false;
+  }
+  frame = Bytes(4);
+  Bytes len_hdr = from_hex(fmt::format("{:08x}", static_cast<uint32_t>(dat.size())));
+  frame.raw().insert(frame.end(), len_hdr.begin(), len_hdr.end());
+  frame.raw().insert(frame.end(), dat.begin(), dat.end());
+  return true;
+}
+
+/// writes msg_num messages with write_sync from each of thread_num threads and returns per-call latencies
+std::vector<std::chrono::nanoseconds> run_writers(base_wal& wal_, size_t thread_num, size_t msg_num) {
+  std::vector<std::vector<std::chrono::nanoseconds>> latencies(thread_num);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < thread_num; ++t) {
+    threads.emplace_back([&, t]() {
+      auto msg = make_vote_like_msg(1, t);
+      latencies[t].reserve(msg_num);
+      for (size_t i = 0; i < msg_num; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        wal_.write_sync(msg);
+        latencies[t].push_back(std::chrono::steady_clock::now() - start);
+      }
+    });
+  }
+  for (auto& th : threads) {
+    th.join();
+  }
+  std::vector<std::chrono::nanoseconds> all;
+  for (auto& l : latencies) {
+    all.insert(all.end(), l.begin(), l.end());
+  }
+  return all;
+}
+
+} // namespace
+
+TEST_CASE("WalBenchmarks", "[noir][consensus]") {
+  static constexpr size_t rotate_size = 64 * 1024 * 1024;
+  static constexpr size_t msg_num = 200;
+
+  for (auto group_commit : {false, true}) {
+    for (auto thread_num : {1, 8, 32}) {
+      auto temp_dir = fc::temp_directory();
+      base_wal wal_(temp_dir.path().string(), "wal", 16, rotate_size, group_commit);
+
+      auto start = std::chrono::steady_clock::now();
+      auto latencies = run_writers(wal_, thread_num, msg_num);
+      auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      wal_.on_stop();
+
+      std::sort(latencies.begin(), latencies.end());
+      auto p99 = latencies[latencies.size() * 99 / 100];
+      std::cout << fmt::format("{:<14} threads={:<3} msgs/sec={:>10.0f} p99={:>8}us",
+                     group_commit ? "group_commit" : "encoder", thread_num, latencies.size() / elapsed,
+                     std::chrono::duration_cast<std::chrono::microseconds>(p99).count())
+                << std::endl;
+    }
+  }
+
+  for (auto heights : {100, 1000, 10000}) {
+    static constexpr size_t msgs_per_height = 20;
+    auto temp_dir = fc::temp_directory();
+    auto tmp_path = temp_dir.path().string();
+    {
+      base_wal wal_(tmp_path, "wal", 1024, 1024 * 1024, true);
+      for (int64_t height = 1; height <= heights; ++height) {
+        for (int32_t i = 0; i < msgs_per_height; ++i) {
+          wal_.write(make_vote_like_msg(height, i));
+        }
+        wal_.write({end_height_message{height}});
+      }
+      wal_.on_stop();
+    }
+    size_t wal_size = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(tmp_path)) {
+      if (!entry.path().string().ends_with(wal_index::postfix)) {
+        wal_size += std::filesystem::file_size(entry.path());
+      }
+    }
+
+    // restart: open the wal, check that #ENDHEIGHT for the next height does not exist, and find the last one
+    auto restart = [&]() {
+      auto start = std::chrono::steady_clock::now();
+      base_wal wal_(tmp_path, "wal", 1024, 1024 * 1024);
+      bool found;
+      wal_.search_for_end_height(heights + 1, {.ignore_data_corruption_errors = true}, found);
+      auto dec = wal_.search_for_end_height(heights, {.ignore_data_corruption_errors = true}, found);
+      CHECK(found);
+      return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    };
+    auto indexed = restart();
+    for (const auto& entry : std::filesystem::directory_iterator(tmp_path)) {
+      if (entry.path().string().ends_with(wal_index::postfix)) {
+        std::filesystem::remove(entry.path());
+      }
+    }
+    auto scanned = restart();
+    std::cout << fmt::format("restart wal_size={:>10}B heights={:<6} indexed={:>8}us scan={:>8}us", wal_size, heights,
+                   indexed.count(), scanned.count())
+              << std::endl;
+  }
+
+  BENCHMARK_ADVANCED("LegacyEncodeFrame")(Catch::Benchmark::Chronometer meter) {
+    timed_wal_message msg{.msg = make_vote_like_msg(1, 0)};
+    Bytes frame;
+    meter.measure([&]() { return legacy_encode_frame(msg, frame); });
+  };
+
+  BENCHMARK_ADVANCED("EncodeFrame")(Catch::Benchmark::Chronometer meter) {
+    timed_wal_message msg{.msg = make_vote_like_msg(1, 0)};
+    Bytes frame;
+    meter.measure([&]() { return wal_encoder::encode_frame(msg, frame); });
+  };
+}
@@ -6,7 +6,9 @@
 #include <catch2/catch_all.hpp>
 #include <noir/common/helper/go.h>
 #include <noir/consensus/wal.h>
+#include <noir/core/codec.h>
 #include <filesystem>
+#include <fstream>
 
 namespace {
 
@@ -219,6 +221,207 @@ TEST_CASE("wal_codec: simple encode/decode", "[noir][consensus]") {
   }
 }
 
+TEST_CASE("wal_codec: checksum", "[noir][consensus]") {
+  auto temp_dir = std::make_shared<fc::temp_directory>();
+  auto tmp_path = temp_dir->path().string();
+  auto wal_manager_ = std::make_shared<wal_file_manager>(tmp_path, "wal", 5, 0x1000);
+
+  timed_wal_message msg{.time = 1, .msg = {end_height_message{.height = 7}}};
+  size_t len;
+  auto enc = wal_manager_->get_wal_encoder();
+  CHECK(enc->encode(msg, len) == true);
+  CHECK(enc->encode(msg, len) == true);
+  CHECK(enc->flush_and_sync() == true);
+
+  SECTION("valid checksum") {
+    auto decoder = wal_manager_->get_wal_decoder(0);
+    timed_wal_message ret{};
+    CHECK(decoder->decode(ret) == wal_decoder::result::success);
+    CHECK(ret.time == msg.time);
+    CHECK(std::get<end_height_message>(ret.msg.msg).height == 7);
+  }
+
+  SECTION("corrupted value") {
+    {
+      fc::cfile file_;
+      file_.set_file_path(fs::path(tmp_path) / "wal");
+      file_.open(fc::cfile::update_rw_mode);
+      file_.seek(wal_encoder::header_size);
+      char c;
+      file_.read(&c, 1);
+      c ^= 0xff;
+      file_.seek(wal_encoder::header_size);
+      file_.write(&c, 1);
+      file_.flush();
+    }
+    auto decoder = wal_manager_->get_wal_decoder(0);
+    timed_wal_message ret{};
+    CHECK(decoder->decode(ret) == wal_decoder::result::corrupted);
+    // the next record is still readable
+    CHECK(decoder->decode(ret) == wal_decoder::result::success);
+    CHECK(decoder->decode(ret) == wal_decoder::result::eof);
+  }
+}
+
+TEST_CASE("wal_codec: legacy zero checksum", "[noir][consensus]") {
+  auto temp_dir = std::make_shared<fc::temp_directory>();
+  auto tmp_path = temp_dir->path().string();
+
+  // records written before CRC32C framing have a zero CRC followed by the big endian length
+  timed_wal_message msg{.time = 1, .msg = {end_height_message{.height = 7}}};
+  auto dat = noir::encode(msg);
+  noir::Bytes record(wal_encoder::header_size);
+  auto len = static_cast<uint32_t>(dat.size());
+  for (auto i = 0; i < 4; ++i) {
+    record[4 + i] = static_cast<unsigned char>(len >> (24 - 8 * i));
+  }
+  record.raw().insert(record.end(), dat.begin(), dat.end());
+  {
+    std::ofstream out(fs::path(tmp_path) / "wal", std::ios::binary);
+    out.write(reinterpret_cast<const char*>(record.data()), record.size());
+    out.write(reinterpret_cast<const char*>(record.data()), record.size());
+  }
+
+  wal_decoder decoder((fs::path(tmp_path) / "wal").string());
+  timed_wal_message ret{};
+  CHECK(decoder.decode(ret) == wal_decoder::result::success);
+  CHECK(ret.time == msg.time);
+  CHECK(std::get<end_height_message>(ret.msg.msg).height == 7);
+  CHECK(decoder.decode(ret) == wal_decoder::result::success);
+  CHECK(decoder.decode(ret) == wal_decoder::result::eof);
+
+  // new records appended after an upgrade are checksummed and decode alongside the old ones
+  auto wal_manager_ = std::make_shared<wal_file_manager>(tmp_path, "wal", 5, 0x1000);
+  size_t size;
+  auto enc = wal_manager_->get_wal_encoder();
+  CHECK(enc->encode(msg, size) == true);
+  CHECK(enc->flush_and_sync() == true);
+  auto appended = wal_manager_->get_wal_decoder(0);
+  for (auto i = 0; i < 3; ++i) {
+    CHECK(appended->decode(ret) == wal_decoder::result::success);
+  }
+  CHECK(appended->decode(ret) == wal_decoder::result::eof);
+}
+
+TEST_CASE("wal_index: end height index", "[noir][consensus]") {
+  static constexpr size_t enc_size = 0x400;
+  auto temp_dir = std::make_shared<fc::temp_directory>();
+  auto tmp_path = temp_dir->path().string();
+  auto wal_manager_ = std::make_shared<wal_file_manager>(tmp_path, "wal", 64, enc_size);
+
+  for (int64_t height = 1; height <= 30; ++height) {
+    size_t len;
+    wal_manager_->update();
+    auto enc = wal_manager_->get_wal_encoder();
+    CHECK(enc->encode(timed_wal_message{.time = height}, len) == true);
+    CHECK(enc->encode(timed_wal_message{.time = height, .msg = {end_height_message{height}}}, len) == true);
+  }
+  CHECK(wal_manager_->get_wal_encoder()->flush_and_sync() == true);
+  REQUIRE(wal_manager_->max_index > 0);
+
+  SECTION("every end height is indexed in its own file") {
+    int64_t expected = 1;
+    for (auto i = wal_manager_->min_index; i <= wal_manager_->max_index; ++i) {
+      auto path = wal_manager_->full_path(i);
+      CHECK(fs::exists(wal_index::path_of(path)) == true);
+      auto decoder = wal_manager_->get_wal_decoder(i);
+      for (const auto& e : wal_index::load(path)) {
+        CHECK(e.height == expected++);
+        decoder->seek(e.offset);
+        timed_wal_message ret{};
+        REQUIRE(decoder->decode(ret) == wal_decoder::result::success);
+        CHECK(std::get<end_height_message>(ret.msg.msg).height == e.height);
+      }
+    }
+    CHECK(expected == 31);
+  }
+
+  SECTION("missing index is rebuilt on open") {
+    auto head_path = wal_manager_->full_path(wal_manager_->max_index);
+    auto entries = wal_index::load(head_path);
+    REQUIRE(!entries.empty());
+    wal_manager_.reset();
+    fs::remove(wal_index::path_of(head_path));
+
+    wal_manager_ = std::make_shared<wal_file_manager>(tmp_path, "wal", 64, enc_size);
+    auto rebuilt = wal_index::load(head_path);
+    REQUIRE(rebuilt.size() == entries.size());
+    for (auto i = 0; i < entries.size(); ++i) {
+      CHECK(rebuilt[i].height == entries[i].height);
+      CHECK(rebuilt[i].offset == entries[i].offset);
+    }
+  }
+
+  SECTION("stale index is rebuilt on open") {
+    auto head_path = wal_manager_->full_path(wal_manager_->max_index);
+    {
+      std::ofstream out(wal_index::path_of(head_path), std::ios::binary | std::ios::trunc);
+      std::array<char, wal_index::entry_size> garbage{};
+      garbage[7] = 30;
+      garbage[15] = 3;
+      out.write(garbage.data(), garbage.size());
+    }
+    auto wal_ = std::make_shared<base_wal>(tmp_path, "wal", 64, enc_size);
+    CHECK(wal_index::load(head_path).back().height == 30);
+    bool found;
+    auto dec = wal_->search_for_end_height(30, {.ignore_data_corruption_errors = false}, found);
+    CHECK(found == true);
+    REQUIRE(dec != nullptr);
+    timed_wal_message ret{};
+    CHECK(dec->decode(ret) == wal_decoder::result::eof);
+  }
+}
+
+TEST_CASE("wal_group_writer: write and sync", "[noir][consensus]") {
+  static constexpr size_t enc_size = 0x1000;
+  static constexpr size_t rotation_file_num = 64;
+  auto temp_dir = std::make_shared<fc::temp_directory>();
+  auto tmp_path = temp_dir->path().string();
+  auto wal_manager_ = std::make_shared<wal_file_manager>(tmp_path, "wal", rotation_file_num, enc_size);
+  auto writer = std::make_unique<wal_group_writer>(*wal_manager_);
+
+  uint64_t thread_num = 5;
+  uint64_t total_msg_num = 200;
+  auto thread = std::make_unique<noir::named_thread_pool>("test_thread", thread_num);
+  std::vector<std::future<size_t>> futures;
+  for (auto t = 0; t < thread_num; ++t) {
+    futures.push_back(noir::async_thread_pool(thread->get_executor(), [&, t]() {
+      size_t count = 0;
+      for (auto i = 0; i < total_msg_num; ++i) {
+        timed_wal_message msg{.time = static_cast<noir::tstamp>(t * total_msg_num + i)};
+        if (writer->write(msg, i % 10 == 0)) {
+          ++count;
+        }
+      }
+      return count;
+    }));
+  }
+  size_t sum = 0;
+  for (auto& f : futures) {
+    sum += f.get();
+  }
+  CHECK(sum == total_msg_num * thread_num);
+  CHECK(writer->flush_and_sync() == true);
+  writer->stop();
+  CHECK(writer->write(timed_wal_message{}, false) == false);
+
+  std::vector<noir::tstamp> times;
+  for (auto i = wal_manager_->min_index; i <= wal_manager_->max_index; ++i) {
+    auto decoder = wal_manager_->get_wal_decoder(i);
+    timed_wal_message ret{};
+    wal_decoder::result res;
+    while ((res = decoder->decode(ret)) == wal_decoder::result::success) {
+      times.push_back(ret.time);
+    }
+    CHECK(res == wal_decoder::result::eof);
+  }
+  std::sort(times.begin(), times.end());
+  REQUIRE(times.size() == total_msg_num * thread_num);
+  for (auto i = 0; i < times.size(); ++i) {
+    CHECK(times[i] == i);
+  }
+}
+
 inline noir::Bytes gen_random_bytes(size_t num) {
   noir::Bytes ret(num);
   noir::crypto::rand_bytes(ret);
@@ -50,6 +50,8 @@ struct wrapped_tx {
       time_stamp(time_stamp) {}
   wrapped_tx(wrapped_tx const& rhs) = default;
   wrapped_tx(wrapped_tx&& rhs) = default;
+  wrapped_tx& operator=(wrapped_tx const& rhs) = default;
+  wrapped_tx& operator=(wrapped_tx&& rhs) = default;
 
   uint64_t size() const {
     return sizeof(*this) + tx_ptr->size();
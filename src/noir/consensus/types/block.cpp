@@ -69,64 +69,97 @@ std::shared_ptr<part_set> part_set::new_part_set_from_header(const p2p::part_set
   ret->parts_bit_array = bit_array::new_bit_array(header.total);
   ret->count = 0;
   ret->byte_size = 0;
+  ret->verified_parts.resize(header.total);
   return ret;
 }
 
 std::shared_ptr<part_set> part_set::new_part_set_from_data(const Bytes& data, uint32_t part_size) {
   // Divide data into 4KB parts
   uint32_t total = (data.size() + part_size - 1) / part_size;
-  std::vector<std::shared_ptr<part>> parts(total);
-  std::vector<Bytes> parts_bytes(total);
-  auto parts_bit_array = bit_array::new_bit_array(total);
+  std::vector<merkle::byte_slice> slices(total);
   for (auto i = 0; i < total; i++) {
-    auto first = data.begin() + (i * part_size);
-    auto last = data.begin() + (std::min((uint32_t)data.size(), (i + 1) * part_size));
-    auto part_ = std::make_shared<part>();
-    part_->index = i;
-    std::copy(first, last, std::back_inserter(part_->bytes_.raw()));
-    parts[i] = part_;
-    parts_bytes[i] = part_->bytes_;
-    parts_bit_array->set_index(i, true);
+    auto offset = static_cast<size_t>(i) * part_size;
+    slices[i] = {data.data() + offset, std::min<size_t>(part_size, data.size() - offset)};
   }
 
-  // Compute merkle proof
-  auto [root, proofs] = merkle::proofs_from_bytes_list(parts_bytes);
+  // Compute merkle proof; leaves are hashed in place, spread over the merkle pool for large blocks
+  auto [root, proofs] = merkle::proofs_from_byte_slices(slices);
+
+  std::vector<std::shared_ptr<part>> parts(total);
+  auto parts_bit_array = bit_array::new_bit_array(total);
   for (auto i = 0; i < total; i++) {
-    parts[i]->proof_ = *(proofs[i]);
+    parts[i] = std::make_shared<part>(part{static_cast<uint32_t>(i), Bytes(slices[i])});
+    parts[i]->proof_ = std::move(*proofs[i]);
+    parts_bit_array->set_index(i, true);
   }
 
   auto ret = std::make_shared<part_set>();
   ret->total = total;
   ret->hash = root;
-  ret->parts = parts;
+  ret->parts = std::move(parts);
   ret->parts_bit_array = parts_bit_array;
   ret->count = total;
   ret->byte_size = data.size();
+  ret->verified_parts.resize(total);
   return ret;
 }
 
-bool part_set::add_part(std::shared_ptr<part> part_) {
-  std::scoped_lock g(mtx);
+bool part_set::verify_part(const std::shared_ptr<part>& part_) {
+  if (part_->index >= total)
+    return false;
+  // a valid proof only vouches for the slot it was made for
+  if (part_->proof_.index != part_->index || part_->proof_.total != total)
+    return false;
 
-  if (part_->index >= total) {
-    elog("error part set unexpected index");
+  // total and hash never change once the part set is created, so the proof can be checked without mtx
+  if (auto err = part_->proof_.verify(hash, part_->bytes_); err.has_value())
     return false;
-  }
 
-  // If part already exists, return false.
-  if (parts.size() > 0 && parts.size() >= part_->index) {
+  std::scoped_lock g(mtx);
+  if (!parts[part_->index])
+    verified_parts[part_->index] = part_;
+  return true;
+}
+
+bool part_set::add_part(std::shared_ptr<part> part_) {
+  bool verified{false};
+  {
+    std::scoped_lock g(mtx);
+
+    if (part_->index >= total) {
+      elog("error part set unexpected index");
+      return false;
+    }
+    if (part_->proof_.index != part_->index || part_->proof_.total != total) {
+      elog("error part set proof does not match part index");
+      return false;
+    }
+
+    // If part already exists, return false.
     if (parts[part_->index])
       return false;
+
+    // Keep the part verified earlier if the bytes match, as its proof is known to be valid
+    if (auto& v = verified_parts[part_->index]; v && v->bytes_ == part_->bytes_) {
+      part_ = v;
+      verified = true;
+    }
   }
 
   // Check hash proof
-  if (auto err = part_->proof_.verify(get_hash(), part_->bytes_); err.has_value()) {
-    elog("error part set invalid proof");
-    return false;
+  if (!verified) {
+    if (auto err = part_->proof_.verify(hash, part_->bytes_); err.has_value()) {
+      elog("error part set invalid proof");
+      return false;
+    }
   }
 
   // Add part
+  std::scoped_lock g(mtx);
+  if (parts[part_->index])
+    return false;
   parts[part_->index] = part_;
+  verified_parts[part_->index].reset();
   parts_bit_array->set_index(part_->index, true);
   count++;
   byte_size += part_->bytes_.size();
@@ -143,9 +176,11 @@ Bytes block_data::get_hash() {
   if (this == nullptr) ///< NOT a very nice way of coding; need to refactor later
     return merkle::hash_from_bytes_list({});
   if (hash.empty()) {
+    crypto::Sha256 sha;
     merkle::bytes_list items;
+    items.reserve(txs.size());
     for (const auto& tx : txs)
-      items.push_back(crypto::Sha256()(tx));
+      items.push_back(sha(tx));
     hash = merkle::hash_from_bytes_list(items);
   }
   return hash;
@@ -215,6 +215,9 @@ struct part_set {
   int64_t byte_size{};
   std::mutex mtx;
 
+  /// parts whose proofs were checked by verify_part but which have not been added yet
+  std::vector<std::shared_ptr<part>> verified_parts{};
+
   part_set() = default;
   part_set(const part_set& p)
     : total(p.total),
@@ -222,12 +225,19 @@ struct part_set {
       parts(p.parts),
       parts_bit_array(p.parts_bit_array),
       count(p.count),
-      byte_size(p.byte_size) {}
+      byte_size(p.byte_size),
+      verified_parts(p.verified_parts) {}
 
   static std::shared_ptr<part_set> new_part_set_from_header(const p2p::part_set_header& header);
 
   static std::shared_ptr<part_set> new_part_set_from_data(const Bytes& data, uint32_t part_size);
 
+  /// \brief checks the proof of part_ without holding mtx
+  /// May be called concurrently (e.g. from reactor threads) ahead of add_part, which then only compares the bytes of
+  /// a part verified here instead of hashing it again.
+  /// \return true if the proof is valid for this part set
+  bool verify_part(const std::shared_ptr<part>& part_);
+
   bool add_part(std::shared_ptr<part> part_);
 
   bool is_complete() {
@@ -4,8 +4,10 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 //
 #pragma once
+#include <noir/common/time.h>
 #include <noir/p2p/protocol.h>
 #include <tendermint/types/canonical.pb.h>
+#include <cstring>
 
 namespace noir::consensus {
 
@@ -57,4 +59,166 @@ struct canonical {
   }
 };
 
+namespace detail {
+  inline size_t put_uvarint(unsigned char* out, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+      out[n++] = static_cast<unsigned char>(v | 0x80);
+      v >>= 7;
+    }
+    out[n++] = static_cast<unsigned char>(v);
+    return n;
+  }
+
+  inline void append_uvarint(Bytes& out, uint64_t v) {
+    unsigned char buf[10];
+    auto n = put_uvarint(buf, v);
+    out.raw().insert(out.end(), buf, buf + n);
+  }
+
+  inline void append_sfixed64(Bytes& out, int64_t v) {
+    auto u = static_cast<uint64_t>(v);
+    for (auto i = 0; i < 8; ++i) {
+      out.raw().push_back(static_cast<unsigned char>(u >> (8 * i)));
+    }
+  }
+
+  inline void append_bytes(Bytes& out, uint8_t tag, const Bytes& v) {
+    if (v.empty())
+      return;
+    out.raw().push_back(tag);
+    append_uvarint(out, v.size());
+    out.raw().insert(out.end(), v.begin(), v.end());
+  }
+} // namespace detail
+
+/// \brief writes length-prefixed canonical sign bytes of votes and proposals without building protobuf messages
+///
+/// Produces the same bytes as vote::vote_sign_bytes and proposal::proposal_sign_bytes. Fields preceding the timestamp
+/// and the trailing chain_id are encoded once on construction, so an encoder built for a commit can encode each of
+/// its precommits by writing only the timestamp.
+class canonical_encoder {
+public:
+  /// \brief creates an encoder for CanonicalVote
+  static canonical_encoder for_vote(const std::string& chain_id,
+    p2p::signed_msg_type type,
+    int64_t height,
+    int32_t round,
+    const p2p::block_id& block_id_) {
+    canonical_encoder ret;
+    if (type != p2p::Unknown) {
+      ret.prefix_.raw().push_back(0x08);
+      detail::append_uvarint(ret.prefix_, static_cast<uint64_t>(type));
+    }
+    append_height_round(ret.prefix_, height, round);
+    append_block_id(ret.prefix_, 0x22, block_id_);
+    ret.timestamp_tag_ = 0x2a;
+    detail::append_bytes(ret.suffix_, 0x32, Bytes{chain_id.begin(), chain_id.end()});
+    return ret;
+  }
+
+  /// \brief creates an encoder for CanonicalProposal
+  static canonical_encoder for_proposal(
+    const std::string& chain_id, int64_t height, int32_t round, int32_t pol_round, const p2p::block_id& block_id_) {
+    canonical_encoder ret;
+    ret.prefix_.raw().push_back(0x08);
+    detail::append_uvarint(ret.prefix_, static_cast<uint64_t>(p2p::Proposal));
+    append_height_round(ret.prefix_, height, round);
+    if (pol_round != 0) {
+      ret.prefix_.raw().push_back(0x20);
+      detail::append_uvarint(ret.prefix_, static_cast<uint64_t>(static_cast<int64_t>(pol_round)));
+    }
+    append_block_id(ret.prefix_, 0x2a, block_id_);
+    ret.timestamp_tag_ = 0x32;
+    detail::append_bytes(ret.suffix_, 0x3a, Bytes{chain_id.begin(), chain_id.end()});
+    return ret;
+  }
+
+  /// \brief upper bound of the number of bytes written by encode()
+  size_t max_size() const {
+    return max_uvarint_size + prefix_.size() + max_timestamp_size + suffix_.size();
+  }
+
+  /// \brief writes sign bytes for the given timestamp into a caller-provided buffer
+  /// \param[in] timestamp timestamp in microseconds
+  /// \param[out] out buffer of at least max_size() bytes
+  /// \return number of bytes written
+  size_t encode(tstamp timestamp, unsigned char* out) const {
+    // Timestamp is normalized the same way as TimeUtil::MicrosecondsToTimestamp
+    int64_t seconds = timestamp / 1000000;
+    int32_t nanos = static_cast<int32_t>(timestamp % 1000000) * 1000;
+    if (nanos < 0) {
+      nanos += 1000000000;
+      seconds -= 1;
+    }
+    unsigned char ts[max_timestamp_size];
+    size_t ts_size = 2;
+    if (seconds != 0) {
+      ts[ts_size++] = 0x08;
+      ts_size += detail::put_uvarint(ts + ts_size, static_cast<uint64_t>(seconds));
+    }
+    if (nanos != 0) {
+      ts[ts_size++] = 0x10;
+      ts_size += detail::put_uvarint(ts + ts_size, static_cast<uint64_t>(nanos));
+    }
+    ts[0] = timestamp_tag_;
+    ts[1] = static_cast<unsigned char>(ts_size - 2);
+
+    auto n = detail::put_uvarint(out, prefix_.size() + ts_size + suffix_.size());
+    std::memcpy(out + n, prefix_.data(), prefix_.size());
+    n += prefix_.size();
+    std::memcpy(out + n, ts, ts_size);
+    n += ts_size;
+    std::memcpy(out + n, suffix_.data(), suffix_.size());
+    return n + suffix_.size();
+  }
+
+  /// \brief writes sign bytes for the given timestamp, reusing the capacity of out
+  void encode(tstamp timestamp, Bytes& out) const {
+    out.resize(max_size());
+    out.resize(encode(timestamp, out.data()));
+  }
+
+private:
+  static constexpr size_t max_uvarint_size = 10;
+  // tag, length, seconds (tag + 10 bytes) and nanos (tag + 5 bytes)
+  static constexpr size_t max_timestamp_size = 2 + 11 + 6;
+
+  Bytes prefix_;
+  Bytes suffix_;
+  unsigned char timestamp_tag_{};
+
+  static void append_height_round(Bytes& out, int64_t height, int32_t round) {
+    if (height != 0) {
+      out.raw().push_back(0x11);
+      detail::append_sfixed64(out, height);
+    }
+    if (round != 0) {
+      out.raw().push_back(0x19);
+      detail::append_sfixed64(out, round);
+    }
+  }
+
+  static void append_block_id(Bytes& out, uint8_t tag, const p2p::block_id& block_id_) {
+    if (block_id_.hash.empty() && block_id_.parts.total == 0 && block_id_.parts.hash.empty())
+      return;
+    Bytes parts;
+    if (block_id_.parts.total != 0) {
+      parts.raw().push_back(0x08);
+      detail::append_uvarint(parts, block_id_.parts.total);
+    }
+    detail::append_bytes(parts, 0x12, block_id_.parts.hash);
+
+    Bytes bid;
+    detail::append_bytes(bid, 0x0a, block_id_.hash);
+    bid.raw().push_back(0x12);
+    detail::append_uvarint(bid, parts.size());
+    bid.raw().insert(bid.end(), parts.begin(), parts.end());
+
+    out.raw().push_back(tag);
+    detail::append_uvarint(out, bid.size());
+    out.raw().insert(out.end(), bid.begin(), bid.end());
+  }
+};
+
 } // namespace noir::consensus
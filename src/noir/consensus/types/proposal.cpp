@@ -24,4 +24,11 @@ Bytes proposal::proposal_sign_bytes(const std::string& chain_id, const ::tenderm
   return sign_bytes;
 }
 
+Bytes proposal::proposal_sign_bytes(const std::string& chain_id, const p2p::proposal_message& p) {
+  Bytes sign_bytes;
+  auto encoder = canonical_encoder::for_proposal(chain_id, p.height, p.round, p.pol_round, p.block_id_);
+  encoder.encode(p.timestamp, sign_bytes);
+  return sign_bytes;
+}
+
 } // namespace noir::consensus
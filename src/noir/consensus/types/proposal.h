@@ -54,6 +54,9 @@ struct proposal : p2p::proposal_message {
   }
 
   static Bytes proposal_sign_bytes(const std::string& chain_id, const ::tendermint::types::Proposal& p);
+
+  /// \brief encodes sign bytes directly with canonical_encoder, same as proposal_sign_bytes(chain_id, *to_proto(p))
+  static Bytes proposal_sign_bytes(const std::string& chain_id, const p2p::proposal_message& p);
 };
 
 } // namespace noir::consensus
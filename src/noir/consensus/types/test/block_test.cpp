@@ -33,6 +33,47 @@ TEST_CASE("block: make part_set", "[noir][consensus]") {
   CHECK(restored->data.txs[1] == Bytes{"1234"});
 }
 
+TEST_CASE("block: receive part_set parts", "[noir][consensus]") {
+  Bytes data(5 * 1000 + 17);
+  for (auto i = 0; i < data.size(); i++)
+    data[i] = static_cast<unsigned char>(i * 31);
+  auto org = part_set::new_part_set_from_data(data, 1000);
+  CHECK(org->total == 6);
+  CHECK(org->get_part(5)->bytes_.size() == 17);
+
+  auto received = part_set::new_part_set_from_header(org->header());
+  auto copy_part = [&](int index) { return std::make_shared<part>(*org->get_part(index)); };
+
+  SECTION("verified ahead of add") {
+    for (auto i = 0; i < org->total; i++) {
+      auto part_ = copy_part(i);
+      CHECK(received->verify_part(part_));
+      CHECK(received->add_part(copy_part(i)));
+      CHECK(received->add_part(part_) == false);
+    }
+    CHECK(received->is_complete());
+    CHECK(received->byte_size == data.size());
+  }
+
+  SECTION("tampered parts") {
+    auto bad = copy_part(2);
+    bad->bytes_[0] ^= 1;
+    CHECK(received->verify_part(bad) == false);
+    CHECK(received->add_part(bad) == false);
+
+    // a verified part does not vouch for different bytes at the same index
+    CHECK(received->verify_part(copy_part(2)));
+    CHECK(received->add_part(bad) == false);
+    CHECK(received->add_part(copy_part(2)));
+
+    auto wrong_index = copy_part(3);
+    wrong_index->index = 4;
+    CHECK(received->verify_part(wrong_index) == false);
+    CHECK(received->add_part(wrong_index) == false);
+    CHECK(received->count == 1);
+  }
+}
+
 TEST_CASE("block: encode using datastream", "[noir][consensus]") {
   block org{block_header{}, block_data{.txs = {{0}, {1}, {2}}}, {}, std::make_unique<commit>()};
   auto data = encode(org);
@@ -0,0 +1,59 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#include <catch2/catch_all.hpp>
+#include <noir/consensus/types/canonical.h>
+#include <noir/consensus/types/vote.h>
+#include <noir/crypto/rand.h>
+
+using namespace noir;
+using namespace noir::consensus;
+
+TEST_CASE("CanonicalBenchmarks", "[noir][consensus]") {
+  static constexpr int num_votes = 150;
+  const std::string chain_id = "test_chain_id";
+
+  Bytes hash(32), parts_hash(32);
+  crypto::rand_bytes(hash);
+  crypto::rand_bytes(parts_hash);
+  p2p::block_id block_id_{.hash = hash, .parts = {.total = 4, .hash = parts_hash}};
+
+  std::vector<vote> votes(num_votes);
+  for (auto i = 0; i < num_votes; ++i) {
+    votes[i].type = p2p::Precommit;
+    votes[i].height = 1000;
+    votes[i].round = 0;
+    votes[i].block_id_ = block_id_;
+    votes[i].timestamp = 1662616800000000 + i;
+    votes[i].validator_index = i;
+  }
+
+  BENCHMARK("VoteSignBytes_Protobuf") {
+    size_t total = 0;
+    for (const auto& v : votes) {
+      total += vote::vote_sign_bytes(chain_id, *vote::to_proto(v)).size();
+    }
+    return total;
+  };
+
+  BENCHMARK("VoteSignBytes_Encoder") {
+    size_t total = 0;
+    for (const auto& v : votes) {
+      total += vote::vote_sign_bytes(chain_id, v).size();
+    }
+    return total;
+  };
+
+  BENCHMARK("VoteSignBytes_SharedEncoder") {
+    auto encoder = canonical_encoder::for_vote(chain_id, p2p::Precommit, 1000, 0, block_id_);
+    Bytes buf;
+    size_t total = 0;
+    for (const auto& v : votes) {
+      encoder.encode(v.timestamp, buf);
+      total += buf.size();
+    }
+    return total;
+  };
+}
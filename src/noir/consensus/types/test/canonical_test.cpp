@@ -0,0 +1,107 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#include <catch2/catch_all.hpp>
+#include <noir/consensus/types/canonical.h>
+#include <noir/consensus/types/proposal.h>
+#include <noir/consensus/types/vote.h>
+#include <noir/crypto/rand.h>
+
+using namespace noir;
+using namespace noir::consensus;
+
+namespace {
+
+Bytes rand_bytes(size_t size) {
+  Bytes ret(size);
+  crypto::rand_bytes(ret);
+  return ret;
+}
+
+std::vector<p2p::block_id> block_ids() {
+  return {
+    {},
+    {.hash = rand_bytes(32), .parts = {.total = 1, .hash = rand_bytes(32)}},
+    {.hash = rand_bytes(32), .parts = {.total = 0, .hash = {}}},
+    {.hash = {}, .parts = {.total = 1000000, .hash = rand_bytes(32)}},
+    {.hash = rand_bytes(200), .parts = {.total = std::numeric_limits<uint32_t>::max(), .hash = rand_bytes(200)}},
+  };
+}
+
+std::vector<tstamp> timestamps() {
+  return {0, 1, 999999, 1000000, 1513998061234000, 1662616800000001, -1, -1000000, -1513998061234567};
+}
+
+std::vector<std::string> chain_ids() {
+  return {"", "test_chain_id", std::string(300, 'c')};
+}
+
+} // namespace
+
+TEST_CASE("canonical: vote sign bytes", "[noir][consensus]") {
+  auto type = GENERATE(p2p::Unknown, p2p::Prevote, p2p::Precommit);
+  auto height = GENERATE(int64_t(0), int64_t(1), int64_t(12345), std::numeric_limits<int64_t>::max());
+  auto round = GENERATE(0, 2, -1, std::numeric_limits<int32_t>::max());
+
+  for (const auto& chain_id : chain_ids()) {
+    for (const auto& block_id_ : block_ids()) {
+      auto encoder = canonical_encoder::for_vote(chain_id, type, height, round, block_id_);
+      Bytes buf;
+      for (auto ts : timestamps()) {
+        vote v{};
+        v.type = type;
+        v.height = height;
+        v.round = round;
+        v.block_id_ = block_id_;
+        v.timestamp = ts;
+
+        auto expected = vote::vote_sign_bytes(chain_id, *vote::to_proto(v));
+        encoder.encode(ts, buf);
+        CHECK(buf == expected);
+        CHECK(buf.size() <= encoder.max_size());
+        CHECK(vote::vote_sign_bytes(chain_id, v) == expected);
+      }
+    }
+  }
+}
+
+TEST_CASE("canonical: proposal sign bytes", "[noir][consensus]") {
+  auto height = GENERATE(int64_t(0), int64_t(1), int64_t(12345), std::numeric_limits<int64_t>::max());
+  auto round = GENERATE(0, 2, std::numeric_limits<int32_t>::max());
+  auto pol_round = GENERATE(-1, 0, 1);
+
+  for (const auto& chain_id : chain_ids()) {
+    for (const auto& block_id_ : block_ids()) {
+      auto encoder = canonical_encoder::for_proposal(chain_id, height, round, pol_round, block_id_);
+      Bytes buf;
+      for (auto ts : timestamps()) {
+        p2p::proposal_message msg{.type = p2p::Proposal,
+          .height = height,
+          .round = round,
+          .pol_round = pol_round,
+          .block_id_ = block_id_,
+          .timestamp = ts};
+
+        auto expected = proposal::proposal_sign_bytes(chain_id, *proposal::to_proto({msg}));
+        encoder.encode(ts, buf);
+        CHECK(buf == expected);
+        CHECK(buf.size() <= encoder.max_size());
+        CHECK(proposal::proposal_sign_bytes(chain_id, msg) == expected);
+      }
+    }
+  }
+}
+
+TEST_CASE("canonical: encode into caller buffer", "[noir][consensus]") {
+  auto block_id_ = p2p::block_id{.hash = rand_bytes(32), .parts = {.total = 3, .hash = rand_bytes(32)}};
+  auto encoder = canonical_encoder::for_vote("test_chain_id", p2p::Precommit, 100, 0, block_id_);
+  std::vector<unsigned char> buf(encoder.max_size());
+  for (auto ts : timestamps()) {
+    auto n = encoder.encode(ts, buf.data());
+    Bytes expected;
+    encoder.encode(ts, expected);
+    CHECK(Bytes{buf.begin(), buf.begin() + n} == expected);
+  }
+}
@@ -0,0 +1,78 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#include <catch2/catch_all.hpp>
+#include <noir/consensus/types/block.h>
+#include <noir/crypto/rand.h>
+#include <fmt/core.h>
+#include <iostream>
+#include <thread>
+
+using namespace noir;
+using namespace noir::consensus;
+
+namespace {
+
+template<typename F>
+double elapsed_ms(F&& f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// adds every part of org to a part set built from its header; with verify_threads > 0, proofs are checked
+/// concurrently before the parts are added, as reactor threads do, while adding stays serialized under a lock
+double receive(const std::shared_ptr<part_set>& org, size_t verify_threads) {
+  auto received = part_set::new_part_set_from_header(org->header());
+  std::vector<std::shared_ptr<part>> incoming;
+  for (auto i = 0; i < org->total; i++)
+    incoming.push_back(std::make_shared<part>(*org->get_part(i)));
+
+  std::mutex cs_mtx;
+  auto ms = elapsed_ms([&]() {
+    if (verify_threads == 0) {
+      for (const auto& p : incoming) {
+        std::scoped_lock g(cs_mtx);
+        received->add_part(p);
+      }
+      return;
+    }
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < verify_threads; ++t) {
+      threads.emplace_back([&]() {
+        for (auto i = next++; i < incoming.size(); i = next++) {
+          received->verify_part(incoming[i]);
+          std::scoped_lock g(cs_mtx);
+          received->add_part(incoming[i]);
+        }
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+  });
+  CHECK(received->is_complete());
+  return ms;
+}
+
+} // namespace
+
+TEST_CASE("PartSetBenchmarks", "[noir][consensus]") {
+  auto hw_threads = std::max(1u, std::thread::hardware_concurrency());
+  for (size_t proposal_size : {256 * 1024, 1024 * 1024, 4 * 1024 * 1024, 16 * 1024 * 1024}) {
+    Bytes data(proposal_size);
+    crypto::rand_bytes(data);
+
+    std::shared_ptr<part_set> org;
+    auto make_ms = elapsed_ms([&]() { org = part_set::new_part_set_from_data(data, block_part_size_bytes); });
+    for (size_t threads : {size_t(0), size_t(hw_threads)}) {
+      std::cout << fmt::format("proposal_size={:<9} parts={:<4} make_ms={:>8.2f} verify_threads={:<3} "
+                               "receive_ms={:>8.2f}",
+                     proposal_size, org->total, make_ms, threads, receive(org, threads))
+                << std::endl;
+    }
+  }
+}
@@ -0,0 +1,65 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#include <catch2/catch_all.hpp>
+#include <noir/consensus/common_test.h>
+#include <noir/consensus/types/validation.h>
+
+using namespace noir;
+using namespace noir::consensus;
+
+TEST_CASE("ValidatorSetBenchmarks", "[noir][consensus]") {
+  static constexpr int num_validators = 1000;
+  static constexpr int64_t height = 1;
+  const std::string chain_id = "test_chain_id";
+  auto [vals, priv_vals] = rand_validator_set(num_validators, 10);
+
+  p2p::block_id block_id_{.hash = gen_random_bytes(32), .parts = {.total = 1, .hash = gen_random_bytes(32)}};
+  std::vector<std::shared_ptr<vote>> votes;
+  for (auto& priv_val : priv_vals) {
+    auto address = priv_val->get_pub_key().address();
+    auto v = std::make_shared<vote>();
+    v->type = p2p::Precommit;
+    v->height = height;
+    v->round = 0;
+    v->block_id_ = block_id_;
+    v->timestamp = get_time();
+    v->validator_address = address;
+    v->validator_index = vals->get_index_by_address(address);
+    priv_val->sign_vote(chain_id, *v);
+    votes.push_back(v);
+  }
+
+  BENCHMARK("GetIndexByAddress") {
+    int64_t total = 0;
+    for (const auto& v : votes) {
+      total += vals->get_index_by_address(v->validator_address);
+    }
+    return total;
+  };
+
+  BENCHMARK_ADVANCED("AddVotes")(Catch::Benchmark::Chronometer meter) {
+    std::vector<std::shared_ptr<vote_set>> vote_sets(meter.runs());
+    for (auto& vote_set_ : vote_sets) {
+      vote_set_ = vote_set::new_vote_set(chain_id, height, 0, p2p::Precommit, vals);
+    }
+    meter.measure([&](int i) {
+      for (const auto& v : votes) {
+        vote_sets[i]->add_vote(v);
+      }
+      return vote_sets[i]->sum;
+    });
+  };
+
+  auto vote_set_ = vote_set::new_vote_set(chain_id, height, 0, p2p::Precommit, vals);
+  for (const auto& v : votes) {
+    vote_set_->add_vote(v);
+  }
+  auto commit_ = vote_set_->make_commit();
+
+  BENCHMARK("VerifyCommitLightTrusting") {
+    return verify_commit_light_trusting(chain_id, vals, commit_, default_trust_level).has_value();
+  };
+}
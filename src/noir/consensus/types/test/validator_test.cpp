@@ -5,6 +5,8 @@
 //
 #include <catch2/catch_all.hpp>
 #include <noir/common/hex.h>
+#include <noir/consensus/common_test.h>
+#include <noir/consensus/types/validation.h>
 #include <noir/consensus/types/validator.h>
 
 using namespace noir;
@@ -158,3 +160,100 @@ TEST_CASE("validator_set: Apply update", "[noir][consensus]") {
     CHECK(vals->get_by_index(1)->voting_power == 6);
   }
 }
+
+TEST_CASE("validator_set: address index", "[noir][consensus]") {
+  auto vals = validator_set::new_validator_set({{validator{from_hex("0044"), {}, 44}},
+    {validator{from_hex("0066"), {}, 66}}, {validator{from_hex("0022"), {}, 22}}});
+  auto check_index = [](const std::shared_ptr<validator_set>& vals) {
+    for (auto i = 0; i < vals->size(); i++) {
+      CHECK(vals->get_index_by_address(vals->validators[i].address) == i);
+      CHECK(vals->get_by_address(vals->validators[i].address)->voting_power == vals->validators[i].voting_power);
+    }
+  };
+  check_index(vals);
+  CHECK(vals->get_index_by_address(from_hex("0011")) == -1);
+  CHECK(!vals->has_address(from_hex("0011")));
+
+  SECTION("update with change set") {
+    auto copy_ = vals->copy();
+    auto ok = vals->update_with_change_set(
+      {validator{from_hex("0011"), {}, 100}, validator{from_hex("0066"), {}, 0}}, true);
+    REQUIRE(ok);
+    check_index(vals);
+    CHECK(vals->get_index_by_address(from_hex("0011")) == 0);
+    CHECK(!vals->has_address(from_hex("0066")));
+
+    // copy keeps the index of the original validators
+    check_index(copy_);
+    CHECK(copy_->has_address(from_hex("0066")));
+    CHECK(!copy_->has_address(from_hex("0011")));
+  }
+
+  SECTION("direct modification") {
+    vals->validators.push_back(validator{from_hex("0077"), {}, 1});
+    check_index(vals);
+
+    // a validator replaced in place, with the size unchanged, is found by its new address right away
+    auto old_address = vals->validators[0].address;
+    vals->validators[0].address = from_hex("0088");
+    CHECK(vals->get_index_by_address(from_hex("0088")) == 0);
+    CHECK(vals->get_index_by_address(old_address) == -1);
+    check_index(vals);
+
+    // the replaced address is not found through its stale entry either
+    old_address = vals->validators[1].address;
+    vals->validators[1].address = from_hex("0099");
+    CHECK(vals->get_index_by_address(old_address) == -1);
+    CHECK(vals->get_index_by_address(from_hex("0099")) == 1);
+    check_index(vals);
+  }
+}
+
+TEST_CASE("validator_set: verify_commit_light_trusting", "[noir][consensus]") {
+  static constexpr int num_validators = 100;
+  static constexpr int64_t height = 1;
+  const std::string chain_id = "test_chain_id";
+  auto [vals, priv_vals] = rand_validator_set(num_validators, 10);
+
+  p2p::block_id block_id_{.hash = gen_random_bytes(32), .parts = {.total = 1, .hash = gen_random_bytes(32)}};
+  auto vote_set_ = vote_set::new_vote_set(chain_id, height, 0, p2p::Precommit, vals);
+  for (auto& priv_val : priv_vals) {
+    auto address = priv_val->get_pub_key().address();
+    auto v = std::make_shared<vote>();
+    v->type = p2p::Precommit;
+    v->height = height;
+    v->round = 0;
+    v->block_id_ = block_id_;
+    v->timestamp = get_time();
+    v->validator_address = address;
+    v->validator_index = vals->get_index_by_address(address);
+    priv_val->sign_vote(chain_id, *v);
+    REQUIRE(vote_set_->add_vote(v).first);
+  }
+  auto commit_ = vote_set_->make_commit();
+
+  // signatures are checked in commit order only until the trust level is exceeded, which takes 34 of them at 1/3 and
+  // 67 at 2/3, and each check is split into several batches
+  SECTION("valid") {
+    CHECK(vals->verify_commit_light_trusting(chain_id, commit_, default_trust_level));
+    CHECK(vals->verify_commit_light_trusting(chain_id, commit_, {2, 3}));
+    CHECK(!vals->verify_commit_light_trusting(chain_id, commit_, {1, 0}));
+  }
+
+  SECTION("bad signature below threshold") {
+    commit_->signatures[20].signature = commit_->signatures[21].signature;
+    auto ok = vals->verify_commit_light_trusting(chain_id, commit_, default_trust_level);
+    REQUIRE(!ok);
+    CHECK(ok.error().message() == "verification failed: wrong signature - index=20");
+  }
+
+  SECTION("bad signature above threshold") {
+    commit_->signatures[50].signature = commit_->signatures[51].signature;
+    CHECK(vals->verify_commit_light_trusting(chain_id, commit_, default_trust_level));
+
+    // a higher trust level reaches it
+    auto ok = vals->verify_commit_light_trusting(chain_id, commit_, {2, 3});
+    REQUIRE(!ok);
+    CHECK(ok.error().message() == "verification failed: wrong signature - index=50");
+  }
+}
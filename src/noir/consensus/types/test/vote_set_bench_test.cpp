@@ -0,0 +1,93 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#include <catch2/catch_all.hpp>
+#include <noir/consensus/common_test.h>
+#include <iostream>
+#include <thread>
+
+using namespace noir;
+using namespace noir::consensus;
+
+namespace {
+
+/// signs a vote of the given type from every validator, as received during one round
+std::vector<std::shared_ptr<vote>> record_round(const std::string& chain_id,
+  const std::shared_ptr<validator_set>& vals,
+  const std::vector<std::shared_ptr<priv_validator>>& priv_vals,
+  p2p::signed_msg_type type,
+  const p2p::block_id& block_id_) {
+  std::vector<std::shared_ptr<vote>> votes;
+  for (auto& priv_val : priv_vals) {
+    auto address = priv_val->get_pub_key().address();
+    auto v = std::make_shared<vote>();
+    v->type = type;
+    v->height = 1;
+    v->round = 0;
+    v->block_id_ = block_id_;
+    v->timestamp = get_time();
+    v->validator_address = address;
+    v->validator_index = vals->get_index_by_address(address);
+    priv_val->sign_vote(chain_id, *v);
+    votes.push_back(v);
+  }
+  return votes;
+}
+
+/// replays votes into a fresh vote_set; with verify_threads > 0, votes are verified concurrently before being added
+/// as reactor threads do, while the tally is still updated by a single thread under a lock
+double replay(const std::string& chain_id,
+  const std::shared_ptr<validator_set>& vals,
+  const std::vector<std::shared_ptr<vote>>& votes,
+  size_t verify_threads) {
+  auto vote_set_ = vote_set::new_vote_set(chain_id, 1, 0, votes.front()->type, vals);
+  std::mutex cs_mtx;
+  auto start = std::chrono::steady_clock::now();
+  if (verify_threads == 0) {
+    for (const auto& v : votes) {
+      std::scoped_lock g(cs_mtx);
+      vote_set_->add_vote(v);
+    }
+  } else {
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < verify_threads; ++t) {
+      threads.emplace_back([&]() {
+        for (auto i = next++; i < votes.size(); i = next++) {
+          vote_set_->verify_vote(*votes[i]);
+          std::scoped_lock g(cs_mtx);
+          vote_set_->add_vote(votes[i]);
+        }
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+  }
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  CHECK(vote_set_->has_all());
+  return votes.size() / elapsed;
+}
+
+} // namespace
+
+TEST_CASE("VoteSetBenchmarks", "[noir][consensus]") {
+  const std::string chain_id = "test_chain_id";
+  p2p::block_id block_id_{.hash = gen_random_bytes(32), .parts = {.total = 1, .hash = gen_random_bytes(32)}};
+  auto hw_threads = std::max(1u, std::thread::hardware_concurrency());
+
+  for (auto num_validators : {100, 1000}) {
+    auto [vals, priv_vals] = rand_validator_set(num_validators, 10);
+    for (auto type : {p2p::Prevote, p2p::Precommit}) {
+      auto votes = record_round(chain_id, vals, priv_vals, type, block_id_);
+      for (size_t threads : {size_t(0), size_t(hw_threads)}) {
+        std::cout << fmt::format("validators={:<5} type={:<9} verify_threads={:<3} votes/sec={:>10.0f}",
+                       num_validators, type == p2p::Prevote ? "prevote" : "precommit", threads,
+                       replay(chain_id, vals, votes, threads))
+                  << std::endl;
+      }
+    }
+  }
+}
@@ -76,3 +76,51 @@ TEST_CASE("vote: verify signature", "[noir][consensus]") {
   // Verify
   CHECK(val.get_pub_key().verify_signature(bz_sign_bytes, vote_.signature));
 }
+
+TEST_CASE("vote_set: verify before add", "[noir][consensus]") {
+  std::vector<std::shared_ptr<priv_validator>> priv_vals;
+  std::vector<validator> valz;
+  for (auto i = 0; i < 4; i++) {
+    auto priv_val = std::make_shared<mock_pv>();
+    priv_val->priv_key_ = priv_key::new_priv_key();
+    priv_val->pub_key_ = priv_val->priv_key_.get_pub_key();
+    valz.push_back(validator{priv_val->pub_key_.address(), priv_val->pub_key_, 10, 0});
+    priv_vals.push_back(priv_val);
+  }
+  auto vals = validator_set::new_validator_set(valz);
+  auto vote_set_ = vote_set::new_vote_set("test_chain_id", 12345, 2, p2p::Prevote, vals);
+
+  auto make_vote = [&](int i) {
+    auto v = std::make_shared<vote>(example_prevote());
+    v->validator_address = priv_vals[i]->get_pub_key().address();
+    v->validator_index = vals->get_index_by_address(v->validator_address);
+    CHECK(!priv_vals[i]->sign_vote("test_chain_id", *v).has_value());
+    return v;
+  };
+
+  auto v0 = make_vote(0);
+  CHECK(!vote_set_->verify_vote(*v0));
+  auto [added, err] = vote_set_->add_vote(v0);
+  CHECK(added);
+  CHECK(!err);
+  CHECK(vote_set_->sum == 10);
+
+  // a verified signature must not be accepted for different sign bytes
+  auto v1 = make_vote(1);
+  CHECK(!vote_set_->verify_vote(*v1));
+  auto forged = std::make_shared<vote>(*v1);
+  forged->block_id_ = {};
+  CHECK(vote_set_->verify_vote(*forged));
+  std::tie(added, err) = vote_set_->add_vote(forged);
+  CHECK(!added);
+  CHECK(err);
+
+  std::tie(added, err) = vote_set_->add_vote(v1);
+  CHECK(added);
+  CHECK(vote_set_->sum == 20);
+
+  // wrong step
+  auto v2 = make_vote(2);
+  v2->round = 3;
+  CHECK(vote_set_->verify_vote(*v2));
+}
@@ -3,6 +3,7 @@
 // Copyright (c) 2022 Haderech Pte. Ltd.
 // SPDX-License-Identifier: AGPL-3.0-or-later
 //
+#include <noir/consensus/crypto.h>
 #include <noir/consensus/types/block.h>
 #include <noir/consensus/types/canonical.h>
 #include <noir/consensus/types/validation.h>
@@ -36,25 +37,28 @@ std::optional<std::string> verify_commit_single(const std::string& chain_id_,
   bool count_all_signatures,
   bool lookup_by_index) {
 
-  validator val{};
-  int32_t val_idx{0};
   int64_t tallied_voting_power{0};
   std::map<int32_t, int> seen_vals;
-  Bytes vote_sign_bytes;
+  batch_verifier verifier;
+  std::vector<int> sig_indices;
+  // Every verified signature is a precommit for the commit's block_id, differing only in its timestamp
+  auto encoder = canonical_encoder::for_vote(
+    chain_id_, p2p::signed_msg_type::Precommit, commit_->height, commit_->round, commit_->my_block_id);
 
+  // Collect signatures to verify first, then check all of them at once
   for (auto i = 0; i < commit_->signatures.size(); i++) {
     auto& commit_sig_ = commit_->signatures[i];
     if (!commit_sig_.for_block())
       continue;
 
+    const validator* val;
     if (lookup_by_index) {
-      val = vals->validators[i];
+      val = &vals->validators[i];
     } else {
-      auto val_opt = vals->get_by_address(commit_sig_.validator_address);
-      if (!val_opt.has_value())
-        continue;
-      val = val_opt.value();
       auto val_index = vals->get_index_by_address(commit_sig_.validator_address);
+      if (val_index < 0)
+        continue;
+      val = &vals->validators[val_index];
 
       // Check if same validator committed twice
       if (auto it = seen_vals.find(val_index); it != seen_vals.end()) {
@@ -64,16 +68,19 @@ std::optional<std::string> verify_commit_single(const std::string& chain_id_,
       seen_vals[val_index] = i;
     }
 
-    auto vote_ = commit_->get_vote(i);
-    vote_sign_bytes = vote::vote_sign_bytes(chain_id_, *vote::to_proto(*vote_));
-    if (!val.pub_key_.verify_signature(vote_sign_bytes, commit_sig_.signature))
-      return fmt::format("verification failed: wrong signature - index={}", i);
+    Bytes vote_sign_bytes;
+    encoder.encode(commit_sig_.timestamp, vote_sign_bytes);
+    verifier.add(val->pub_key_, std::move(vote_sign_bytes), commit_sig_.signature);
+    sig_indices.push_back(i);
 
-    tallied_voting_power += val.voting_power;
+    tallied_voting_power += val->voting_power;
     if (!count_all_signatures && tallied_voting_power > voting_power_needed)
-      return {};
+      break;
   }
 
+  if (auto invalid = verifier.verify(); invalid.has_value())
+    return fmt::format("verification failed: wrong signature - index={}", sig_indices[*invalid]);
+
   if (tallied_voting_power <= voting_power_needed)
     return "verification failed: not enough votes were signed";
   return {};
@@ -93,21 +100,27 @@ std::optional<std::string> verify_commit_light(const std::string& chain_id_,
   // Calculate required voting power
   auto voting_power_needed = vals->total_voting_power * 2 / 3;
 
-  // Batch verification // TODO: is this required?
-
-  // Single verification
   return verify_commit_single(chain_id_, vals, commit_, voting_power_needed, false, true);
 }
 
 Result<void> verify_commit_light_trusting(const std::string& chain_id_,
   const std::shared_ptr<validator_set>& vals,
-  const std::shared_ptr<commit>& commit_ /* TODO : trust_level */) {
+  const std::shared_ptr<commit>& commit_,
+  trust_level trust_level_) {
   if (!vals)
     return Error::format("null validator_set");
   if (!commit_)
     return Error::format("null commit");
+  if (trust_level_.numerator < 0 || trust_level_.denominator <= 0)
+    return Error::format("invalid trust_level: {}/{}", trust_level_.numerator, trust_level_.denominator);
 
-  // TODO : implement the rest
+  // Calculate required voting power
+  auto total_voting_power = vals->get_total_voting_power();
+  if (trust_level_.numerator > 0 && total_voting_power > std::numeric_limits<int64_t>::max() / trust_level_.numerator)
+    return Error::format("int64 overflow while calculating voting power needed");
+  auto voting_power_needed = total_voting_power * trust_level_.numerator / trust_level_.denominator;
+  if (auto err = verify_commit_single(chain_id_, vals, commit_, voting_power_needed, false, false); err.has_value())
+    return Error::format("{}", *err);
   return success();
 }
 
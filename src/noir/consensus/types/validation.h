@@ -29,8 +29,11 @@ std::optional<std::string> verify_commit_light(const std::string& chain_id_,
   int64_t height,
   const std::shared_ptr<struct commit>& commit_);
 
+/// \brief verifies more than trust_level of set has signed given commit
+/// Validators are looked up by address, as the set may differ from the one that signed the commit
 Result<void> verify_commit_light_trusting(const std::string& chain_id_,
   const std::shared_ptr<validator_set>& vals,
-  const std::shared_ptr<struct commit>& commit_);
+  const std::shared_ptr<struct commit>& commit_,
+  trust_level trust_level_);
 
 } // namespace noir::consensus
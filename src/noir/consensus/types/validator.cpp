@@ -39,9 +39,9 @@ Result<void> validator_set::verify_commit_light(
 }
 
 Result<void> validator_set::verify_commit_light_trusting(
-  const std::string& chain_id_, const std::shared_ptr<commit>& commit_) {
+  const std::string& chain_id_, const std::shared_ptr<commit>& commit_, trust_level trust_level_) {
   auto vals = std::make_shared<validator_set>(*this);
-  return noir::consensus::verify_commit_light_trusting(chain_id_, vals, commit_);
+  return noir::consensus::verify_commit_light_trusting(chain_id_, vals, commit_, trust_level_);
 }
 
 } // namespace noir::consensus
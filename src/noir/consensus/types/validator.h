@@ -9,6 +9,10 @@
 #include <noir/p2p/protocol.h>
 #include <noir/p2p/types.h>
 #include <tendermint/types/types.pb.h>
+#include <boost/functional/hash.hpp>
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
 
 namespace noir::consensus {
 
@@ -26,6 +30,15 @@ constexpr int64_t max_total_voting_power{std::numeric_limits<int64_t>::max() / 8
 // priorities.
 constexpr int64_t priority_window_size_factor{2};
 
+/// \brief fraction of the total voting power that must have signed a commit
+struct trust_level {
+  int64_t numerator;
+  int64_t denominator;
+};
+
+/// \brief default trust level of a light client, 1/3 of the voting power
+constexpr trust_level default_trust_level{1, 3};
+
 struct validator {
   Bytes address;
   pub_key pub_key_;
@@ -76,10 +89,85 @@ struct validator {
   }
 };
 
+/// \brief lazily built map from validator address to index; copies share the built map until validators change
+class validator_address_index {
+public:
+  validator_address_index() = default;
+  validator_address_index(const validator_address_index& other): index_(other.load()) {}
+
+  validator_address_index& operator=(const validator_address_index& other) {
+    if (this != &other) {
+      auto index = other.load();
+      std::scoped_lock g(mtx_);
+      index_ = std::move(index);
+    }
+    return *this;
+  }
+
+  /// \brief finds the index of the first validator with the given address
+  /// \return index of the validator, -1 if not found
+  int32_t find(const std::vector<validator>& validators, const Bytes& address) const {
+    auto index = load();
+    if (!index || index->num_validators != validators.size())
+      index = rebuild(validators);
+    // validators may have been modified in place without resetting the index, so neither a hit nor a miss is trusted
+    // until it is checked against validators
+    auto it = index->map.find(address);
+    if (it == index->map.end()) {
+      auto found =
+        std::find_if(validators.begin(), validators.end(), [&](const auto& v) { return v.address == address; });
+      if (found == validators.end())
+        return -1;
+      rebuild(validators);
+      return found - validators.begin();
+    }
+    if (validators[it->second].address != address)
+      return rebuild(validators)->find(address);
+    return it->second;
+  }
+
+  /// \brief drops the built map, must be called whenever validators are reordered or replaced
+  void reset() {
+    std::scoped_lock g(mtx_);
+    index_.reset();
+  }
+
+private:
+  struct index {
+    std::unordered_map<Bytes, int32_t, boost::hash<Bytes>> map;
+    size_t num_validators;
+
+    int32_t find(const Bytes& address) const {
+      auto it = map.find(address);
+      return it == map.end() ? -1 : it->second;
+    }
+  };
+
+  std::shared_ptr<const index> load() const {
+    std::scoped_lock g(mtx_);
+    return index_;
+  }
+
+  std::shared_ptr<const index> rebuild(const std::vector<validator>& validators) const {
+    auto ret = std::make_shared<index>();
+    ret->map.reserve(validators.size());
+    for (auto i = 0; i < validators.size(); i++)
+      ret->map.emplace(validators[i].address, i); // keeps the first one for duplicated addresses
+    ret->num_validators = validators.size();
+    std::scoped_lock g(mtx_);
+    index_ = ret;
+    return ret;
+  }
+
+  mutable std::mutex mtx_;
+  mutable std::shared_ptr<const index> index_;
+};
+
 struct validator_set : public std::enable_shared_from_this<validator_set> {
   std::vector<validator> validators;
   std::optional<validator> proposer;
   int64_t total_voting_power = 0;
+  validator_address_index address_index;
   // private:
   // validator_set() = default;
 
@@ -104,28 +192,18 @@ public:
 
   Bytes get_hash();
 
-  bool has_address(const Bytes& address) {
-    for (const auto& val : validators) {
-      if (val.address == address)
-        return true;
-    }
-    return false;
+  bool has_address(const Bytes& address) const {
+    return get_index_by_address(address) >= 0;
   }
 
-  std::optional<validator> get_by_address(const Bytes& address) {
-    for (auto val : validators) {
-      if (val.address == address)
-        return val;
-    }
+  std::optional<validator> get_by_address(const Bytes& address) const {
+    if (auto idx = get_index_by_address(address); idx >= 0)
+      return validators[idx];
     return {};
   }
 
-  int32_t get_index_by_address(const Bytes& address) {
-    for (auto idx = 0; idx < validators.size(); idx++) {
-      if (validators[idx].address == address)
-        return idx;
-    }
-    return -1;
+  int32_t get_index_by_address(const Bytes& address) const {
+    return address_index.find(validators, address);
   }
 
   std::optional<validator> get_by_index(int32_t index) {
@@ -210,6 +288,7 @@ public:
     validators.clear();
     for (auto j = 0; j < i; j++)
       validators.push_back(merged[j]);
+    address_index.reset();
   }
 
   /** \brief Removes the validators specified in 'deletes' from validator set 'vals'.
@@ -243,6 +322,7 @@ public:
     validators.clear();
     for (auto j = 0; j < i; j++)
       validators.push_back(merged[j]);
+    address_index.reset();
   }
 
   /** \brief attempts to update the validator set with 'changes'.
@@ -346,6 +426,7 @@ public:
         return a.address < b.address;
       return a.voting_power > b.voting_power;
     });
+    address_index.reset();
     return success();
   }
 
@@ -497,7 +578,8 @@ public:
     p2p::block_id block_id_,
     int64_t height,
     const std::shared_ptr<struct commit>& commit_);
-  Result<void> verify_commit_light_trusting(const std::string& chain_id, const std::shared_ptr<struct commit>& commit_);
+  Result<void> verify_commit_light_trusting(
+    const std::string& chain_id, const std::shared_ptr<struct commit>& commit_, trust_level trust_level_);
 };
 
 } // namespace noir::consensus
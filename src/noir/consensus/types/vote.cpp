@@ -36,6 +36,12 @@ Bytes vote::vote_sign_bytes(const std::string& chain_id, const ::tendermint::typ
   return sign_bytes;
 }
 
+Bytes vote::vote_sign_bytes(const std::string& chain_id, const vote& v) {
+  Bytes sign_bytes;
+  canonical_encoder::for_vote(chain_id, v.type, v.height, v.round, v.block_id_).encode(v.timestamp, sign_bytes);
+  return sign_bytes;
+}
+
 std::shared_ptr<vote_set> vote_set::new_vote_set(const std::string& chain_id_,
   int64_t height_,
   int32_t round_,
@@ -53,6 +59,7 @@ std::shared_ptr<vote_set> vote_set::new_vote_set(const std::string& chain_id_,
   ret->val_set = new_val_set;
   ret->votes_bit_array = bit_array::new_bit_array(val_set_->size());
   ret->votes.resize(val_set_->size());
+  ret->verified_votes.resize(val_set_->size());
   ret->sum = 0;
   return ret;
 }
@@ -62,57 +69,103 @@ std::shared_ptr<bit_array> vote_set::get_bit_array() {
   return votes_bit_array->copy();
 }
 
-std::pair<bool, Error> vote_set::add_vote(const std::shared_ptr<vote>& vote_) {
-  if (!vote_)
-    check(false, "add_vote() on empty vote_set");
-  std::scoped_lock g(mtx);
-
-  auto val_index = vote_->validator_index;
-  auto val_addr = vote_->validator_address;
-  auto block_key = vote_->block_id_.key();
+Error vote_set::check_vote(const vote& vote_) const {
+  auto val_index = vote_.validator_index;
+  const auto& val_addr = vote_.validator_address;
 
   // Ensure that validator index is set
   if (val_index < 0)
-    return {false, Error::format("index < 0: {}", ErrVoteInvalidValidatorIndex.message())};
+    return Error::format("index < 0: {}", ErrVoteInvalidValidatorIndex.message());
   if (val_addr.empty())
-    return {false, Error::format("empty address: {}", ErrVoteInvalidValidatorAddress.message())};
+    return Error::format("empty address: {}", ErrVoteInvalidValidatorAddress.message());
 
   // Make sure step matches
-  if ((vote_->height != height) || (vote_->round != round) || (vote_->type != signed_msg_type_)) {
-    return {false,
-      Error::format("expected {}/{}/{} but got {}/{}/{}", vote_->height, vote_->round, vote_->type, height, round,
-        signed_msg_type_)};
+  if ((vote_.height != height) || (vote_.round != round) || (vote_.type != signed_msg_type_)) {
+    return Error::format(
+      "expected {}/{}/{} but got {}/{}/{}", vote_.height, vote_.round, vote_.type, height, round, signed_msg_type_);
   }
 
   // Ensure that signer is a validator
-  auto val = val_set->get_by_index(val_index);
-  if (!val)
-    return {
-      false, Error::format("cannot find validator {} in val_set of size {}", val_index, val_set->validators.size())};
+  if (val_index >= val_set->size())
+    return Error::format("cannot find validator {} in val_set of size {}", val_index, val_set->validators.size());
 
   // Ensure that signer has the right address
-  if (val_addr != val->address)
-    return {false, Error::format("signer has wrong address")};
+  if (val_addr != val_set->validators[val_index].address)
+    return Error::format("signer has wrong address");
+  return {};
+}
 
-  // Check if the same vote exists
-  if (auto existing = get_vote(val_index, block_key); existing) {
-    if (existing->signature == vote_->signature) {
-      // duplicate
-      return {false, Error{}};
+Error vote_set::check_signature(const vote& vote_) {
+  auto val_index = vote_.validator_index;
+  const auto& val = val_set->validators[val_index];
+  auto sign_bytes = vote::vote_sign_bytes(chain_id, vote_);
+
+  auto& stripe = verified_mtx[val_index % num_verified_stripes];
+  {
+    std::scoped_lock g(stripe);
+    auto& verified = verified_votes[val_index];
+    if (verified.signature == vote_.signature && verified.sign_bytes == sign_bytes)
+      return {};
+  }
+
+  if (val.pub_key_.address() != vote_.validator_address)
+    return Error::format("invalid validator address");
+  if (!val.pub_key_.verify_signature(sign_bytes, vote_.signature))
+    return Error::format("invalid signature");
+
+  std::scoped_lock g(stripe);
+  verified_votes[val_index] = {std::move(sign_bytes), vote_.signature};
+  return {};
+}
+
+Error vote_set::verify_vote(const vote& vote_) {
+  if (auto err = check_vote(vote_); err)
+    return err;
+  return check_signature(vote_);
+}
+
+std::pair<bool, Error> vote_set::add_vote(const std::shared_ptr<vote>& vote_) {
+  if (!vote_)
+    check(false, "add_vote() on empty vote_set");
+
+  auto val_index = vote_->validator_index;
+  auto block_key = vote_->block_id_.key();
+
+  if (auto err = check_vote(*vote_); err)
+    return {false, err};
+
+  auto check_existing = [&]() -> std::optional<std::pair<bool, Error>> {
+    if (auto existing = get_vote(val_index, block_key); existing) {
+      if (existing->signature == vote_->signature) {
+        // duplicate
+        return std::make_pair(false, Error{});
+      }
+      elog("same vote exists");
+      return std::make_pair(false, ErrVoteNonDeterministicSignature);
     }
-    elog("same vote exists");
-    return {false, ErrVoteNonDeterministicSignature};
+    return {};
+  };
+
+  // Check if the same vote exists
+  {
+    std::scoped_lock g(mtx);
+    if (auto ret = check_existing(); ret)
+      return *ret;
   }
 
-  // Check signature
-  if (val->pub_key_.address() != val_addr)
-    return {false, Error::format("invalid validator address")};
-  auto vote_sign_bytes_ = vote::vote_sign_bytes(chain_id, *vote::to_proto(*vote_));
-  if (!val->pub_key_.verify_signature(vote_sign_bytes_, vote_->signature))
-    return {false, Error::format("invalid signature")};
+  // Check signature outside of the lock
+  if (auto err = check_signature(*vote_); err)
+    return {false, err};
+
+  std::scoped_lock g(mtx);
+  // The same vote may have been added while verifying
+  if (auto ret = check_existing(); ret)
+    return *ret;
+
+  const auto& val = val_set->validators[val_index];
 
   // Add vote and get conflicting vote if any
-  auto voting_power = val->voting_power;
+  auto voting_power = val.voting_power;
   std::shared_ptr<vote> conflicting{};
 
   // Already exists in vote_set.votes?
@@ -10,6 +10,8 @@
 #include <noir/p2p/types.h>
 
 #include <fmt/core.h>
+#include <array>
+#include <mutex>
 
 namespace noir::consensus {
 
@@ -71,6 +73,9 @@ struct vote : p2p::vote_message {
   }
 
   static Bytes vote_sign_bytes(const std::string& chain_id, const ::tendermint::types::Vote& v);
+
+  /// \brief encodes sign bytes directly with canonical_encoder, same as vote_sign_bytes(chain_id, *to_proto(v))
+  static Bytes vote_sign_bytes(const std::string& chain_id, const vote& v);
 };
 
 struct block_votes {
@@ -138,6 +143,10 @@ struct block_votes {
  * told us to track that block, each peer only gets to tell us 1 such block, and,
  * there's only a limited number of peers.
  *
+ * Signatures are checked outside of `mtx`, so `verify_vote` may be called concurrently (e.g. from reactor threads)
+ * ahead of `add_vote`. Successfully verified votes are remembered per validator index, guarded by striped locks,
+ * and `add_vote` skips checking their signatures again; only the tally update is serialized.
+ *
  * NOTE: Assumes that the sum total of voting power does not exceed MaxUInt64.
  */
 struct vote_set {
@@ -155,6 +164,15 @@ struct vote_set {
   std::map<std::string, std::shared_ptr<block_votes>> votes_by_block;
   std::map<P2PID, p2p::block_id> peer_maj23s;
 
+  /// last vote verified for each validator index
+  struct verified_vote {
+    Bytes sign_bytes;
+    Bytes signature;
+  };
+  static constexpr size_t num_verified_stripes = 16;
+  std::vector<verified_vote> verified_votes;
+  std::array<std::mutex, num_verified_stripes> verified_mtx;
+
   static std::shared_ptr<vote_set> new_vote_set(const std::string& chain_id_,
     int64_t height_,
     int32_t round_,
@@ -169,6 +187,16 @@ struct vote_set {
 
   std::pair<bool, Error> add_vote(const std::shared_ptr<vote>& vote_);
 
+  /// \brief checks whether a vote belongs to this set and is properly signed, without changing the tally
+  /// \param[in] vote_ vote to verify
+  /// \return empty error on success
+  Error verify_vote(const vote& vote_);
+
+private:
+  Error check_vote(const vote& vote_) const;
+  Error check_signature(const vote& vote_);
+
+public:
   std::shared_ptr<vote> get_vote(int32_t val_index, const std::string& block_key) {
     if (votes.size() > 0 && votes.size() > val_index && votes[val_index]) {
       auto& existing = votes[val_index];
@@ -7,50 +7,146 @@
 #include <noir/common/helper/go.h>
 #include <noir/consensus/wal.h>
 #include <noir/core/codec.h>
+#include <noir/crypto/hash/crc32c.h>
+#include <boost/interprocess/file_mapping.hpp>
+#include <fstream>
 
 namespace noir::consensus {
 using ::fc::cfile;
+namespace bip = boost::interprocess;
 
-wal_decoder::wal_decoder(const std::string& full_path): file_(std::make_unique<::fc::cfile>()) {
-  file_->set_file_path(full_path);
-  file_->open(cfile::update_rw_mode); // TODO: handle panic
+namespace {
+  inline void put_uint32_be(unsigned char* p, uint32_t v) {
+    p[0] = static_cast<unsigned char>(v >> 24);
+    p[1] = static_cast<unsigned char>(v >> 16);
+    p[2] = static_cast<unsigned char>(v >> 8);
+    p[3] = static_cast<unsigned char>(v);
+  }
+
+  inline uint32_t get_uint32_be(const unsigned char* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+  }
+
+  inline void put_uint64_be(unsigned char* p, uint64_t v) {
+    put_uint32_be(p, static_cast<uint32_t>(v >> 32));
+    put_uint32_be(p + 4, static_cast<uint32_t>(v));
+  }
+
+  inline uint64_t get_uint64_be(const unsigned char* p) {
+    return (uint64_t(get_uint32_be(p)) << 32) | get_uint32_be(p + 4);
+  }
+} // namespace
+
+std::vector<wal_index::entry> wal_index::load(const std::filesystem::path& wal_path) {
+  std::vector<entry> ret;
+  std::ifstream in(path_of(wal_path), std::ios::binary);
+  if (!in) {
+    return ret;
+  }
+  std::array<unsigned char, entry_size> buf;
+  while (in.read(reinterpret_cast<char*>(buf.data()), buf.size())) {
+    ret.push_back({static_cast<int64_t>(get_uint64_be(buf.data())), get_uint64_be(buf.data() + 8)});
+  }
+  return ret;
+}
+
+wal_decoder::wal_decoder(const std::string& full_path) {
+  if (std::filesystem::file_size(full_path) == 0) { // empty file cannot be mapped
+    return;
+  }
+  region_ = bip::mapped_region(bip::file_mapping(full_path.c_str(), bip::read_only), bip::read_only);
+  region_.advise(bip::mapped_region::advice_sequential);
+  data_ = {static_cast<const unsigned char*>(region_.get_address()), region_.get_size()};
 }
 
 wal_decoder::result wal_decoder::decode(timed_wal_message& msg) {
   std::scoped_lock g(mtx_);
+  if (pos_ + wal_encoder::header_size > data_.size()) {
+    pos_ = data_.size();
+    return result::eof;
+  }
+  auto crc = get_uint32_be(data_.data() + pos_);
+  auto len = get_uint32_be(data_.data() + pos_ + 4);
+  pos_ += wal_encoder::header_size;
+  if (len > wal_file_manager::max_msg_size_bytes) {
+    return result::corrupted;
+  }
+  if (pos_ + len > data_.size()) {
+    pos_ = data_.size();
+    return result::eof;
+  }
+  auto dat = data_.subspan(pos_, len);
+  pos_ += len;
+  // records written before checksums were introduced carry a zero CRC and are accepted unchecked
+  if (auto actual = crypto::Crc32c()(dat); crc != 0 && actual != crc) {
+    elog("checksums do not match: read ${read}, actual ${actual}", ("read", crc)("actual", actual));
+    return result::corrupted;
+  }
   try {
-    {
-      Bytes crc(4);
-      file_->read(reinterpret_cast<char*>(crc.data()), crc.size());
-      // TODO: check CRC32
-    }
-    size_t len;
-    {
-      Bytes len_(4);
-      file_->read(reinterpret_cast<char*>(len_.data()), len_.size());
-      len = stoull(to_hex(len_), nullptr, 16);
-      if (len > wal_file_manager::max_msg_size_bytes) {
-        return result::corrupted;
-      }
-    }
-    {
-      noir::Bytes dat(len);
-      file_->read(reinterpret_cast<char*>(dat.data()), len);
-      msg = noir::decode<timed_wal_message>(dat);
-    }
+    msg = noir::decode<timed_wal_message>(dat);
   } catch (...) {
-    if (file_->eof()) {
-      return result::eof;
-    }
     return result::corrupted;
   }
 
   return result::success;
 }
 
-wal_encoder::wal_encoder(const std::string& full_path): file_(std::make_unique<::fc::cfile>()) {
+void wal_decoder::seek(size_t offset) {
+  std::scoped_lock g(mtx_);
+  pos_ = std::min(offset, data_.size());
+}
+
+size_t wal_decoder::tell() {
+  std::scoped_lock g(mtx_);
+  return pos_;
+}
+
+wal_encoder::wal_encoder(const std::string& full_path)
+  : file_(std::make_unique<::fc::cfile>()), index_file_(std::make_unique<::fc::cfile>()) {
   file_->set_file_path(full_path);
   file_->open(cfile::create_or_update_rw_mode); // TODO: handle panic
+
+  // bring the index in sync with the records already in the file, so that it always covers a prefix of the file
+  index_file_->set_file_path(wal_index::path_of(full_path));
+  try {
+    auto entries = wal_index::load(full_path);
+    size_t start = 0;
+    if (std::filesystem::file_size(full_path) > 0) {
+      wal_decoder dec(full_path);
+      if (!entries.empty()) {
+        dec.seek(entries.back().offset);
+        timed_wal_message msg{};
+        if (dec.decode(msg) == wal_decoder::result::success) {
+          auto* ptr = std::get_if<end_height_message>(&msg.msg.msg);
+          if (ptr && ptr->height == entries.back().height) {
+            start = dec.tell();
+          }
+        }
+      }
+      index_file_->open(start > 0 ? cfile::create_or_update_rw_mode : cfile::truncate_rw_mode);
+      dec.seek(start);
+      for (;;) {
+        auto offset = dec.tell();
+        timed_wal_message msg{};
+        auto ret = dec.decode(msg);
+        if (ret == wal_decoder::result::eof) {
+          break;
+        }
+        if (ret != wal_decoder::result::success) {
+          continue;
+        }
+        if (auto* ptr = std::get_if<end_height_message>(&msg.msg.msg); ptr) {
+          append_index(ptr->height, offset);
+        }
+      }
+    } else {
+      index_file_->open(cfile::truncate_rw_mode);
+    }
+  } catch (...) {
+    elog("unable to open wal index: ${path}", ("path", index_file_->get_file_path().string()));
+    index_file_.reset();
+    std::filesystem::remove(wal_index::path_of(full_path));
+  }
 }
 
 bool wal_encoder::encode(const timed_wal_message& msg, size_t& size) {
@@ -72,24 +168,65 @@ bool wal_encoder::encode(const timed_wal_message& msg, size_t& size) {
     }
   });
 
-  auto dat = noir::encode(msg);
-  if (dat.size() > wal_file_manager::max_msg_size_bytes) { // TODO: handle error
-    elog("msg is too big: ${length} bytes, max: ${maxMsgSizeBytes} bytes",
-      ("length", dat.size())("maxMsgSizeBytes", wal_file_manager::max_msg_size_bytes));
+  Bytes buf;
+  if (!encode_frame(msg, buf)) { // TODO: handle error
     return false;
   }
 
-  Bytes crc(4); // TODO: CRC32
-  Bytes buf = crc;
-  Bytes len_hdr = from_hex(fmt::format("{:08x}", static_cast<uint32_t>(dat.size()))); // TODO: optimize
-  buf.raw().insert(buf.end(), len_hdr.begin(), len_hdr.end());
-  buf.raw().insert(buf.end(), dat.begin(), dat.end());
-
   file_->write(reinterpret_cast<const char*>(buf.data()), buf.size());
   size = buf.size();
+  if (auto* ptr = std::get_if<end_height_message>(&msg.msg.msg); ptr) {
+    append_index(ptr->height, file_->tellp() - buf.size());
+  }
+  return true;
+}
+
+bool wal_encoder::encode_frame(const timed_wal_message& msg, Bytes& frame) {
+  auto len = noir::encode_size(msg);
+  if (len > wal_file_manager::max_msg_size_bytes) {
+    elog("msg is too big: ${length} bytes, max: ${maxMsgSizeBytes} bytes",
+      ("length", len)("maxMsgSizeBytes", wal_file_manager::max_msg_size_bytes));
+    return false;
+  }
+
+  frame.resize(header_size + len);
+  auto dat = std::span(frame.data() + header_size, len);
+  datastream<unsigned char> ds(dat);
+  ds << msg;
+
+  put_uint32_be(frame.data(), crypto::Crc32c()(dat));
+  put_uint32_be(frame.data() + 4, static_cast<uint32_t>(len));
+  return true;
+}
+
+bool wal_encoder::write(std::span<const unsigned char> frames, std::span<const wal_index::entry> marks) {
+  std::scoped_lock g(mtx_);
+  try {
+    if (!file_->is_open()) {
+      file_->open(cfile::update_rw_mode);
+    }
+    file_->write(reinterpret_cast<const char*>(frames.data()), frames.size());
+    auto base = file_->tellp() - frames.size();
+    for (const auto& mark : marks) {
+      append_index(mark.height, base + mark.offset);
+    }
+  } catch (...) {
+    elog("fail to write wal file: ${path}", ("path", file_->get_file_path().string()));
+    return false;
+  }
   return true;
 }
 
+void wal_encoder::append_index(int64_t height, uint64_t offset) {
+  if (!index_file_) {
+    return;
+  }
+  std::array<unsigned char, wal_index::entry_size> buf;
+  put_uint64_be(buf.data(), static_cast<uint64_t>(height));
+  put_uint64_be(buf.data() + 8, offset);
+  index_file_->write(reinterpret_cast<const char*>(buf.data()), buf.size());
+}
+
 bool wal_encoder::flush_and_sync() {
   std::scoped_lock g(mtx_);
   if (!file_->is_open()) { // file is already closed no need to flush
@@ -98,6 +235,9 @@ bool wal_encoder::flush_and_sync() {
   try {
     file_->flush();
     file_->sync();
+    if (index_file_) { // written after the wal so that the index never points past durable records
+      index_file_->flush();
+    }
   } catch (...) {
     elog("fail to flush and sync");
     return false;
@@ -113,4 +253,108 @@ size_t wal_encoder::size() {
   return file_->tellp(); // TODO: handle exception
 }
 
+wal_group_writer::wal_group_writer(wal_file_manager& file_manager)
+  : file_manager_(file_manager), pending_(std::make_shared<batch>()) {
+  thread_ = std::thread([this]() { run(); });
+}
+
+wal_group_writer::~wal_group_writer() {
+  stop();
+}
+
+bool wal_group_writer::write(const timed_wal_message& msg, bool sync) {
+  // frame outside the lock so that concurrent callers serialize and checksum in parallel
+  Bytes frame;
+  if (!wal_encoder::encode_frame(msg, frame)) {
+    return false;
+  }
+
+  std::shared_ptr<batch> b;
+  {
+    std::scoped_lock g(mtx_);
+    if (stopped_) {
+      return false;
+    }
+    b = pending_;
+    if (auto* ptr = std::get_if<end_height_message>(&msg.msg.msg); ptr) {
+      b->marks.push_back({ptr->height, b->frames.size()});
+    }
+    b->frames.raw().insert(b->frames.end(), frame.begin(), frame.end());
+    b->sync |= sync;
+  }
+  work_cv_.notify_one();
+  return sync ? wait(b) : true;
+}
+
+bool wal_group_writer::flush_and_sync() {
+  std::shared_ptr<batch> b;
+  {
+    std::scoped_lock g(mtx_);
+    if (stopped_) {
+      return true;
+    }
+    b = pending_;
+    b->sync = true;
+  }
+  work_cv_.notify_one();
+  return wait(b);
+}
+
+void wal_group_writer::stop() {
+  {
+    std::scoped_lock g(mtx_);
+    if (stopped_) {
+      return;
+    }
+    stopped_ = true;
+  }
+  work_cv_.notify_one();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void wal_group_writer::run() {
+  for (;;) {
+    std::shared_ptr<batch> b;
+    {
+      std::unique_lock g(mtx_);
+      work_cv_.wait(g, [this]() { return stopped_ || !pending_->frames.empty() || pending_->sync; });
+      if (pending_->frames.empty() && !pending_->sync) { // stopped and drained
+        return;
+      }
+      b = std::exchange(pending_, std::make_shared<batch>());
+      pending_->frames.raw().reserve(b->frames.size());
+    }
+    auto ok = commit(*b);
+    {
+      std::scoped_lock g(mtx_);
+      b->ok = ok;
+      b->done = true;
+    }
+    done_cv_.notify_all();
+  }
+}
+
+bool wal_group_writer::commit(const batch& b) {
+  if (!file_manager_.update()) {
+    elog("Failed to rotate wal file");
+  }
+  auto enc = file_manager_.get_wal_encoder();
+  if (!b.frames.empty() && !enc->write(b.frames, b.marks)) {
+    elog("Error writing msgs to consensus wal. WARNING: recover may not be possible for the current height");
+    return false;
+  }
+  if (b.sync && !enc->flush_and_sync()) {
+    return false;
+  }
+  return true;
+}
+
+bool wal_group_writer::wait(const std::shared_ptr<batch>& b) {
+  std::unique_lock g(mtx_);
+  done_cv_.wait(g, [&b]() { return b->done; });
+  return b->ok;
+}
+
 } // namespace noir::consensus
@@ -12,8 +12,11 @@
 #include <noir/p2p/protocol.h>
 #include <boost/asio/steady_timer.hpp>
 #include <boost/filesystem/operations.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 #include <fc/io/cfile.hpp>
+#include <condition_variable>
 #include <filesystem>
+#include <thread>
 
 namespace noir::consensus {
 
@@ -44,10 +47,35 @@ struct wal_search_options {
   bool ignore_data_corruption_errors;
 };
 
+/// \brief Sparse index of #ENDHEIGHT records kept in a sidecar file next to each WAL file
+/// Format: repeated 8 Bytes height + 8 Bytes offset of the record in the WAL file (both big endian)
+/// The index is a hint only; an entry is trusted after the record at its offset decodes to the same #ENDHEIGHT.
+struct wal_index {
+  struct entry {
+    int64_t height;
+    uint64_t offset;
+  };
+
+  static constexpr std::string_view postfix = ".idx";
+  static constexpr size_t entry_size = 16;
+
+  /// \brief gets the sidecar path of the given WAL file
+  static std::filesystem::path path_of(const std::filesystem::path& wal_path) {
+    auto ret = wal_path;
+    ret += postfix;
+    return ret;
+  }
+
+  /// \brief loads all entries of the sidecar of the given WAL file; a trailing partial entry is ignored
+  /// \return entries in write order, empty if there is no sidecar
+  static std::vector<entry> load(const std::filesystem::path& wal_path);
+};
+
 /// \brief A WALDecoder reads and decodes custom-encoded WAL messages from an input
 /// stream. See WALEncoder for the format used.
 /// It will also compare the checksums and make sure data size is equal to the
 /// length from the header. If that is not the case, error will be returned.
+/// The file is memory-mapped read-only at construction, so records appended afterwards are not visible.
 class wal_decoder {
 public:
   enum class result {
@@ -62,17 +90,28 @@ public:
   /// \return result
   result decode(timed_wal_message& msg);
 
+  /// \brief moves the read position to the given offset
+  void seek(size_t offset);
+
+  /// \brief gets the current read position
+  size_t tell();
+
 private:
-  std::unique_ptr<::fc::cfile> file_;
+  boost::interprocess::mapped_region region_;
+  std::span<const unsigned char> data_;
+  size_t pos_ = 0;
   std::mutex mtx_;
 };
 
 /// \brief A WALEncoder writes custom-encoded WAL messages to an output stream.
-/// Format: 4 Bytes CRC sum + 4 Bytes length + arbitrary-length value
+/// Format: 4 Bytes CRC32C sum + 4 Bytes length + arbitrary-length value (header fields are big endian)
+/// A zero CRC marks a record written before checksums were introduced; the decoder does not verify it.
 class wal_encoder {
   friend class wal_file_manager;
 
 public:
+  static constexpr size_t header_size = 8;
+
   wal_encoder(const std::string& full_path);
 
   /// \brief writes the custom encoding of v to the stream. It returns an error if the encoded size of v is
@@ -82,6 +121,18 @@ public:
   /// \return true on success, false otherwise
   bool encode(const timed_wal_message& msg, size_t& size);
 
+  /// \brief builds a framed record (CRC + length header + value) of msg without writing it
+  /// \param[in] msg
+  /// \param[out] frame encoded record
+  /// \return true on success, false if the encoded msg is too big
+  static bool encode_frame(const timed_wal_message& msg, Bytes& frame);
+
+  /// \brief writes already framed records to the stream
+  /// \param[in] frames one or more records built by encode_frame
+  /// \param[in] marks #ENDHEIGHT records among frames, with offsets relative to the beginning of frames
+  /// \return true on success, false otherwise
+  bool write(std::span<const unsigned char> frames, std::span<const wal_index::entry> marks = {});
+
   /// \brief flushes and fsync the underlying group's data to disk.
   /// \return true on success, false otherwise
   bool flush_and_sync();
@@ -91,7 +142,10 @@ public:
   size_t size();
 
 private:
+  void append_index(int64_t height, uint64_t offset);
+
   std::unique_ptr<::fc::cfile> file_;
+  std::unique_ptr<::fc::cfile> index_file_;
   std::mutex mtx_;
 };
 
@@ -115,6 +169,8 @@ private:
 ///	- <HeadPath>.001   // Second rolled file
 ///	- ...
 ///	- <HeadPath>       // New head path
+///
+/// Each file has a <Path>.idx sidecar (see wal_index) which is renamed and removed along with it.
 class wal_file_manager {
 public:
   wal_file_manager(const std::string& dir, const std::string& file_name, size_t num_file, size_t rotate_size)
@@ -161,6 +217,10 @@ public:
     return make_shared<wal_decoder>(full_path(dir_path_, index).string());
   }
 
+  std::filesystem::path full_path(int64_t index) {
+    return full_path(dir_path_, index);
+  }
+
   std::filesystem::path full_path(std::filesystem::path dir_path, int64_t index, bool implicit = true) {
     if (implicit && index == current_index) {
       return head_path_;
@@ -205,6 +265,9 @@ private:
     if (sub_name.compare(corrupted_postfix) == 0) {
       return -1;
     }
+    if (sub_name.ends_with(wal_index::postfix)) {
+      return -1;
+    }
     return static_cast<int64_t>(std::stoull(name.substr(len)));
   }
 
@@ -221,6 +284,7 @@ private:
       encoder_->flush_and_sync();
       if (current_index - min_index >= num_file_) {
         std::filesystem::remove(full_path(dir_path_, min_index));
+        std::filesystem::remove(wal_index::path_of(full_path(dir_path_, min_index)));
         min_index++;
       }
       if (std::filesystem::exists(new_file_path)) {
@@ -229,6 +293,9 @@ private:
         wlog(fmt::format("wal file for new index {} already exists: {}", current_index, new_file_path.string()));
       }
       std::filesystem::rename(file_->get_file_path().string(), new_file_path);
+      if (auto index_path = wal_index::path_of(file_->get_file_path().string()); std::filesystem::exists(index_path)) {
+        std::filesystem::rename(index_path, wal_index::path_of(new_file_path));
+      }
       current_index = ++max_index;
       encoder_ = get_wal_encoder(current_index);
       ilog(fmt::format("created wal file for new index: {}", current_index));
@@ -259,6 +326,51 @@ private:
   }
 };
 
+/// \brief Group-commit writer for WAL files
+/// Records handed in by concurrent callers are framed on the caller's thread and appended to a pending batch. A
+/// dedicated writer thread commits each accumulated batch with a single write, followed by a single fsync if any record
+/// of the batch requested it. Callers arriving while a batch is being synced are coalesced into the next one.
+class wal_group_writer {
+public:
+  explicit wal_group_writer(wal_file_manager& file_manager);
+  wal_group_writer(const wal_group_writer&) = delete;
+  ~wal_group_writer();
+
+  /// \brief enqueues msg to the next batch
+  /// \param[in] msg
+  /// \param[in] sync blocks until the batch containing msg is written and fsynced if true
+  /// \return true on success, false otherwise
+  bool write(const timed_wal_message& msg, bool sync);
+
+  /// \brief blocks until all enqueued records are written and fsynced
+  /// \return true on success, false otherwise
+  bool flush_and_sync();
+
+  /// \brief commits remaining records and stops the writer thread
+  void stop();
+
+private:
+  struct batch {
+    Bytes frames;
+    std::vector<wal_index::entry> marks;
+    bool sync = false;
+    bool done = false;
+    bool ok = false;
+  };
+
+  void run();
+  bool commit(const batch& b);
+  bool wait(const std::shared_ptr<batch>& b);
+
+  wal_file_manager& file_manager_;
+  std::mutex mtx_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  std::shared_ptr<batch> pending_;
+  bool stopped_ = false;
+  std::thread thread_;
+};
+
 /// \brief WAL is an interface for any write-ahead logger.
 class wal {
 public:
@@ -304,9 +416,13 @@ public:
 class base_wal : public wal {
 public:
   base_wal(const base_wal&) = delete; // do not allow copy
-  base_wal(const std::string& dir, const std::string& file_name, size_t num_file, size_t rotate_size)
+  base_wal(const std::string& dir, const std::string& file_name, size_t num_file, size_t rotate_size,
+    bool group_commit = false)
     : file_manager_(std::make_unique<wal_file_manager>(dir, file_name, num_file, rotate_size)),
       flush_interval(std::chrono::seconds{2}) {
+    if (group_commit) {
+      group_writer_ = std::make_unique<wal_group_writer>(*file_manager_);
+    }
     thread_pool.emplace("consensus", thread_pool_size);
     {
       // std::scoped_lock g(flush_ticker_mtx);
@@ -318,6 +434,7 @@ public:
       flush_ticker->cancel();
       flush_ticker.reset();
     }
+    group_writer_.reset();
     file_manager_.reset();
     if (thread_pool) {
       thread_pool->stop();
@@ -325,6 +442,9 @@ public:
   }
 
   bool write(const wal_message& msg) override {
+    if (group_writer_) {
+      return group_writer_->write(timed_wal_message{.time = get_time(), .msg = msg}, false);
+    }
     size_t len;
     if (!file_manager_->update()) {
       elog("Failed to rotate wal file");
@@ -338,6 +458,15 @@ public:
   }
 
   bool write_sync(const wal_message& msg) override {
+    if (group_writer_) {
+      if (!group_writer_->write(timed_wal_message{.time = get_time(), .msg = msg}, true)) {
+        elog("WriteSync failed to write consensus wal.\n"
+             "\t\tWARNING: may result in creating alternative proposals / votes for the current height iff the node "
+             "restarted");
+        return false;
+      }
+      return true;
+    }
     if (!write(msg)) {
       return false;
     }
@@ -351,6 +480,9 @@ public:
   }
 
   bool flush_and_sync() override {
+    if (group_writer_) {
+      return group_writer_->flush_and_sync();
+    }
     return file_manager_->get_wal_encoder()->flush_and_sync();
   }
 
@@ -409,6 +541,31 @@ public:
     for (auto index = max_index; index >= min_index; --index) {
       auto decoder = file_manager_->get_wal_decoder(index);
 
+      // OPTIMIZATION: the index covers a prefix of the file, so jump straight to the indexed #ENDHEIGHT, or past the
+      // last indexed one and scan only the unindexed tail
+      if (auto entries = wal_index::load(file_manager_->full_path(index)); !entries.empty()) {
+        auto it = std::find_if(entries.begin(), entries.end(), [&](const auto& e) { return e.height == height; });
+        const auto& hint = it != entries.end() ? *it : entries.back();
+        decoder->seek(hint.offset);
+        timed_wal_message msg{};
+        auto* ptr = decoder->decode(msg) == wal_decoder::result::success
+          ? std::get_if<end_height_message>(&msg.msg.msg)
+          : nullptr;
+        if (ptr && ptr->height == hint.height) {
+          if (hint.height == height) { // found
+            found = true;
+            return std::move(decoder);
+          }
+          last_height_found = hint.height;
+          if (height < hint.height) {
+            continue; // not in this file; check next file
+          }
+        } else {
+          wlog("stale wal index: ${path}", ("path", file_manager_->full_path(index).string()));
+          decoder->seek(0);
+        }
+      }
+
       while (true) { // TODO: check exit condition
         using result = wal_decoder::result;
         timed_wal_message msg{};
@@ -450,6 +607,7 @@ public:
 
 private:
   std::unique_ptr<wal_file_manager> file_manager_;
+  std::unique_ptr<wal_group_writer> group_writer_; ///< set if group-commit mode is enabled
   // flush ticker
   std::unique_ptr<boost::asio::steady_timer> flush_ticker;
   std::chrono::system_clock::duration flush_interval;
@@ -0,0 +1,122 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#include <noir/crypto/hash/crc32c.h>
+#include <array>
+#include <bit>
+#include <cstring>
+
+#if defined(__x86_64__)
+#  include <nmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#  include <arm_acle.h>
+#endif
+
+namespace noir::crypto {
+
+namespace {
+  constexpr uint32_t crc32c_poly = 0x82f63b78; // reversed Castagnoli polynomial
+
+  constexpr auto make_table() {
+    std::array<std::array<uint32_t, 256>, 8> table{};
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t crc = i;
+      for (auto j = 0; j < 8; ++j) {
+        crc = (crc >> 1) ^ ((crc & 1) ? crc32c_poly : 0);
+      }
+      table[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; ++i) {
+      for (auto k = 1; k < 8; ++k) {
+        table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xff];
+      }
+    }
+    return table;
+  }
+
+  constexpr auto table = make_table();
+
+  /// slicing-by-8 software fallback
+  uint32_t update_sw(uint32_t crc, const unsigned char* p, size_t n) {
+    for (; n >= 8; p += 8, n -= 8) {
+      uint64_t v;
+      std::memcpy(&v, p, 8);
+      if constexpr (std::endian::native == std::endian::big) {
+        v = __builtin_bswap64(v);
+      }
+      v ^= crc;
+      crc = table[7][v & 0xff] ^ table[6][(v >> 8) & 0xff] ^ table[5][(v >> 16) & 0xff] ^
+        table[4][(v >> 24) & 0xff] ^ table[3][(v >> 32) & 0xff] ^ table[2][(v >> 40) & 0xff] ^
+        table[1][(v >> 48) & 0xff] ^ table[0][v >> 56];
+    }
+    for (; n > 0; ++p, --n) {
+      crc = (crc >> 8) ^ table[0][(crc ^ *p) & 0xff];
+    }
+    return crc;
+  }
+
+#if defined(__x86_64__)
+  __attribute__((target("sse4.2"))) uint32_t update_hw(uint32_t crc, const unsigned char* p, size_t n) {
+    uint64_t crc64 = crc;
+    for (; n >= 8; p += 8, n -= 8) {
+      uint64_t v;
+      std::memcpy(&v, p, 8);
+      crc64 = _mm_crc32_u64(crc64, v);
+    }
+    crc = static_cast<uint32_t>(crc64);
+    for (; n > 0; ++p, --n) {
+      crc = _mm_crc32_u8(crc, *p);
+    }
+    return crc;
+  }
+
+  const bool has_hw = __builtin_cpu_supports("sse4.2");
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+  uint32_t update_hw(uint32_t crc, const unsigned char* p, size_t n) {
+    for (; n >= 8; p += 8, n -= 8) {
+      uint64_t v;
+      std::memcpy(&v, p, 8);
+      crc = __crc32cd(crc, v);
+    }
+    for (; n > 0; ++p, --n) {
+      crc = __crc32cb(crc, *p);
+    }
+    return crc;
+  }
+
+  const bool has_hw = true;
+#else
+  uint32_t update_hw(uint32_t crc, const unsigned char* p, size_t n) {
+    return update_sw(crc, p, n);
+  }
+
+  const bool has_hw = false;
+#endif
+} // namespace
+
+auto Crc32c::init() -> Crc32c& {
+  state = 0xffffffff;
+  return *this;
+}
+
+auto Crc32c::update(std::span<const unsigned char> in) -> Crc32c& {
+  state = has_hw ? update_hw(state, in.data(), in.size()) : update_sw(state, in.data(), in.size());
+  return *this;
+}
+
+void Crc32c::final(std::span<unsigned char> out) {
+  auto crc = final();
+  std::memcpy(out.data(), (const unsigned char*)&crc, sizeof(decltype(crc)));
+}
+
+auto Crc32c::final() -> uint32_t {
+  return state ^ 0xffffffff;
+}
+
+bool Crc32c::hardware_accelerated() {
+  return has_hw;
+}
+
+} // namespace noir::crypto
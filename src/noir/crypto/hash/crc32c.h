@@ -0,0 +1,38 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#pragma once
+#include <noir/crypto/hash/hash.h>
+
+namespace noir::crypto {
+
+/// \brief generates crc32c (Castagnoli) checksum
+/// \details Uses SSE4.2 or ARMv8 CRC32 instructions when the running CPU supports them, and falls back to a
+/// table-driven implementation otherwise.
+/// \ingroup crypto
+struct Crc32c : public Hash<Crc32c> {
+  using Hash::update;
+
+  auto init() -> Crc32c&;
+  auto update(std::span<const unsigned char> in) -> Crc32c&;
+  void final(std::span<unsigned char> out);
+  auto final() -> uint32_t;
+
+  constexpr auto digest_size() const -> size_t {
+    return 4;
+  }
+
+  auto operator()(ByteSequence auto&& in) -> uint32_t {
+    return init().update(bytes_view(in)).final();
+  }
+
+  /// \brief returns true if checksum is computed by hardware instructions
+  static bool hardware_accelerated();
+
+private:
+  uint32_t state = 0xffffffff;
+};
+
+} // namespace noir::crypto
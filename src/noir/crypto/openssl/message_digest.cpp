@@ -17,7 +17,13 @@ void MessageDigest::init(const EVP_MD* type) {
   if (!ctx) {
     ctx = EVP_MD_CTX_new();
   }
-  EVP_DigestInit(ctx, type);
+  // re-initializing with the digest already bound to ctx skips the provider lookup, which dominates short inputs
+  if (md == type) {
+    EVP_DigestInit_ex(ctx, nullptr, nullptr);
+  } else {
+    EVP_DigestInit_ex(ctx, type, nullptr);
+    md = type;
+  }
 }
 
 void MessageDigest::update(std::span<const unsigned char> in) {
@@ -25,7 +31,7 @@ void MessageDigest::update(std::span<const unsigned char> in) {
 }
 
 void MessageDigest::final(std::span<unsigned char> out) {
-  EVP_DigestFinal(ctx, out.data(), nullptr);
+  EVP_DigestFinal_ex(ctx, out.data(), nullptr);
 }
 
 auto MessageDigest::digest_size(const EVP_MD* type) const -> size_t {
@@ -20,6 +20,7 @@ struct MessageDigest {
 
 protected:
   EVP_MD_CTX* ctx = nullptr;
+  const EVP_MD* md = nullptr;
 };
 /// \endcond
 
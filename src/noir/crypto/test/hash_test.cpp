@@ -121,3 +121,24 @@ TEST_CASE("hash: xxhash", "[noir][crypto]") {
     }
   }
 }
+
+TEST_CASE("hash: crc32c", "[noir][crypto]") {
+  auto tests = std::to_array<std::pair<std::string, uint32_t>>({
+    {"", 0x00000000},
+    {"123456789", 0xe3069283},
+    {"The quick brown fox jumps over the lazy dog", 0x22620404},
+  });
+
+  std::for_each(tests.begin(), tests.end(), [&](auto& t) { CHECK(Crc32c()(t.first) == t.second); });
+
+  {
+    auto hash = Crc32c();
+    for (const auto& test : tests) {
+      auto half = test.first.size() / 2;
+      hash.update(test.first.substr(0, half));
+      hash.update(test.first.substr(half));
+      CHECK(hash.final() == test.second);
+      hash.init();
+    }
+  }
+}
@@ -145,6 +145,11 @@ public:
   void undo();
   void commit();
 
+  /// \brief Applies all updates in the batch atomically.
+  /// \remarks Updates are expected to be added to the batch with column_family().get() as the handle, which is null
+  /// for the default column family.
+  rocksdb::Status write_batch(rocksdb::WriteBatch& batch);
+
   /// \brief Forces a flush on the underlying RocksDB db instance.
   void flush();
 
@@ -467,6 +472,10 @@ inline typename session<rocksdb_t>::iterator session<rocksdb_t>::lower_bound_fro
   return lower_bound(shared_bytes(key.data(), key.size()));
 }
 
+inline rocksdb::Status session<rocksdb_t>::write_batch(rocksdb::WriteBatch& batch) {
+  return m_db->Write(m_write_options, &batch);
+}
+
 inline void session<rocksdb_t>::flush() {
   rocksdb::FlushOptions op;
   op.allow_write_stall = true;
@@ -5,7 +5,10 @@
 //
 #pragma once
 #include <noir/common/hex.h>
+#include <noir/common/thread_pool.h>
 #include <noir/jmt/types.h>
+#include <algorithm>
+#include <future>
 #include <iosfwd>
 #include <unordered_map>
 
@@ -13,8 +16,15 @@ namespace noir::jmt {
 
 template<typename R, typename T = typename R::value_type>
 struct jellyfish_merkle_tree {
+  /// value sets with fewer keys are built on the calling thread even when a thread pool is given
+  static constexpr size_t min_parallel_kvs = 1024;
+
   jellyfish_merkle_tree(R& reader): reader(reader) {}
 
+  /// \brief builds the subtrees under different children of the root on thread_pool in batch_put_value_sets
+  /// reader must allow concurrent reads, and batch_put_value_sets must not be called from a thread of thread_pool.
+  jellyfish_merkle_tree(R& reader, named_thread_pool& thread_pool): reader(reader), thread_pool(&thread_pool) {}
+
   static jmt::nibble nibble(const Bytes32& bytes, size_t index) {
     auto upper = !(index % 2);
     return upper ? ((bytes[index / 2] & 0xf0) >> 4) : bytes[index / 2] & 0x0f;
@@ -99,11 +109,13 @@ struct jellyfish_merkle_tree {
     for (auto idx = 0; value_set != value_sets.end() && hash_set != hash_sets.end(); ++value_set, ++hash_set, ++idx) {
       check(value_set->size(), "transactions that output empty write set should not be included");
       auto version = first_version + idx;
-      std::map<Bytes32, T> sorted_kvs;
-      for (const auto& [k, v] : *value_set) {
-        sorted_kvs.insert_or_assign(k, v);
-      }
-      std::vector<std::pair<Bytes32, T>> deduped_and_sorted_kvs{sorted_kvs.begin(), sorted_kvs.end()};
+      // sorts by key and keeps the last value of each key
+      std::vector<std::pair<Bytes32, T>> deduped_and_sorted_kvs{value_set->begin(), value_set->end()};
+      std::stable_sort(deduped_and_sorted_kvs.begin(), deduped_and_sorted_kvs.end(),
+        [](const auto& a, const auto& b) { return std::get<0>(a) < std::get<0>(b); });
+      auto last = std::unique(deduped_and_sorted_kvs.rbegin(), deduped_and_sorted_kvs.rend(),
+        [](const auto& a, const auto& b) { return std::get<0>(a) == std::get<0>(b); });
+      deduped_and_sorted_kvs.erase(deduped_and_sorted_kvs.begin(), last.base());
       auto root_node_key = tree_cache.root_node_key;
       auto [new_root_node_key, _] =
         noir_ok(batch_insert_at(root_node_key, version, std::span(deduped_and_sorted_kvs), 0, *hash_set, tree_cache));
@@ -114,12 +126,61 @@ struct jellyfish_merkle_tree {
     return tree_cache.deltas();
   }
 
+  /// \brief builds the subtree of each child of a node at depth from the keys in kvs under that child
+  /// build_child(cache, child_index, child_kvs) builds one subtree. Under the root, with a thread pool and at least
+  /// min_parallel_kvs keys, the subtrees are built on the pool, each against its own tree_cache_shard, and the shards
+  /// are merged into tree_cache in child order once all of them are done.
+  /// \return child index, node key and node of the new child nodes, in child order
+  template<typename Cache, typename F>
+  auto build_children(std::span<std::pair<Bytes32, T>> kvs, size_t depth, Cache& tree_cache, F&& build_child)
+    -> Result<std::vector<std::tuple<jmt::nibble, jmt::node_key, jmt::node<T>>>> {
+    std::vector<std::pair<jmt::nibble, std::span<std::pair<Bytes32, T>>>> ranges;
+    auto it = nibble_range_iterator(kvs, depth);
+    while (auto v = it.next()) {
+      auto [left, right] = *v;
+      ranges.emplace_back(nibble(std::get<0>(kvs[left]), depth), kvs.subspan(left, (right - left + 1)));
+    }
+
+    std::vector<std::tuple<jmt::nibble, jmt::node_key, jmt::node<T>>> new_children;
+    new_children.reserve(ranges.size());
+    if constexpr (std::is_same_v<Cache, jmt::tree_cache<R, T>>) {
+      if (thread_pool && !depth && kvs.size() >= min_parallel_kvs && ranges.size() > 1) {
+        std::vector<jmt::tree_cache_shard<R, T>> shards;
+        shards.reserve(ranges.size());
+        std::vector<std::future<Result<std::pair<jmt::node_key, jmt::node<T>>>>> futures;
+        for (size_t i = 0; i < ranges.size(); ++i) {
+          auto& shard = shards.emplace_back(tree_cache);
+          futures.push_back(async_thread_pool(thread_pool->get_executor(),
+            [&, i]() { return build_child(shard, ranges[i].first, ranges[i].second); }));
+        }
+        // every task refers to shards and ranges, so all of them must finish before any result is looked at
+        for (auto& f : futures) {
+          f.wait();
+        }
+        for (size_t i = 0; i < ranges.size(); ++i) {
+          auto [new_child_node_key, new_child_node] = noir_ok(futures[i].get());
+          new_children.emplace_back(ranges[i].first, new_child_node_key, new_child_node);
+        }
+        for (auto& shard : shards) {
+          tree_cache.merge(shard);
+        }
+        return new_children;
+      }
+    }
+    for (const auto& [child_index, child_kvs] : ranges) {
+      auto [new_child_node_key, new_child_node] = noir_ok(build_child(tree_cache, child_index, child_kvs));
+      new_children.emplace_back(child_index, new_child_node_key, new_child_node);
+    }
+    return new_children;
+  }
+
+  template<typename Cache>
   auto batch_insert_at(jmt::node_key& node_key,
     jmt::version version,
     std::span<std::pair<Bytes32, T>> kvs,
     size_t depth,
     std::optional<std::reference_wrapper<std::unordered_map<nibble_path, Bytes32>>> hash_cache,
-    jmt::tree_cache<R, T>& tree_cache) -> Result<std::pair<jmt::node_key, node<T>>> {
+    Cache& tree_cache) -> Result<std::pair<jmt::node_key, node<T>>> {
     check(kvs.size());
     auto node = noir_ok(tree_cache.get_node(node_key));
     return std::visit(
@@ -127,22 +188,17 @@ struct jellyfish_merkle_tree {
         [&](jmt::internal_node& internal_node) -> Result<std::pair<jmt::node_key, jmt::node<T>>> {
           tree_cache.delete_node(node_key, false);
           auto children = internal_node.children;
-          auto it = nibble_range_iterator(kvs, depth);
-          while (auto v = it.next()) {
-            auto [left, right] = *v;
-            auto child_index = nibble(std::get<0>(kvs[left]), depth);
-            auto child = internal_node.child(child_index);
-            jmt::node_key new_child_node_key;
-            jmt::node<T> new_child_node;
-            if (child) {
+          auto build_child = [&](auto& cache, jmt::nibble child_index, std::span<std::pair<Bytes32, T>> child_kvs)
+            -> Result<std::pair<jmt::node_key, jmt::node<T>>> {
+            if (auto child = internal_node.child(child_index); child) {
               auto child_node_key = node_key.gen_child_node_key(child->get().version, child_index);
-              std::tie(new_child_node_key, new_child_node) = noir_ok(batch_insert_at(
-                child_node_key, version, kvs.subspan(left, (right - left + 1)), depth + 1, hash_cache, tree_cache));
-            } else {
-              auto new_child_node_key_ = node_key.gen_child_node_key(version, child_index);
-              std::tie(new_child_node_key, new_child_node) = noir_ok(batch_create_subtree(new_child_node_key_, version,
-                kvs.subspan(left, (right - left + 1)), depth + 1, hash_cache, tree_cache));
+              return batch_insert_at(child_node_key, version, child_kvs, depth + 1, hash_cache, cache);
             }
+            auto new_child_node_key = node_key.gen_child_node_key(version, child_index);
+            return batch_create_subtree(new_child_node_key, version, child_kvs, depth + 1, hash_cache, cache);
+          };
+          auto new_children = noir_ok(build_children(kvs, depth, tree_cache, build_child));
+          for (auto& [child_index, new_child_node_key, new_child_node] : new_children) {
             children.insert_or_assign(child_index,
               jmt::child{
                 get_hash(new_child_node_key, new_child_node, hash_cache), version, new_child_node.node_type()});
@@ -171,13 +227,14 @@ struct jellyfish_merkle_tree {
       node.data);
   }
 
+  template<typename Cache>
   auto batch_create_subtree_with_existing_leaf(const jmt::node_key& node_key,
     jmt::version version,
     jmt::leaf_node<T> existing_leaf_node,
     std::span<std::pair<Bytes32, T>> kvs,
     size_t depth,
     std::optional<std::reference_wrapper<std::unordered_map<nibble_path, Bytes32>>> hash_cache,
-    jmt::tree_cache<R, T>& tree_cache) -> Result<std::pair<jmt::node_key, node<T>>> {
+    Cache& tree_cache) -> Result<std::pair<jmt::node_key, node<T>>> {
     auto existing_leaf_key = existing_leaf_node.account_key;
     if (kvs.size() == 1 && std::get<0>(kvs[0]) == existing_leaf_key) {
       auto new_leaf_node = node<T>::leaf(existing_leaf_key, std::get<1>(kvs[0]));
@@ -216,25 +273,26 @@ struct jellyfish_merkle_tree {
     }
   }
 
+  template<typename Cache>
   auto batch_create_subtree(const jmt::node_key& node_key,
     jmt::version version,
     std::span<std::pair<Bytes32, T>> kvs,
     size_t depth,
     std::optional<std::reference_wrapper<std::unordered_map<nibble_path, Bytes32>>> hash_cache,
-    jmt::tree_cache<R, T>& tree_cache) -> Result<std::pair<jmt::node_key, node<T>>> {
+    Cache& tree_cache) -> Result<std::pair<jmt::node_key, node<T>>> {
     if (kvs.size() == 1) {
       auto new_leaf_node = node<T>::leaf(std::get<0>(kvs[0]), std::get<1>(kvs[0]));
       noir_ok(tree_cache.put_node(node_key, new_leaf_node));
       return std::make_pair(node_key, new_leaf_node);
     } else {
       jmt::children children;
-      auto it = nibble_range_iterator(kvs, depth);
-      while (auto v = it.next()) {
-        auto [left, right] = *v;
-        auto child_index = nibble(std::get<0>(kvs[left]), depth);
+      auto build_child = [&](auto& cache, jmt::nibble child_index, std::span<std::pair<Bytes32, T>> child_kvs)
+        -> Result<std::pair<jmt::node_key, jmt::node<T>>> {
         auto child_node_key = node_key.gen_child_node_key(version, child_index);
-        auto [new_child_node_key, new_child_node] = noir_ok(batch_create_subtree(
-          child_node_key, version, kvs.subspan(left, (right - left + 1)), depth + 1, hash_cache, tree_cache));
+        return batch_create_subtree(child_node_key, version, child_kvs, depth + 1, hash_cache, cache);
+      };
+      auto new_children = noir_ok(build_children(kvs, depth, tree_cache, build_child));
+      for (auto& [child_index, new_child_node_key, new_child_node] : new_children) {
         children.insert_or_assign(child_index,
           jmt::child{get_hash(new_child_node_key, new_child_node, hash_cache), version, new_child_node.node_type()});
       }
@@ -298,7 +356,7 @@ struct jellyfish_merkle_tree {
         auto new_child_node_key = node_key.gen_child_node_key(version, child_index);
         return create_leaf_node(new_child_node_key, nibble_iter, value, tree_cache);
       }());
-    auto& children = internal_node.children;
+    auto children = internal_node.children;
     children.insert_or_assign(child_index, jmt::child{new_child_node.hash(), version, new_child_node.node_type()});
     auto new_internal_node = jmt::internal_node(children);
     node_key.version = version;
@@ -366,7 +424,20 @@ struct jellyfish_merkle_tree {
     return success(std::make_pair(node_key, jmt::node<T>{new_leaf_node}));
   }
 
-  auto get_range_proof() {}
+  /// \brief proof that the leaf of rightmost_key_to_prove and everything left of it make up the tree at version
+  auto get_range_proof(const Bytes32& rightmost_key_to_prove, jmt::version version)
+    -> Result<sparse_merkle_range_proof> {
+    auto [value, proof] = noir_ok(get_with_proof(rightmost_key_to_prove, version));
+    noir_ensure(value.has_value(), "rightmost key {} does not exist", rightmost_key_to_prove.to_string());
+    auto range_proof = sparse_merkle_range_proof{};
+    // siblings go from the leaf up; the one at depth d is on the right where bit d of the key is 0
+    for (auto depth = proof.siblings.size(); const auto& sibling : proof.siblings) {
+      if (!key_bit(rightmost_key_to_prove, --depth)) {
+        range_proof.right_siblings.push_back(sibling);
+      }
+    }
+    return range_proof;
+  }
 
   auto get(const Bytes32& key, jmt::version version) -> Result<std::optional<T>> {
     return {std::get<0>(noir_ok(get_with_proof(key, version)))};
@@ -447,7 +518,7 @@ struct jellyfish_merkle_tree {
         }
       } else {
         if (std::holds_alternative<jmt::internal_node>(next_node.value().data)) {
-          auto internal_node = std::get<jmt::internal_node>(next_node.value().data);
+          const auto& internal_node = std::get<jmt::internal_node>(next_node.value().data);
           auto queried_child_index = expect(nibble_iter.next(), "ran out of nibbles");
           auto [child_node_key, siblings_in_internal] =
             internal_node.get_child_with_siblings(next_node_key, queried_child_index);
@@ -475,6 +546,22 @@ struct jellyfish_merkle_tree {
     noir_bail("jellyfish merkle tree has cyclic graph inside");
   }
 
+  /// \brief looks up many keys in one walk down the tree, proving them with siblings shared across keys
+  /// \param keys sorted and unique
+  auto get_with_multi_proof(std::span<const Bytes32> keys, jmt::version version)
+    -> Result<std::pair<std::vector<std::optional<T>>, sparse_merkle_multi_proof<T>>> {
+    noir_ensure(!keys.empty(), "no keys to prove");
+    for (size_t i = 1; i < keys.size(); ++i) {
+      noir_ensure(keys[i - 1] < keys[i], "keys are not sorted and unique at {}", i);
+    }
+    auto values = std::vector<std::optional<T>>(keys.size());
+    auto proof = sparse_merkle_multi_proof<T>{};
+    proof.leaves.resize(keys.size());
+    proof.depths.resize(keys.size());
+    noir_ok(collect_multi_proof(node_key{version}, keys, 0, keys.size(), 0, values, proof));
+    return std::make_pair(std::move(values), std::move(proof));
+  }
+
   void traverse_node(jmt::tree_cache<R, T>& tree_cache, const node_key& key, int depth) {
     std::cout << std::string(depth * 2, ' ') << key.to_string() << " ";
     auto node = tree_cache.get_node(key);
@@ -505,7 +592,82 @@ struct jellyfish_merkle_tree {
   }
 
 private:
+  auto collect_multi_proof(const node_key& key,
+    std::span<const Bytes32> keys,
+    size_t first,
+    size_t last,
+    size_t depth,
+    std::vector<std::optional<T>>& values,
+    sparse_merkle_multi_proof<T>& proof) -> Result<void> {
+    auto node = reader.get_node(key);
+    if (!node) {
+      if (!depth) {
+        return Error::format("missing state root node at version {}, probably pruned", key.version);
+      }
+      return node.error();
+    }
+    if (std::holds_alternative<jmt::internal_node>(node->data)) {
+      const auto& internal_node = std::get<jmt::internal_node>(node->data);
+      return collect_multi_proof(key, internal_node, 0, 16, keys, first, last, depth, values, proof);
+    } else if (std::holds_alternative<jmt::leaf_node<T>>(node->data)) {
+      const auto& leaf_node = std::get<jmt::leaf_node<T>>(node->data);
+      for (auto i = first; i < last; ++i) {
+        if (leaf_node.account_key == keys[i]) {
+          values[i] = leaf_node.value;
+        }
+        proof.leaves[i] = sparse_merkle_leaf_node{leaf_node.account_key, leaf_node.value_hash};
+        proof.depths[i] = depth;
+      }
+    } else {
+      noir_ensure(!depth, "non-root null node exists with node key {}", key.to_string());
+      for (auto i = first; i < last; ++i) {
+        proof.depths[i] = depth;
+      }
+    }
+    return success();
+  }
+
+  /// \brief walks the bit levels inside internal_node over children [start, start + width)
+  /// Mirrors internal_node::get_child_with_siblings, but follows every key instead of one.
+  auto collect_multi_proof(const node_key& key,
+    const jmt::internal_node& internal_node,
+    uint8_t start,
+    uint8_t width,
+    std::span<const Bytes32> keys,
+    size_t first,
+    size_t last,
+    size_t depth,
+    std::vector<std::optional<T>>& values,
+    sparse_merkle_multi_proof<T>& proof) -> Result<void> {
+    auto bitmaps = internal_node.generate_bitmaps();
+    auto [range_existence_bitmap, range_leaf_bitmap] = jmt::internal_node::range_bitmaps(start, width, bitmaps);
+    if (!range_existence_bitmap) {
+      for (auto i = first; i < last; ++i) {
+        proof.depths[i] = depth;
+      }
+      return success();
+    } else if (width == 1 || (std::has_single_bit(range_existence_bitmap) && range_leaf_bitmap)) {
+      auto only_child_index = jmt::nibble(std::countr_zero(range_existence_bitmap));
+      auto only_child_version = internal_node.child(only_child_index)->get().version;
+      return collect_multi_proof(
+        key.gen_child_node_key(only_child_version, only_child_index), keys, first, last, depth, values, proof);
+    }
+    auto half = uint8_t(width / 2);
+    auto mid = size_t(std::partition_point(keys.begin() + first, keys.begin() + last,
+                        [&](const auto& k) { return !key_bit(k, depth); }) -
+      keys.begin());
+    if (first < mid && mid < last) {
+      noir_ok(collect_multi_proof(key, internal_node, start, half, keys, first, mid, depth + 1, values, proof));
+      return collect_multi_proof(key, internal_node, start + half, half, keys, mid, last, depth + 1, values, proof);
+    }
+    auto [child_start, sibling_start] = mid == last ? std::array<uint8_t, 2>{start, uint8_t(start + half)}
+                                                    : std::array<uint8_t, 2>{uint8_t(start + half), start};
+    proof.siblings.push_back(internal_node.merkle_hash(sibling_start, half, bitmaps));
+    return collect_multi_proof(key, internal_node, child_start, half, keys, first, last, depth + 1, values, proof);
+  }
+
   R& reader;
+  named_thread_pool* thread_pool = nullptr;
 };
 
 } // namespace noir::jmt
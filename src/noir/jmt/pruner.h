@@ -0,0 +1,142 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#pragma once
+#include <noir/common/thread_pool.h>
+#include <noir/jmt/rocksdb_tree_store.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace noir::jmt {
+
+struct pruner_config {
+  /// number of latest versions that stay readable
+  version retained_versions = 1000;
+  /// most nodes deleted in one WriteBatch
+  size_t batch_size = 10000;
+  /// pause after each batch, which bounds the write rate of the pruner
+  std::chrono::milliseconds batch_interval{10};
+};
+
+/// \brief deletes stale nodes of a rocksdb_tree_store in the background, keeping the latest retained_versions readable
+/// Every set_latest_version() moves the target forward and wakes the pruner, which then deletes stale nodes in
+/// batches until it catches up. The store records progress along with each batch, so a restarted pruner resumes from
+/// the stale index.
+template<typename T>
+class pruner {
+public:
+  struct metrics {
+    /// least readable version the pruner has caught up with, nullopt before the first complete prune
+    std::optional<version> pruned_version;
+    /// least readable version the pruner is working towards
+    std::optional<version> target_version;
+    uint64_t pruned_nodes = 0;
+    uint64_t batches = 0;
+    uint64_t errors = 0;
+
+    /// versions still to be pruned
+    version backlog() const {
+      if (!target_version) {
+        return 0;
+      }
+      auto pruned = pruned_version ? *pruned_version : 0;
+      return *target_version > pruned ? *target_version - pruned : 0;
+    }
+  };
+
+  pruner(rocksdb_tree_store<T>& store, const pruner_config& config = {}): store(store), config(config) {}
+
+  pruner(const pruner&) = delete;
+  pruner& operator=(const pruner&) = delete;
+
+  ~pruner() {
+    stop();
+  }
+
+  /// \brief loads the progress of earlier runs and starts pruning in the background
+  auto start() -> Result<void> {
+    auto pruned_version = store.get_pruned_version();
+    if (!pruned_version) {
+      return pruned_version.error();
+    }
+    {
+      std::scoped_lock _{mtx};
+      noir_ensure(!started, "pruner already started");
+      started = true;
+      stats.pruned_version = pruned_version.value();
+    }
+    async_thread_pool(thread_pool.get_executor(), [this]() { run(); });
+    return success();
+  }
+
+  void stop() {
+    {
+      std::scoped_lock _{mtx};
+      stopping = true;
+    }
+    cv.notify_all();
+    thread_pool.stop();
+  }
+
+  /// \brief called after latest_version is committed to the store
+  void set_latest_version(version latest_version) {
+    if (latest_version + 1 <= config.retained_versions) {
+      return;
+    }
+    {
+      std::scoped_lock _{mtx};
+      auto target = latest_version + 1 - config.retained_versions;
+      if (stats.target_version && *stats.target_version >= target) {
+        return;
+      }
+      stats.target_version = target;
+    }
+    cv.notify_all();
+  }
+
+  auto get_metrics() -> metrics {
+    std::scoped_lock _{mtx};
+    return stats;
+  }
+
+private:
+  void run() {
+    std::unique_lock lock{mtx};
+    while (!stopping) {
+      if (!stats.target_version || stats.target_version == stats.pruned_version) {
+        cv.wait(lock);
+        continue;
+      }
+      auto target = *stats.target_version;
+      lock.unlock();
+      auto pruned = store.prune(target, config.batch_size);
+      lock.lock();
+      if (!pruned) {
+        // retried after the next interval
+        stats.errors++;
+      } else {
+        stats.pruned_nodes += pruned.value();
+        stats.batches++;
+        if (pruned.value() < config.batch_size) {
+          stats.pruned_version = target;
+        }
+      }
+      cv.wait_for(lock, config.batch_interval, [this]() { return stopping; });
+    }
+  }
+
+  rocksdb_tree_store<T>& store;
+  pruner_config config;
+
+  std::mutex mtx;
+  std::condition_variable cv;
+  bool started = false;
+  bool stopping = false;
+  metrics stats;
+  named_thread_pool thread_pool{"jmtprn", 1};
+};
+
+} // namespace noir::jmt
@@ -0,0 +1,233 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#pragma once
+#include <noir/common/clock_cache.h>
+#include <noir/db/rocks_session.h>
+#include <noir/jmt/types/node.h>
+#include <boost/endian/conversion.hpp>
+
+namespace noir::jmt {
+
+/// \brief persistent tree store over a RocksDB session
+///
+/// A node is stored under 1 Byte prefix + node_key::encode(), i.e. big endian version, number of nibbles and packed
+/// nibble path, so the nodes of a version are adjacent and ordered by path. Each leaf also has an empty record under
+/// the leaf index prefix + account key + encoded node key, which makes the rightmost leaf the last record of the
+/// index, found with one seek.
+///
+/// Nodes replaced by an update are recorded under the stale index prefix + big endian stale since version + encoded
+/// node key, written along with the update. prune() deletes them from the front of the index once no readable version
+/// refers to them, and keeps its progress under the metadata prefix.
+///
+/// Decoded internal nodes are kept in a clock_cache, as every lookup walks the same top levels of the tree. Nodes are
+/// never modified once written, so cached nodes need no invalidation until they are pruned.
+template<typename T>
+class rocksdb_tree_store : public tree_reader<T>, public tree_writer<T> {
+public:
+  using db_session_type = db::session::session<db::session::rocksdb_t>;
+
+  static constexpr size_t default_cache_size = 1 << 20;
+
+  explicit rocksdb_tree_store(std::shared_ptr<db_session_type> session, size_t cache_size = default_cache_size)
+    : session(std::move(session)), cache(cache_size) {}
+
+  auto get_node_option(const jmt::node_key& node_key) -> Result<std::optional<node<T>>> override {
+    if (auto cached = cache.get(node_key)) {
+      return node<T>{**cached};
+    }
+    auto key = encode_key(prefix::node, node_key.encode());
+    auto value = session->read({key.data(), key.size()});
+    if (!value) {
+      return success();
+    }
+    auto n = node<T>::decode({(uint8_t*)value->data(), value->size()});
+    if (!n) {
+      return Error::format("failed to decode node at key {}: {}", node_key.to_string(), n.error());
+    }
+    if (auto* internal = std::get_if<internal_node>(&n->data)) {
+      cache.put(node_key, std::make_shared<const internal_node>(*internal));
+    }
+    return *n;
+  }
+
+  auto get_rightmost_leaf() -> Result<std::optional<std::pair<jmt::node_key, leaf_node<T>>>> override {
+    auto end_key = encode_key(prefix(uint8_t(prefix::leaf_index) + 1), {});
+    auto it = session->lower_bound({end_key.data(), end_key.size()});
+    // steps back from the first record past the index, or from the end of the db
+    --it;
+    auto key = it.key();
+    if (!key.size() || uint8_t(key.data()[0]) != uint8_t(prefix::leaf_index)) {
+      return success();
+    }
+    noir_ensure(key.size() > leaf_index_key_size, "malformed leaf index key");
+    auto node_key = node_key::decode({(uint8_t*)key.data() + leaf_index_key_size, key.size() - leaf_index_key_size});
+    auto n = this->get_node(node_key);
+    if (!n) {
+      return n.error();
+    }
+    auto* leaf = std::get_if<leaf_node<T>>(&n->data);
+    noir_ensure(leaf, "leaf index refers to non-leaf node {}", node_key.to_string());
+    return std::make_pair(node_key, *leaf);
+  }
+
+  /// \brief writes all nodes of the batch and their leaf index records in a single WriteBatch
+  auto write_node_batch(const jmt::node_batch<T>& node_batch) -> Result<void> override {
+    auto batch = rocksdb::WriteBatch();
+    add_node_batch(batch, node_batch);
+    return write(batch, node_batch);
+  }
+
+  /// \brief writes the nodes and stale node indexes of an update in a single WriteBatch
+  auto write_tree_update_batch(const tree_update_batch<T>& update) -> Result<void> {
+    auto batch = rocksdb::WriteBatch();
+    auto* cf = session->column_family().get();
+    add_node_batch(batch, update.node_batch);
+    for (const auto& index : update.stale_node_index_batch) {
+      auto key = encode_stale_index_key(index);
+      batch.Put(cf, db::session::to_slice(key), rocksdb::Slice());
+    }
+    return write(batch, update.node_batch);
+  }
+
+  /// \brief deletes nodes that became stale at or before least_readable_version, oldest first
+  /// Versions before least_readable_version can't be read any more once their nodes are gone. Deleted nodes are
+  /// removed from the stale index in the same WriteBatch, so an interrupted prune continues where it stopped.
+  /// \param max_nodes most nodes deleted by this call
+  /// \return number of deleted nodes; fewer than max_nodes once every node stale at least_readable_version is gone,
+  /// which is then recorded as the pruned version
+  auto prune(version least_readable_version, size_t max_nodes) -> Result<size_t> {
+    auto stale = std::vector<std::pair<std::vector<uint8_t>, jmt::node_key>>();
+    {
+      auto begin_key = encode_key(prefix::stale_index, {});
+      for (auto it = session->lower_bound({begin_key.data(), begin_key.size()}); stale.size() < max_nodes; ++it) {
+        auto key = it.key();
+        if (key.size() <= stale_index_key_size || uint8_t(key.data()[0]) != uint8_t(prefix::stale_index)) {
+          break;
+        }
+        auto* p = (uint8_t*)key.data();
+        if (boost::endian::load_big_u64(p + 1) > least_readable_version) {
+          break;
+        }
+        stale.emplace_back(std::vector<uint8_t>(p, p + key.size()),
+          node_key::decode({p + stale_index_key_size, key.size() - stale_index_key_size}));
+      }
+    }
+
+    auto batch = rocksdb::WriteBatch();
+    auto* cf = session->column_family().get();
+    for (const auto& [_, node_key] : stale) {
+      auto encoded_key = node_key.encode();
+      auto key = encode_key(prefix::node, encoded_key);
+      // a leaf also has a leaf index record, which is keyed by its account key
+      if (auto value = session->read({key.data(), key.size()}); value && value->size() > leaf_index_key_size &&
+        uint8_t(value->data()[0]) == uint8_t(node_tag::leaf)) {
+        auto index_key = encode_key(prefix::leaf_index, {(uint8_t*)value->data() + 1, sizeof(Bytes32)});
+        index_key.insert(index_key.end(), encoded_key.begin(), encoded_key.end());
+        batch.Delete(cf, db::session::to_slice(index_key));
+      }
+      batch.Delete(cf, db::session::to_slice(key));
+    }
+    if (!stale.empty()) {
+      // the deleted records are the front of the stale index, up to and including the last one
+      auto end_key = stale.back().first;
+      end_key.push_back(0);
+      batch.DeleteRange(cf, db::session::to_slice(stale.front().first), db::session::to_slice(end_key));
+    }
+    if (stale.size() < max_nodes) {
+      auto key = encode_key(prefix::metadata, {&metadata_pruned_version, 1});
+      auto value = std::array<uint8_t, sizeof(version)>();
+      boost::endian::store_big_u64(value.data(), least_readable_version);
+      batch.Put(cf, db::session::to_slice(key), db::session::to_slice(value));
+    }
+    if (batch.Count()) {
+      if (auto status = session->write_batch(batch); !status.ok()) {
+        return Error::format("failed to prune stale nodes: {}", status.ToString());
+      }
+    }
+    for (const auto& [_, node_key] : stale) {
+      cache.del(node_key);
+    }
+    return stale.size();
+  }
+
+  /// \brief least readable version recorded by the last prune that caught up with it
+  auto get_pruned_version() -> Result<std::optional<version>> {
+    auto key = encode_key(prefix::metadata, {&metadata_pruned_version, 1});
+    auto value = session->read({key.data(), key.size()});
+    if (!value) {
+      return success();
+    }
+    noir_ensure(value->size() == sizeof(version), "malformed pruned version");
+    return boost::endian::load_big_u64((uint8_t*)value->data());
+  }
+
+  /// \brief number of decoded internal nodes in the cache
+  auto cached_nodes() const -> size_t {
+    return cache.size();
+  }
+
+private:
+  enum class prefix : uint8_t {
+    node = 0,
+    leaf_index = 1,
+    stale_index = 2,
+    metadata = 3,
+  };
+
+  static constexpr size_t leaf_index_key_size = 1 + sizeof(Bytes32);
+  static constexpr size_t stale_index_key_size = 1 + sizeof(version);
+  static constexpr uint8_t metadata_pruned_version = 0;
+
+  static auto encode_key(prefix p, std::span<const uint8_t> suffix) -> std::vector<uint8_t> {
+    auto key = std::vector<uint8_t>();
+    key.reserve(1 + suffix.size());
+    key.push_back(uint8_t(p));
+    key.insert(key.end(), suffix.begin(), suffix.end());
+    return key;
+  }
+
+  static auto encode_stale_index_key(const stale_node_index& index) -> std::vector<uint8_t> {
+    auto encoded_key = index.node_key.encode();
+    auto key = std::vector<uint8_t>(stale_index_key_size);
+    key[0] = uint8_t(prefix::stale_index);
+    boost::endian::store_big_u64(key.data() + 1, index.stale_since_version);
+    key.insert(key.end(), encoded_key.begin(), encoded_key.end());
+    return key;
+  }
+
+  void add_node_batch(rocksdb::WriteBatch& batch, const jmt::node_batch<T>& node_batch) {
+    auto* cf = session->column_family().get();
+    for (const auto& [node_key, node] : node_batch) {
+      auto encoded_key = node_key.encode();
+      auto key = encode_key(prefix::node, encoded_key);
+      auto value = node.encode();
+      batch.Put(cf, db::session::to_slice(key), db::session::to_slice(value));
+      if (auto* leaf = std::get_if<leaf_node<T>>(&node.data)) {
+        auto index_key = encode_key(prefix::leaf_index, leaf->account_key);
+        index_key.insert(index_key.end(), encoded_key.begin(), encoded_key.end());
+        batch.Put(cf, db::session::to_slice(index_key), rocksdb::Slice());
+      }
+    }
+  }
+
+  auto write(rocksdb::WriteBatch& batch, const jmt::node_batch<T>& node_batch) -> Result<void> {
+    if (auto status = session->write_batch(batch); !status.ok()) {
+      return Error::format("failed to write node batch: {}", status.ToString());
+    }
+    // new internal nodes are the top of the latest version, which the next update and lookups start from
+    for (const auto& [node_key, node] : node_batch) {
+      if (auto* internal = std::get_if<internal_node>(&node.data)) {
+        cache.put(node_key, std::make_shared<const internal_node>(*internal));
+      }
+    }
+    return success();
+  }
+
+  std::shared_ptr<db_session_type> session;
+  clock_cache<jmt::node_key, std::shared_ptr<const internal_node>, std::hash<jmt::node_key>> cache;
+};
+
+} // namespace noir::jmt
@@ -0,0 +1,328 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#pragma once
+#include <noir/jmt/jmt.h>
+
+namespace noir::jmt {
+
+/// \brief leaves of a snapshot, consecutive in key order, with a range proof for the last one
+template<typename T>
+struct snapshot_chunk {
+  /// \brief encodes the chunk as the bytes of an ABCI snapshot chunk
+  std::vector<uint8_t> encode() const {
+    auto bytes = codec::bcs::encode(std::tie(leaves, proof.right_siblings));
+    return {bytes.begin(), bytes.end()};
+  }
+
+  static Result<snapshot_chunk<T>> decode(std::span<const uint8_t> bytes) {
+    auto chunk = snapshot_chunk<T>{};
+    datastream<const unsigned char> ds(bytes);
+    ds >> chunk.leaves >> chunk.proof.right_siblings;
+    noir_ensure(!ds.remaining(), "{} bytes left after snapshot chunk", ds.remaining());
+    return chunk;
+  }
+
+  std::vector<std::pair<Bytes32, T>> leaves;
+  sparse_merkle_range_proof proof;
+};
+
+/// \brief reads the leaves of a version in key order, chunk_size leaves per chunk
+/// Only the internal nodes on the path to the next leaf are held, so a snapshot of any size is read in constant memory.
+/// seek() positions at any chunk by the leaf counts of the internal nodes, which lets chunks be served out of order.
+template<typename R, typename T = typename R::value_type>
+class snapshot_exporter {
+public:
+  static constexpr size_t default_chunk_size = 10000;
+
+  snapshot_exporter(R& reader, jmt::version version, size_t chunk_size = default_chunk_size)
+    : reader(reader), version(version), chunk_size(chunk_size) {
+    check(chunk_size, "chunk size must not be zero");
+  }
+
+  auto num_chunks() -> Result<size_t> {
+    auto root = noir_ok(reader.get_node(node_key{version}));
+    return (root.leaf_count() + chunk_size - 1) / chunk_size;
+  }
+
+  /// \brief positions at the first leaf of chunk_index, or past the last leaf if there is no such chunk
+  auto seek(size_t chunk_index) -> Result<void> {
+    stack.clear();
+    root_leaf.reset();
+    started = true;
+
+    auto skip = chunk_index * chunk_size;
+    auto key = node_key{version};
+    auto node = noir_ok(reader.get_node(key));
+    if (auto* leaf = std::get_if<leaf_node<T>>(&node.data)) {
+      if (!skip) {
+        root_leaf = std::move(*leaf);
+      }
+      return success();
+    }
+    while (auto* internal = std::get_if<internal_node>(&node.data)) {
+      auto& f = stack.emplace_back(frame{key, std::move(*internal), 16});
+      for (const auto& [n, c] : f.node.children) {
+        if (skip < c.leaf_count()) {
+          f.next = n.value;
+          break;
+        }
+        skip -= c.leaf_count();
+      }
+      if (f.next == 16) {
+        return success();
+      }
+      const auto& c = f.node.children.at(f.next);
+      if (c.is_leaf()) {
+        return success();
+      }
+      // the frame pushed for the child goes through it, so its parent continues after it
+      key = f.key.gen_child_node_key(c.version, f.next++);
+      node = noir_ok(reader.get_node(key));
+    }
+    noir_ensure(std::holds_alternative<null>(node.data) && stack.empty(), "non-root null node exists with node key {}",
+      key.to_string());
+    return success();
+  }
+
+  /// \return nullopt past the last leaf
+  auto next_chunk() -> Result<std::optional<snapshot_chunk<T>>> {
+    if (!started) {
+      noir_ok(seek(0));
+    }
+    auto chunk = snapshot_chunk<T>{};
+    chunk.leaves.reserve(chunk_size);
+    while (chunk.leaves.size() < chunk_size) {
+      auto leaf = noir_ok(next_leaf());
+      if (!leaf) {
+        break;
+      }
+      chunk.leaves.emplace_back(leaf->account_key, std::move(leaf->value));
+    }
+    if (chunk.leaves.empty()) {
+      return std::nullopt;
+    }
+    auto tree = jellyfish_merkle_tree<R, T>(reader);
+    chunk.proof = noir_ok(tree.get_range_proof(chunk.leaves.back().first, version));
+    return std::optional(std::move(chunk));
+  }
+
+private:
+  auto next_leaf() -> Result<std::optional<leaf_node<T>>> {
+    if (root_leaf) {
+      auto leaf = std::move(root_leaf);
+      root_leaf.reset();
+      return leaf;
+    }
+    while (!stack.empty()) {
+      auto& f = stack.back();
+      auto rest = uint16_t(f.node.children.existence_bitmap() & ~((uint32_t(1) << f.next) - 1));
+      if (!rest) {
+        stack.pop_back();
+        continue;
+      }
+      auto n = uint8_t(std::countr_zero(rest));
+      f.next = n + 1;
+      auto child_key = f.key.gen_child_node_key(f.node.children.at(n).version, n);
+      auto child = noir_ok(reader.get_node(child_key));
+      if (auto* leaf = std::get_if<leaf_node<T>>(&child.data)) {
+        return std::optional(std::move(*leaf));
+      } else if (auto* internal = std::get_if<internal_node>(&child.data)) {
+        stack.push_back({child_key, std::move(*internal), 0});
+      } else {
+        noir_bail("non-root null node exists with node key {}", child_key.to_string());
+      }
+    }
+    return std::nullopt;
+  }
+
+  /// internal node on the path to the next leaf and the first child not yet visited
+  struct frame {
+    node_key key;
+    internal_node node;
+    uint8_t next;
+  };
+
+  R& reader;
+  jmt::version version;
+  size_t chunk_size;
+  bool started = false;
+  std::vector<frame> stack;
+  std::optional<leaf_node<T>> root_leaf;
+};
+
+/// \brief rebuilds a tree at version from its leaves in key order, bottom-up, writing each node once
+/// The internal nodes on the path to the last added leaf stay open; a node is written as soon as a key outside of it
+/// arrives, so nothing is read back and no node is replaced. The last leaf itself is held until the next key or
+/// finish(), as its depth depends on the key after it.
+///
+/// add_chunk() checks the range proof of a chunk against the expected root hash before anything of the chunk is
+/// written. The hashes on the left of the path come from the open nodes, so a chunk proves every leaf added so far. A
+/// rejected chunk leaves the restorer as it was, and the chunk can be fetched again.
+template<typename T>
+class snapshot_restorer {
+public:
+  /// \param expected_root_hash root hash the restored tree must have, nullopt to trust the leaves as they are
+  snapshot_restorer(tree_writer<T>& writer, jmt::version version, std::optional<Bytes32> expected_root_hash = {})
+    : writer(writer), version(version), expected_root_hash(expected_root_hash) {}
+
+  auto add_chunk(const snapshot_chunk<T>& chunk) -> Result<void> {
+    noir_ensure(expected_root_hash, "no root hash to verify snapshot chunks against");
+    noir_ensure(!chunk.leaves.empty(), "empty snapshot chunk");
+    auto next = current;
+    auto batch = node_batch<T>();
+    for (const auto& [key, value] : chunk.leaves) {
+      noir_ok(add_leaf(next, key, value, batch));
+    }
+
+    const auto& rightmost = *next.pending;
+    auto depth = noir_ok(chunk.proof.rightmost_leaf_depth(rightmost.account_key, next.prefix_len_with_previous));
+    auto left_siblings = std::vector<Bytes32>();
+    for (auto d = depth; d-- > 0;) {
+      if (key_bit(rightmost.account_key, d)) {
+        left_siblings.push_back(left_sibling(next, rightmost.account_key, d));
+      }
+    }
+    noir_ok(chunk.proof.verify(*expected_root_hash,
+      sparse_merkle_leaf_node{rightmost.account_key, rightmost.value_hash}, left_siblings));
+
+    noir_ok(writer.write_node_batch(batch));
+    current = std::move(next);
+    return success();
+  }
+
+  /// \brief adds leaves without a proof, e.g. from a trusted local source; finish() still checks the root hash
+  auto add_leaves(std::span<const std::pair<Bytes32, T>> leaves) -> Result<void> {
+    auto next = current;
+    auto batch = node_batch<T>();
+    for (const auto& [key, value] : leaves) {
+      noir_ok(add_leaf(next, key, value, batch));
+    }
+    noir_ok(writer.write_node_batch(batch));
+    current = std::move(next);
+    return success();
+  }
+
+  /// \brief writes the last leaf and the open nodes up to the root
+  /// \return root hash of the restored tree
+  auto finish() -> Result<Bytes32> {
+    auto batch = node_batch<T>();
+    auto root_hash = sparse_merkle_placeholder_hash;
+    if (current.pending) {
+      auto key = current.pending->account_key;
+      place_pending(current, current.prefix_len_with_previous ? *current.prefix_len_with_previous / 4 + 1 : 0, batch);
+      if (current.open.empty()) {
+        root_hash = batch.at(node_key{version}).hash();
+      }
+      while (!current.open.empty()) {
+        root_hash = close_last(current, key, batch);
+      }
+    } else {
+      batch.insert_or_assign(node_key{version}, node<T>());
+    }
+    if (expected_root_hash) {
+      noir_ensure(root_hash == *expected_root_hash, "root hashes do not match. actual root hash: {}, expected: {}",
+        root_hash.to_string(), expected_root_hash->to_string());
+    }
+    noir_ok(writer.write_node_batch(batch));
+    return root_hash;
+  }
+
+  size_t num_leaves() const {
+    return current.num_leaves;
+  }
+
+private:
+  struct state {
+    /// open internal node at each depth on the path to the pending leaf, holding its finished children
+    std::vector<internal_node> open;
+    /// last added leaf, which is not placed yet
+    std::optional<leaf_node<T>> pending;
+    /// common prefix length in bits of the pending leaf with the leaf before it
+    std::optional<size_t> prefix_len_with_previous;
+    size_t num_leaves = 0;
+  };
+
+  auto add_leaf(state& s, const Bytes32& key, const T& value, node_batch<T>& batch) -> Result<void> {
+    if (s.pending) {
+      const auto& last_key = s.pending->account_key;
+      noir_ensure(last_key < key, "leaves are not sorted and unique: {} after {}", key.to_string(),
+        last_key.to_string());
+      auto prefix_len = common_prefix_bits_len(last_key, key);
+      auto min_depth = s.prefix_len_with_previous ? *s.prefix_len_with_previous / 4 + 1 : 0;
+      // the pending leaf goes right below the deepest node it shares with either neighbour
+      place_pending(s, std::max(min_depth, prefix_len / 4 + 1), batch);
+      while (s.open.size() > prefix_len / 4 + 1) {
+        close_last(s, last_key, batch);
+      }
+      s.prefix_len_with_previous = prefix_len;
+    }
+    s.pending = leaf_node<T>(key, value);
+    ++s.num_leaves;
+    return success();
+  }
+
+  /// \brief writes the pending leaf at depth in nibbles, opening the nodes above it that aren't open yet
+  void place_pending(state& s, size_t depth, node_batch<T>& batch) {
+    const auto& key = s.pending->account_key;
+    s.open.resize(std::max(s.open.size(), depth));
+    if (depth) {
+      s.open[depth - 1].children.insert_or_assign(
+        nibble_at(key, depth - 1), child{s.pending->hash(), version, leaf{}});
+    }
+    batch.insert_or_assign(node_key_at(key, depth), node<T>{*s.pending});
+    s.pending.reset();
+  }
+
+  /// \brief writes the deepest open node, on the path to key, and adds it to its parent
+  /// \return hash of the written node
+  Bytes32 close_last(state& s, const Bytes32& key, node_batch<T>& batch) {
+    auto depth = s.open.size() - 1;
+    auto node = internal_node(std::move(s.open.back().children));
+    s.open.pop_back();
+    auto hash = node.hash();
+    if (depth) {
+      s.open[depth - 1].children.insert_or_assign(nibble_at(key, depth - 1),
+        child{hash, version, internal{node.leaf_count}});
+    }
+    batch.insert_or_assign(node_key_at(key, depth), jmt::node<T>{std::move(node)});
+    return hash;
+  }
+
+  /// \brief hash of the subtree on the left of the path to key at depth in bits
+  /// Everything on the left of the path has been added, and the open nodes hold all of it that isn't written yet.
+  Bytes32 left_sibling(const state& s, const Bytes32& key, size_t depth) const {
+    auto nibble_depth = depth / 4;
+    if (nibble_depth >= s.open.size()) {
+      return sparse_merkle_placeholder_hash;
+    }
+    const auto& node = s.open[nibble_depth];
+    auto n = nibble_at(key, nibble_depth).value;
+    auto width = uint8_t(16 >> (depth % 4));
+    auto start = uint8_t(n & ~(width - 1));
+    return node.merkle_hash(start, width / 2, node.generate_bitmaps());
+  }
+
+  static jmt::nibble nibble_at(const Bytes32& key, size_t depth) {
+    return (key[depth / 2] >> (depth % 2 ? 0 : 4)) & 0x0f;
+  }
+
+  node_key node_key_at(const Bytes32& key, size_t depth) const {
+    auto k = node_key{version};
+    k.nibble_path.bytes.assign(key.begin(), key.begin() + (depth + 1) / 2);
+    if (depth % 2) {
+      k.nibble_path.bytes.back() &= 0xf0;
+    }
+    k.nibble_path.num_nibbles = depth;
+    return k;
+  }
+
+  tree_writer<T>& writer;
+  jmt::version version;
+  std::optional<Bytes32> expected_root_hash;
+  state current;
+};
+
+} // namespace noir::jmt
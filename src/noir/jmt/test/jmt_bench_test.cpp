@@ -0,0 +1,121 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#include <catch2/catch_all.hpp>
+#include <noir/jmt/jmt.h>
+#include <noir/jmt/mock_tree_store.h>
+#include <fmt/core.h>
+#include <algorithm>
+#include <random>
+#include <thread>
+
+using namespace noir;
+using namespace noir::jmt;
+
+using value_blob = std::vector<char>;
+
+namespace {
+
+auto random_kvs(std::mt19937& rng, size_t num_keys) -> std::vector<std::pair<Bytes32, value_blob>> {
+  auto kvs = std::vector<std::pair<Bytes32, value_blob>>(num_keys);
+  for (auto& [key, value] : kvs) {
+    for (auto& k : key) {
+      k = rng();
+    }
+    value.resize(32);
+    for (auto& v : value) {
+      v = rng();
+    }
+  }
+  return kvs;
+}
+
+} // namespace
+
+TEST_CASE("JmtBenchmarks", "[noir][jmt]") {
+  static constexpr size_t num_keys = 100000;
+
+  std::mt19937 rng(1);
+  auto initial = random_kvs(rng, num_keys);
+  // half of the keys are updated and half are new
+  auto update = random_kvs(rng, num_keys);
+  for (size_t i = 0; i < num_keys / 2; ++i) {
+    update[i].first = initial[i * 2].first;
+  }
+
+  auto db = mock_tree_store<value_blob>();
+  auto [_, batch] = *jellyfish_merkle_tree(db).batch_put_value_sets({initial}, {}, 0);
+  db.write_tree_update_batch(batch);
+
+  auto num_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  auto thread_pool = named_thread_pool("jmt", num_threads);
+  std::cout << fmt::format("{} keys, {} threads", num_keys, num_threads) << std::endl;
+
+  BENCHMARK("BatchPut_Empty_Serial") {
+    auto empty_db = mock_tree_store<value_blob>();
+    return jellyfish_merkle_tree(empty_db).batch_put_value_sets({initial}, {}, 0);
+  };
+
+  BENCHMARK("BatchPut_Empty_Parallel") {
+    auto empty_db = mock_tree_store<value_blob>();
+    return jellyfish_merkle_tree(empty_db, thread_pool).batch_put_value_sets({initial}, {}, 0);
+  };
+
+  BENCHMARK("BatchPut_Update_Serial") {
+    return jellyfish_merkle_tree(db).batch_put_value_sets({update}, {}, 1);
+  };
+
+  BENCHMARK("BatchPut_Update_Parallel") {
+    return jellyfish_merkle_tree(db, thread_pool).batch_put_value_sets({update}, {}, 1);
+  };
+
+  BENCHMARK("PutValueSet_1000") {
+    return jellyfish_merkle_tree(db).put_value_set({update.begin(), update.begin() + 1000}, 1);
+  };
+
+  BENCHMARK_ADVANCED("GetWithProof")(Catch::Benchmark::Chronometer meter) {
+    auto tree = jellyfish_merkle_tree(db);
+    meter.measure([&](int i) { return tree.get_with_proof(initial[i % num_keys].first, 0); });
+  };
+
+  BENCHMARK("GetWithProof_Missing") {
+    return jellyfish_merkle_tree(db).get_with_proof(update[num_keys - 1].first, 0);
+  };
+
+  // proofs for 1000 keys, half of which exist, one by one and in a single multi-key proof
+  auto proof_keys = std::vector<Bytes32>();
+  for (size_t i = 0; i < 1000; ++i) {
+    proof_keys.push_back((i % 2 ? initial : update)[num_keys - 1 - i].first);
+  }
+  std::sort(proof_keys.begin(), proof_keys.end());
+  // a leaf is a key and a value hash
+  auto single_proof_size = size_t(0);
+  for (const auto& key : proof_keys) {
+    auto proof = jellyfish_merkle_tree(db).get_with_proof(key, 0)->second;
+    single_proof_size += (proof.siblings.size() + (proof.leaf ? 2 : 0)) * sizeof(Bytes32);
+  }
+  auto multi_proof = jellyfish_merkle_tree(db).get_with_multi_proof(proof_keys, 0)->second;
+  auto num_leaves = std::count_if(multi_proof.leaves.begin(), multi_proof.leaves.end(), [](auto& l) { return !!l; });
+  auto multi_proof_size = (multi_proof.siblings.size() + num_leaves * 2) * sizeof(Bytes32) +
+    multi_proof.depths.size() * sizeof(uint16_t);
+  std::cout << fmt::format("{} keys proven: {} bytes in single proofs, {} bytes in a multi proof", proof_keys.size(),
+                 single_proof_size, multi_proof_size)
+            << std::endl;
+
+  BENCHMARK("GetWithProof_1000") {
+    auto tree = jellyfish_merkle_tree(db);
+    for (const auto& key : proof_keys) {
+      tree.get_with_proof(key, 0);
+    }
+  };
+
+  BENCHMARK("GetWithMultiProof_1000") {
+    return jellyfish_merkle_tree(db).get_with_multi_proof(proof_keys, 0);
+  };
+
+  BENCHMARK("GetRangeProof") {
+    return jellyfish_merkle_tree(db).get_range_proof(initial[num_keys / 2].first, 0);
+  };
+}
@@ -342,6 +342,47 @@ TEST_CASE("jmt: put_value_sets", "[noir][jmt]") {
   }
 }
 
+TEST_CASE("jmt: parallel batch_put_value_sets", "[noir][jmt]") {
+  std::mt19937 rng(1234);
+  auto random_kvs = [&](size_t num_keys) {
+    auto kvs = std::vector<std::pair<Bytes32, value_blob>>{};
+    for (auto i = 0; i < num_keys; ++i) {
+      auto key = Bytes32();
+      auto value = value_blob(8);
+      for (auto& k : key) {
+        k = rng();
+      }
+      for (auto& v : value) {
+        v = rng();
+      }
+      kvs.push_back({key, value});
+    }
+    return kvs;
+  };
+
+  // new keys into an empty tree, then a mix of new and updated keys, then a set too small to be split
+  auto value_sets = std::vector{random_kvs(5000), random_kvs(2000), random_kvs(3)};
+  for (auto i = 0; i < 1000; ++i) {
+    value_sets[1][i].first = value_sets[0][i * 5].first;
+  }
+  value_sets[2].push_back({value_sets[2][0].first, value_blob{1}});
+
+  auto db = mock_tree_store<value_blob>();
+  auto tree = jellyfish_merkle_tree(db);
+  auto [root_hashes, batch] = *tree.batch_put_value_sets(value_sets, {}, 0);
+
+  auto thread_pool = named_thread_pool("jmt", 4);
+  auto parallel_db = mock_tree_store<value_blob>();
+  auto parallel_tree = jellyfish_merkle_tree(parallel_db, thread_pool);
+  auto [parallel_root_hashes, parallel_batch] = *parallel_tree.batch_put_value_sets(value_sets, {}, 0);
+  CHECK(parallel_root_hashes == root_hashes);
+  CHECK(parallel_batch == batch);
+
+  parallel_db.write_tree_update_batch(parallel_batch);
+  CHECK(**parallel_tree.get(value_sets[1][0].first, 1) == value_sets[1][0].second);
+  CHECK(**parallel_tree.get(value_sets[2][0].first, 2) == value_blob{1});
+}
+
 void many_keys_get_proof_and_verify_tree_root(std::span<uint8_t> seed, size_t num_keys) {
   CHECK(seed.size() < 32);
   auto actual_seed = Bytes32(seed, false);
@@ -436,6 +477,88 @@ TEST_CASE("jmt: 1000_versions", "[noir][jmt]") {
   many_keys_get_proof_and_verify_tree_root(seed, 1000);
 }
 
+auto random_kvs_sorted(size_t num_keys) {
+  auto kvs = std::vector<std::pair<Bytes32, value_blob>>{};
+  for (auto i = 0; i < num_keys; ++i) {
+    auto value = random_bytes32();
+    kvs.push_back({random_bytes32(), value_blob{value.begin(), value.end()}});
+  }
+  std::sort(kvs.begin(), kvs.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+  return kvs;
+}
+
+TEST_CASE("jmt: range_proof", "[noir][jmt]") {
+  auto db = mock_tree_store<value_blob>();
+  auto tree = jellyfish_merkle_tree(db);
+  auto kvs = random_kvs_sorted(300);
+  auto [roots, batch] = *tree.batch_put_value_sets({kvs}, {}, 0);
+  db.write_tree_update_batch(batch);
+
+  auto leaves = std::vector<sparse_merkle_leaf_node>{};
+  for (const auto& [k, v] : kvs) {
+    leaves.push_back({k, leaf_node<value_blob>(k, v).value_hash});
+  }
+
+  for (auto i : {size_t(0), size_t(1), size_t(37), size_t(150), kvs.size() - 1}) {
+    auto proof = *tree.get_range_proof(kvs[i].first, 0);
+    auto known = std::span(leaves).first(i + 1);
+    CHECK(proof.verify(roots[0], known));
+    if (i > 0) {
+      // a missing leaf on the left
+      auto missing = std::vector<sparse_merkle_leaf_node>(known.begin() + 1, known.end());
+      CHECK(!proof.verify(roots[0], missing));
+    }
+    if (i + 1 < kvs.size()) {
+      // a leaf on the right that the proof already covers
+      auto extra = std::vector<sparse_merkle_leaf_node>(known.begin(), known.end());
+      extra.push_back(leaves[i + 1]);
+      CHECK(!proof.verify(roots[0], extra));
+    }
+  }
+
+  CHECK(!tree.get_range_proof(random_bytes32(), 0));
+}
+
+TEST_CASE("jmt: multi_proof", "[noir][jmt]") {
+  auto db = mock_tree_store<value_blob>();
+  auto tree = jellyfish_merkle_tree(db);
+  auto kvs = random_kvs_sorted(500);
+  auto [roots, batch] = *tree.batch_put_value_sets({kvs}, {}, 0);
+  db.write_tree_update_batch(batch);
+
+  // every third key, plus keys that do not exist, some of them next to existing keys
+  auto keys = std::vector<Bytes32>{};
+  for (auto i = 0; i < kvs.size(); i += 3) {
+    keys.push_back(kvs[i].first);
+  }
+  for (auto i = 0; i < 50; ++i) {
+    keys.push_back(random_bytes32());
+  }
+  keys.push_back(update_nibble(kvs[1].first, 63, (kvs[1].first[31] & 0xf) ^ 1));
+  keys.push_back(update_nibble(kvs[2].first, 2, ((kvs[2].first[1] >> 4) & 0xf) ^ 8));
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+  auto [values, proof] = *tree.get_with_multi_proof(keys, 0);
+  auto num_single_siblings = size_t(0);
+  for (const auto& [k, v] : ranges::views::zip(keys, values)) {
+    auto [value, single_proof] = *tree.get_with_proof(k, 0);
+    CHECK(value == v);
+    num_single_siblings += single_proof.siblings.size();
+  }
+  CHECK(proof.verify(roots[0], keys, values));
+  CHECK(proof.siblings.size() < num_single_siblings);
+
+  auto wrong_values = values;
+  *std::find_if(wrong_values.begin(), wrong_values.end(), [](const auto& v) { return v.has_value(); }) = std::nullopt;
+  CHECK(!proof.verify(roots[0], keys, wrong_values));
+  CHECK(!proof.verify(random_bytes32(), keys, values));
+
+  auto unsorted = keys;
+  std::swap(unsorted[0], unsorted[1]);
+  CHECK(!tree.get_with_multi_proof(unsorted, 0));
+}
+
 TEST_CASE("jmt: insert_at_leaf_with_multiple_internals_created - non batch version", "[noir][jmt]") {
   auto db = mock_tree_store<value_blob>();
   auto tree = jellyfish_merkle_tree(db);
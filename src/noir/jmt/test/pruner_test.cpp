@@ -0,0 +1,121 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#include <catch2/catch_all.hpp>
+#include <noir/jmt/jmt.h>
+#include <noir/jmt/mock_tree_store.h>
+#include <noir/jmt/pruner.h>
+#include <noir/jmt/test/rocksdb_session.h>
+#include <random>
+#include <thread>
+
+using namespace noir;
+using namespace noir::jmt;
+
+using value_blob = std::vector<char>;
+
+namespace {
+
+auto random_kvs(std::mt19937& rng, size_t num_keys) -> std::vector<std::pair<Bytes32, value_blob>> {
+  auto kvs = std::vector<std::pair<Bytes32, value_blob>>(num_keys);
+  for (auto& [key, value] : kvs) {
+    for (auto& k : key) {
+      k = rng();
+    }
+    value.resize(8);
+    for (auto& v : value) {
+      v = rng();
+    }
+  }
+  return kvs;
+}
+
+template<typename F>
+void wait_for(F&& done) {
+  for (auto i = 0; i < 500 && !done(); i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+
+} // namespace
+
+TEST_CASE("pruner: Prune stale nodes", "[noir][jmt]") {
+  static constexpr version num_versions = 20;
+
+  auto session = make_rocksdb_session("/tmp/noir_jmt_pruner_test");
+  auto db = rocksdb_tree_store<value_blob>(session, 1024);
+  auto mock_db = mock_tree_store<value_blob>();
+
+  // every version updates keys of the first one, so most of its nodes become stale
+  std::mt19937 rng(1);
+  auto keys = random_kvs(rng, 500);
+  for (version v = 0; v < num_versions; ++v) {
+    auto kvs = v ? random_kvs(rng, 100) : keys;
+    for (size_t i = 0; v && i < kvs.size() / 2; ++i) {
+      kvs[i].first = keys[rng() % keys.size()].first;
+    }
+    auto [_, batch] = *jellyfish_merkle_tree(db).put_value_set(kvs, v);
+    REQUIRE(db.write_tree_update_batch(batch));
+    mock_db.write_tree_update_batch(batch);
+  }
+  auto all_nodes = std::vector<node_key>();
+  for (const auto& [node_key, _] : mock_db.data._0) {
+    all_nodes.push_back(node_key);
+  }
+
+  auto check_pruned = [&](version least_readable_version) {
+    REQUIRE(mock_db.purge_stale_nodes(least_readable_version));
+    for (const auto& node_key : all_nodes) {
+      auto n = db.get_node_option(node_key);
+      REQUIRE(n);
+      CHECK(n.value().has_value() == mock_db.data._0.contains(node_key));
+    }
+    CHECK(!*jellyfish_merkle_tree(db).get_root_node_option(least_readable_version - 1));
+    for (auto v = least_readable_version; v < num_versions; ++v) {
+      auto root = jellyfish_merkle_tree(db).get_root_hash(v);
+      REQUIRE(root);
+      CHECK(root.value() == jellyfish_merkle_tree(mock_db).get_root_hash(v).value());
+    }
+    auto rightmost = db.get_rightmost_leaf();
+    REQUIRE(rightmost);
+    CHECK(rightmost.value()->first == mock_db.get_rightmost_leaf().value()->first);
+    CHECK(*db.get_pruned_version() == least_readable_version);
+  };
+
+  SECTION("Pruner") {
+    auto p = pruner<value_blob>(db, {.retained_versions = 5, .batch_size = 50, .batch_interval = {}});
+    REQUIRE(p.start());
+    CHECK(p.get_metrics().backlog() == 0);
+    p.set_latest_version(num_versions - 1);
+    wait_for([&]() { return p.get_metrics().backlog() == 0; });
+    auto metrics = p.get_metrics();
+    CHECK(metrics.pruned_version == num_versions - 5);
+    CHECK(metrics.pruned_nodes > 0);
+    CHECK(metrics.batches > metrics.pruned_nodes / 50);
+    CHECK(metrics.errors == 0);
+    p.stop();
+    check_pruned(num_versions - 5);
+  }
+
+  SECTION("Resume after restart") {
+    // stops part way through, as if the node went down
+    auto pruned = db.prune(10, 50);
+    REQUIRE(pruned);
+    CHECK(pruned.value() == 50);
+    CHECK(!*db.get_pruned_version());
+
+    auto p = pruner<value_blob>(db, {.retained_versions = 10, .batch_size = 1000, .batch_interval = {}});
+    REQUIRE(p.start());
+    p.set_latest_version(num_versions - 1);
+    wait_for([&]() { return p.get_metrics().backlog() == 0; });
+    CHECK(p.get_metrics().pruned_version == num_versions - 10);
+    p.stop();
+    check_pruned(num_versions - 10);
+
+    auto restarted = pruner<value_blob>(db, {.retained_versions = 10});
+    REQUIRE(restarted.start());
+    CHECK(restarted.get_metrics().pruned_version == num_versions - 10);
+  }
+}
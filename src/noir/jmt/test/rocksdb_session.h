@@ -0,0 +1,31 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#pragma once
+#include <noir/common/check.h>
+#include <noir/db/rocks_session.h>
+#include <fmt/core.h>
+
+namespace noir::jmt {
+
+/// opens the RocksDB at path for a tree store, emptying it first if destroy is set
+inline auto make_rocksdb_session(const std::string& path, bool destroy = true)
+  -> std::shared_ptr<db::session::session<db::session::rocksdb_t>> {
+  if (destroy) {
+    rocksdb::DestroyDB(path, rocksdb::Options{});
+  }
+  auto options = rocksdb::Options{};
+  options.create_if_missing = true;
+  options.level_compaction_dynamic_level_bytes = true;
+  options.IncreaseParallelism();
+  options.OptimizeLevelStyleCompaction(256ull << 20);
+
+  rocksdb::DB* db = nullptr;
+  auto status = rocksdb::DB::Open(options, path, &db);
+  check(status.ok(), fmt::format("failed to open {}: {}", path, status.ToString()));
+  return std::make_shared<db::session::session<db::session::rocksdb_t>>(std::shared_ptr<rocksdb::DB>(db), 16);
+}
+
+} // namespace noir::jmt
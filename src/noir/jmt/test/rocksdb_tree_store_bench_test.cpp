@@ -0,0 +1,110 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#include <catch2/catch_all.hpp>
+#include <noir/jmt/jmt.h>
+#include <noir/jmt/rocksdb_tree_store.h>
+#include <noir/jmt/test/rocksdb_session.h>
+#include <fmt/core.h>
+#include <chrono>
+#include <filesystem>
+#include <random>
+#include <thread>
+
+using namespace noir;
+using namespace noir::jmt;
+
+using value_blob = std::vector<char>;
+
+namespace {
+
+auto random_kvs(std::mt19937& rng, size_t num_keys) -> std::vector<std::pair<Bytes32, value_blob>> {
+  auto kvs = std::vector<std::pair<Bytes32, value_blob>>(num_keys);
+  for (auto& [key, value] : kvs) {
+    for (auto& k : key) {
+      k = rng();
+    }
+    value.resize(32);
+    for (auto& v : value) {
+      v = rng();
+    }
+  }
+  return kvs;
+}
+
+} // namespace
+
+TEST_CASE("RocksdbTreeStoreBenchmarks", "[noir][jmt]") {
+  static constexpr size_t num_leaves = 10'000'000;
+  static constexpr size_t keys_per_version = 100'000;
+  static constexpr version last_version = num_leaves / keys_per_version - 1;
+  static constexpr size_t num_samples = 10'000;
+
+  // the tree takes a while to build, so it is kept and reused by later runs
+  auto path = (std::filesystem::temp_directory_path() / "noir_jmt_rocksdb_tree_store_bench").string();
+  auto built = [&]() {
+    auto db = rocksdb_tree_store<value_blob>(make_rocksdb_session(path, false), 0);
+    auto root = jellyfish_merkle_tree(db).get_root_node_option(last_version);
+    return root && root.value();
+  }();
+  auto session = make_rocksdb_session(path, !built);
+  auto db = rocksdb_tree_store<value_blob>(session);
+
+  std::mt19937 rng(1);
+  auto samples = std::vector<Bytes32>();
+  auto thread_pool = named_thread_pool("jmt", std::max<size_t>(std::thread::hardware_concurrency(), 1));
+  auto start = std::chrono::steady_clock::now();
+  for (version v = 0; v <= last_version; ++v) {
+    auto kvs = random_kvs(rng, keys_per_version);
+    for (size_t i = 0; i < num_samples / (last_version + 1); ++i) {
+      samples.push_back(kvs[i].first);
+    }
+    if (!built) {
+      auto [_, batch] = *jellyfish_merkle_tree(db, thread_pool).batch_put_value_sets({kvs}, {}, v);
+      REQUIRE(db.write_tree_update_batch(batch));
+    }
+  }
+  if (!built) {
+    session->flush();
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << fmt::format("built {} leaves in {} versions: {:.1f}s", num_leaves, last_version + 1, elapsed)
+              << std::endl;
+  }
+  REQUIRE(*jellyfish_merkle_tree(db).get_leaf_count(last_version) == num_leaves);
+
+  std::shuffle(samples.begin(), samples.end(), rng);
+  auto updates = random_kvs(rng, 1000);
+  // half of the keys are updated and half are new
+  for (size_t i = 0; i < updates.size() / 2; ++i) {
+    updates[i].first = samples[i];
+  }
+
+  BENCHMARK_ADVANCED("Get")(Catch::Benchmark::Chronometer meter) {
+    auto tree = jellyfish_merkle_tree(db);
+    meter.measure([&](int i) { return tree.get(samples[i % samples.size()], last_version); });
+  };
+
+  BENCHMARK_ADVANCED("GetWithProof")(Catch::Benchmark::Chronometer meter) {
+    auto tree = jellyfish_merkle_tree(db);
+    meter.measure([&](int i) { return tree.get_with_proof(samples[i % samples.size()], last_version); });
+  };
+
+  BENCHMARK("PutValueSet_1000") {
+    return jellyfish_merkle_tree(db).put_value_set(updates, last_version + 1);
+  };
+
+  // a cold cache makes every lookup read all of its nodes from RocksDB
+  BENCHMARK_ADVANCED("GetWithProof_Uncached")(Catch::Benchmark::Chronometer meter) {
+    auto uncached = rocksdb_tree_store<value_blob>(session, 0);
+    auto tree = jellyfish_merkle_tree(uncached);
+    meter.measure([&](int i) { return tree.get_with_proof(samples[i % samples.size()], last_version); });
+  };
+
+  BENCHMARK("GetRightmostLeaf") {
+    return db.get_rightmost_leaf();
+  };
+
+  std::cout << fmt::format("cached internal nodes: {}", db.cached_nodes()) << std::endl;
+}
@@ -0,0 +1,112 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#include <catch2/catch_all.hpp>
+#include <noir/jmt/jmt.h>
+#include <noir/jmt/mock_tree_store.h>
+#include <noir/jmt/rocksdb_tree_store.h>
+#include <noir/jmt/test/rocksdb_session.h>
+#include <random>
+
+using namespace noir;
+using namespace noir::jmt;
+
+using value_blob = std::vector<char>;
+
+namespace {
+
+auto random_kvs(std::mt19937& rng, size_t num_keys) -> std::vector<std::pair<Bytes32, value_blob>> {
+  auto kvs = std::vector<std::pair<Bytes32, value_blob>>(num_keys);
+  for (auto& [key, value] : kvs) {
+    for (auto& k : key) {
+      k = rng();
+    }
+    value.resize(8);
+    for (auto& v : value) {
+      v = rng();
+    }
+  }
+  return kvs;
+}
+
+} // namespace
+
+TEST_CASE("rocksdb_tree_store: Same tree as mock_tree_store", "[noir][jmt]") {
+  static constexpr version num_versions = 10;
+
+  auto session = make_rocksdb_session("/tmp/noir_jmt_rocksdb_tree_store_test");
+  auto db = rocksdb_tree_store<value_blob>(session, 1024);
+  auto mock_db = mock_tree_store<value_blob>();
+
+  auto empty = db.get_rightmost_leaf();
+  REQUIRE(empty);
+  CHECK(!empty.value());
+
+  std::mt19937 rng(1);
+  auto keys = std::vector<std::pair<Bytes32, value_blob>>();
+  for (version v = 0; v < num_versions; ++v) {
+    auto kvs = random_kvs(rng, 1000);
+    // updates some keys of earlier versions
+    for (size_t i = 0; i < keys.size() && i < 100; ++i) {
+      kvs[i].first = keys[rng() % keys.size()].first;
+    }
+    auto [root, batch] = *jellyfish_merkle_tree(db).put_value_set(kvs, v);
+    auto [mock_root, mock_batch] = *jellyfish_merkle_tree(mock_db).put_value_set(kvs, v);
+    CHECK(root == mock_root);
+    CHECK(batch == mock_batch);
+    REQUIRE(db.write_tree_update_batch(batch));
+    mock_db.write_tree_update_batch(mock_batch);
+    keys.insert(keys.end(), kvs.begin(), kvs.end());
+  }
+
+  auto check_tree = [&](rocksdb_tree_store<value_blob>& db) {
+    auto tree = jellyfish_merkle_tree(db);
+    auto mock_tree = jellyfish_merkle_tree(mock_db);
+    auto version = num_versions - 1;
+    auto root = tree.get_root_hash(version);
+    REQUIRE(root);
+    CHECK(root.value() == mock_tree.get_root_hash(version).value());
+    CHECK(tree.get_leaf_count(version).value() == mock_tree.get_leaf_count(version).value());
+
+    for (size_t i = 0; i < keys.size(); i += 97) {
+      auto [value, proof] = *tree.get_with_proof(keys[i].first, version);
+      REQUIRE(value);
+      CHECK(proof.verify(root.value(), keys[i].first, value));
+    }
+    auto missing = random_kvs(rng, 1)[0].first;
+    auto [value, proof] = *tree.get_with_proof(missing, version);
+    auto [_, mock_proof] = *mock_tree.get_with_proof(missing, version);
+    CHECK(!value);
+    REQUIRE(bool(proof.leaf) == bool(mock_proof.leaf));
+    if (proof.leaf) {
+      CHECK(proof.leaf->key == mock_proof.leaf->key);
+    }
+    CHECK(proof.siblings == mock_proof.siblings);
+
+    auto rightmost = db.get_rightmost_leaf();
+    REQUIRE(rightmost);
+    REQUIRE(rightmost.value());
+    auto mock_rightmost = mock_db.get_rightmost_leaf().value();
+    CHECK(rightmost.value()->second.account_key == mock_rightmost->second.account_key);
+  };
+
+  SECTION("Cached nodes") {
+    CHECK(db.cached_nodes() > 0);
+    check_tree(db);
+  }
+
+  SECTION("Reopened store") {
+    auto reopened = rocksdb_tree_store<value_blob>(session, 1024);
+    CHECK(reopened.cached_nodes() == 0);
+    check_tree(reopened);
+    CHECK(reopened.cached_nodes() > 0);
+  }
+
+  SECTION("No cache") {
+    auto uncached = rocksdb_tree_store<value_blob>(session, 0);
+    check_tree(uncached);
+    CHECK(uncached.cached_nodes() == 0);
+  }
+}
@@ -0,0 +1,107 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#include <catch2/catch_all.hpp>
+#include <noir/jmt/rocksdb_tree_store.h>
+#include <noir/jmt/snapshot.h>
+#include <noir/jmt/test/rocksdb_session.h>
+#include <boost/endian/conversion.hpp>
+#include <fmt/core.h>
+#include <chrono>
+#include <filesystem>
+#include <random>
+
+using namespace noir;
+using namespace noir::jmt;
+
+using value_blob = std::vector<char>;
+
+namespace {
+
+/// random keys in ascending order, spread evenly over the key space
+auto sorted_random_kvs(std::mt19937_64& rng, size_t first, size_t num_keys, size_t total_keys)
+  -> std::vector<std::pair<Bytes32, value_blob>> {
+  auto step = std::numeric_limits<uint64_t>::max() / total_keys;
+  auto kvs = std::vector<std::pair<Bytes32, value_blob>>(num_keys);
+  for (size_t i = 0; i < num_keys; ++i) {
+    auto& [key, value] = kvs[i];
+    boost::endian::store_big_u64(key.data(), (first + i) * step + rng() % step);
+    for (size_t j = sizeof(uint64_t); j < key.size(); ++j) {
+      key[j] = rng();
+    }
+    value.resize(32);
+    for (auto& v : value) {
+      v = rng();
+    }
+  }
+  return kvs;
+}
+
+auto seconds_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+TEST_CASE("SnapshotBenchmarks", "[noir][jmt]") {
+  static constexpr size_t num_leaves = 10'000'000;
+  static constexpr size_t chunk_size = snapshot_exporter<rocksdb_tree_store<value_blob>>::default_chunk_size;
+  static constexpr version snapshot_version = 0;
+
+  auto path = std::filesystem::temp_directory_path();
+  auto source_session = make_rocksdb_session((path / "noir_jmt_snapshot_bench_source").string());
+  auto target_session = make_rocksdb_session((path / "noir_jmt_snapshot_bench_target").string());
+  auto source = rocksdb_tree_store<value_blob>(source_session);
+  auto target = rocksdb_tree_store<value_blob>(target_session);
+
+  // the source tree is built bottom-up from sorted leaves, as a restore without proofs
+  std::mt19937_64 rng(1);
+  auto start = std::chrono::steady_clock::now();
+  auto builder = snapshot_restorer<value_blob>(source, snapshot_version);
+  for (size_t i = 0; i < num_leaves; i += chunk_size) {
+    auto kvs = sorted_random_kvs(rng, i, std::min(chunk_size, num_leaves - i), num_leaves);
+    REQUIRE(builder.add_leaves(kvs));
+  }
+  auto root_hash = *builder.finish();
+  source_session->flush();
+  auto elapsed = seconds_since(start);
+  std::cout << fmt::format("built {} leaves from sorted leaves: {:.1f}s, {:.0f} leaves/s", num_leaves, elapsed,
+                 num_leaves / elapsed)
+            << std::endl;
+
+  // chunks are encoded and decoded as they would be sent to and received from peers
+  auto chunks = std::vector<std::vector<uint8_t>>();
+  auto num_bytes = size_t(0);
+  start = std::chrono::steady_clock::now();
+  auto exporter = snapshot_exporter(source, snapshot_version, chunk_size);
+  while (auto chunk = *exporter.next_chunk()) {
+    chunks.push_back(chunk->encode());
+    num_bytes += chunks.back().size();
+  }
+  elapsed = seconds_since(start);
+  std::cout << fmt::format("exported {} leaves in {} chunks of {:.1f}MB: {:.1f}s, {:.0f} leaves/s", num_leaves,
+                 chunks.size(), num_bytes / 1e6, elapsed, num_leaves / elapsed)
+            << std::endl;
+  REQUIRE(chunks.size() == *exporter.num_chunks());
+
+  start = std::chrono::steady_clock::now();
+  auto restorer = snapshot_restorer<value_blob>(target, snapshot_version, root_hash);
+  for (const auto& bytes : chunks) {
+    REQUIRE(restorer.add_chunk(*snapshot_chunk<value_blob>::decode(bytes)));
+  }
+  REQUIRE(*restorer.finish() == root_hash);
+  target_session->flush();
+  elapsed = seconds_since(start);
+  std::cout << fmt::format("imported {} leaves with proofs: {:.1f}s, {:.0f} leaves/s", num_leaves, elapsed,
+                 num_leaves / elapsed)
+            << std::endl;
+  REQUIRE(*jellyfish_merkle_tree(target).get_leaf_count(snapshot_version) == num_leaves);
+
+  BENCHMARK("ExportChunk") {
+    auto exporter = snapshot_exporter(source, snapshot_version, chunk_size);
+    exporter.seek(chunks.size() / 2);
+    return exporter.next_chunk();
+  };
+}
@@ -0,0 +1,171 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#include <catch2/catch_all.hpp>
+#include <noir/jmt/mock_tree_store.h>
+#include <noir/jmt/snapshot.h>
+#include <openssl/rand.h>
+
+using namespace noir;
+using namespace noir::jmt;
+
+using value_blob = std::vector<char>;
+
+namespace {
+
+auto random_bytes32() {
+  Bytes32 out;
+  RAND_bytes(out.data(), out.size());
+  return out;
+}
+
+auto random_kvs(size_t num_keys) {
+  auto kvs = std::vector<std::pair<Bytes32, value_blob>>{};
+  for (auto i = 0; i < num_keys; ++i) {
+    auto value = random_bytes32();
+    kvs.push_back({random_bytes32(), value_blob{value.begin(), value.end()}});
+  }
+  return kvs;
+}
+
+auto export_chunks(mock_tree_store<value_blob>& db, version v, size_t chunk_size) {
+  auto exporter = snapshot_exporter(db, v, chunk_size);
+  auto chunks = std::vector<snapshot_chunk<value_blob>>{};
+  while (auto chunk = *exporter.next_chunk()) {
+    chunks.push_back(std::move(*chunk));
+  }
+  CHECK(chunks.size() == *exporter.num_chunks());
+  return chunks;
+}
+
+} // namespace
+
+TEST_CASE("snapshot: export_and_restore", "[noir][jmt]") {
+  for (auto num_keys : {1, 2, 15, 16, 17, 1000}) {
+    auto db = mock_tree_store<value_blob>();
+    auto kvs = random_kvs(num_keys);
+    auto [roots, batch] = *jellyfish_merkle_tree(db).batch_put_value_sets({kvs}, {}, 0);
+    db.write_tree_update_batch(batch);
+
+    auto chunks = export_chunks(db, 0, 64);
+    auto num_leaves = size_t(0);
+    for (const auto& chunk : chunks) {
+      num_leaves += chunk.leaves.size();
+      CHECK(chunk.proof.verify(roots[0], [&]() {
+        auto leaves = std::vector<sparse_merkle_leaf_node>{};
+        for (const auto& c : chunks) {
+          for (const auto& [k, v] : c.leaves) {
+            leaves.push_back({k, leaf_node<value_blob>(k, v).value_hash});
+          }
+          if (&c == &chunk) {
+            break;
+          }
+        }
+        return leaves;
+      }()));
+    }
+    CHECK(num_leaves == num_keys);
+
+    auto restored = mock_tree_store<value_blob>();
+    auto restorer = snapshot_restorer<value_blob>(restored, 0, roots[0]);
+    for (const auto& chunk : chunks) {
+      auto decoded = snapshot_chunk<value_blob>::decode(chunk.encode());
+      REQUIRE(decoded);
+      CHECK(restorer.add_chunk(*decoded));
+    }
+    CHECK(restorer.num_leaves() == num_keys);
+    CHECK(*restorer.finish() == roots[0]);
+
+    // a tree built at a single version has the same nodes as the one restored at that version
+    CHECK(restored.num_nodes() == db.num_nodes());
+    for (const auto& [key, node] : db.data._0) {
+      CHECK(*restored.get_node(key) == node);
+    }
+  }
+}
+
+TEST_CASE("snapshot: restore_from_many_versions", "[noir][jmt]") {
+  auto db = mock_tree_store<value_blob>();
+  auto tree = jellyfish_merkle_tree(db);
+  auto kvs = random_kvs(500);
+  auto root = Bytes32();
+  for (version v = 0; v < 5; ++v) {
+    auto value_set = std::vector(kvs.begin() + v * 100, kvs.begin() + (v + 1) * 100);
+    // some of the keys from earlier versions are updated
+    for (auto i = 0; i < v * 10; ++i) {
+      value_set.push_back({kvs[i].first, value_blob{char(v)}});
+    }
+    auto [roots, batch] = *tree.batch_put_value_sets({value_set}, {}, v);
+    db.write_tree_update_batch(batch);
+    root = roots[0];
+  }
+
+  auto restored = mock_tree_store<value_blob>();
+  auto restorer = snapshot_restorer<value_blob>(restored, 4, root);
+  for (const auto& chunk : export_chunks(db, 4, 37)) {
+    CHECK(restorer.add_chunk(chunk));
+  }
+  CHECK(*restorer.finish() == root);
+
+  auto restored_tree = jellyfish_merkle_tree(restored);
+  for (const auto& [k, v] : kvs) {
+    CHECK(*restored_tree.get(k, 4) == *tree.get(k, 4));
+  }
+}
+
+TEST_CASE("snapshot: seek", "[noir][jmt]") {
+  auto db = mock_tree_store<value_blob>();
+  auto [roots, batch] = *jellyfish_merkle_tree(db).batch_put_value_sets({random_kvs(300)}, {}, 0);
+  db.write_tree_update_batch(batch);
+  auto chunks = export_chunks(db, 0, 20);
+  REQUIRE(chunks.size() == 15);
+
+  auto exporter = snapshot_exporter(db, 0, 20);
+  for (auto i : {7, 0, 14, 3}) {
+    REQUIRE(exporter.seek(i));
+    auto chunk = **exporter.next_chunk();
+    CHECK(chunk.leaves == chunks[i].leaves);
+    CHECK(chunk.proof.right_siblings == chunks[i].proof.right_siblings);
+  }
+  REQUIRE(exporter.seek(15));
+  CHECK(!*exporter.next_chunk());
+}
+
+TEST_CASE("snapshot: reject_bad_chunks", "[noir][jmt]") {
+  auto db = mock_tree_store<value_blob>();
+  auto [roots, batch] = *jellyfish_merkle_tree(db).batch_put_value_sets({random_kvs(200)}, {}, 0);
+  db.write_tree_update_batch(batch);
+  auto chunks = export_chunks(db, 0, 50);
+
+  auto restored = mock_tree_store<value_blob>();
+  auto restorer = snapshot_restorer<value_blob>(restored, 0, roots[0]);
+  CHECK(restorer.add_chunk(chunks[0]));
+
+  auto tampered = chunks[1];
+  tampered.leaves[10].second.push_back(1);
+  CHECK(!restorer.add_chunk(tampered));
+  auto missing_leaf = chunks[1];
+  missing_leaf.leaves.erase(missing_leaf.leaves.begin() + 10);
+  CHECK(!restorer.add_chunk(missing_leaf));
+  CHECK(!restorer.add_chunk(chunks[2]));
+  CHECK(!restorer.add_chunk(chunks[0]));
+
+  // rejected chunks leave nothing behind
+  for (auto i = 1; i < chunks.size(); ++i) {
+    CHECK(restorer.add_chunk(chunks[i]));
+  }
+  CHECK(*restorer.finish() == roots[0]);
+}
+
+TEST_CASE("snapshot: empty_tree", "[noir][jmt]") {
+  auto db = mock_tree_store<value_blob>();
+  db.put_node(node_key{0}, node<value_blob>());
+  CHECK(export_chunks(db, 0, 10).empty());
+
+  auto restored = mock_tree_store<value_blob>();
+  auto restorer = snapshot_restorer<value_blob>(restored, 0, sparse_merkle_placeholder_hash);
+  CHECK(*restorer.finish() == sparse_merkle_placeholder_hash);
+  CHECK(*restored.get_node(node_key{0}) == node<value_blob>());
+}
@@ -5,18 +5,17 @@
 //
 #include <noir/common/bytes.h>
 #include <noir/jmt/types/common.h>
+#include <bit>
 
 namespace noir::jmt {
 
 size_t common_prefix_bits_len(const Bytes32& a, const Bytes32& b) {
-  auto a_bits = a.to_bitset();
-  auto b_bits = b.to_bitset();
-  auto a_pos = 0;
-  for (auto b_pos = 0; a_pos < 256 && b_pos < 256; ++a_pos, ++b_pos) {
-    if (a_bits[a_pos] == b_bits[b_pos])
-      break;
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (auto diff = uint8_t(a[i] ^ b[i])) {
+      return i * 8 + std::countl_zero(diff);
+    }
   }
-  return a_pos;
+  return a.size() * 8;
 }
 
 } // namespace noir::jmt
@@ -11,8 +11,14 @@ namespace noir::jmt {
 
 using version = uint64_t;
 
+/// \brief number of leading bits a and b have in common, counting from the most significant bit of the first byte
 size_t common_prefix_bits_len(const Bytes32& a, const Bytes32& b);
 
+/// \brief bit of key at depth, where depth 0 is the bit that picks the child of the root
+inline bool key_bit(const Bytes32& key, size_t depth) {
+  return (key[depth / 8] >> (7 - depth % 8)) & 1;
+}
+
 extern Bytes32 sparse_merkle_placeholder_hash;
 
 } // namespace noir::jmt
@@ -12,10 +12,11 @@
 #include <noir/jmt/types/nibble.h>
 #include <noir/jmt/types/proof.h>
 #include <fmt/core.h>
+#include <array>
 #include <bit>
 #include <map>
+#include <optional>
 #include <set>
-#include <unordered_map>
 
 namespace noir::jmt {
 
@@ -124,27 +125,139 @@ struct child {
   }
 };
 
-// for deterministic serialization
-using children = std::unordered_map<nibble, child>;
+/// \brief children of an internal node, packed in nibble order after existence and leaf bitmaps
+/// The child at nibble n is in slot popcount(existence bitmap below n), so lookups and iteration in nibble order need no
+/// hashing, and a node holds one allocation of exactly as many slots as it has children. The slots aren't a fixed array
+/// of 16, which would make every node<T>, leaves included, as large as a full internal node.
+class children {
+public:
+  using value_type = std::pair<nibble, const child&>;
+
+  class iterator {
+  public:
+    using difference_type = std::ptrdiff_t;
+    using value_type = children::value_type;
+    using iterator_category = std::forward_iterator_tag;
+
+    iterator() = default;
+    iterator(const children* owner, uint16_t remaining): owner(owner), remaining(remaining) {}
+
+    value_type operator*() const {
+      auto n = std::countr_zero(remaining);
+      return {nibble(n), owner->slots[owner->slots.size() - std::popcount(remaining)]};
+    }
 
-inline bool operator==(const children::value_type& a, const children::value_type& b) {
-  return std::tie(a.first, a.second) == std::tie(b.first, b.second);
-}
+    iterator& operator++() {
+      remaining &= remaining - 1;
+      return *this;
+    }
+
+    iterator operator++(int) {
+      auto it = *this;
+      ++*this;
+      return it;
+    }
+
+    friend bool operator==(const iterator& a, const iterator& b) {
+      return a.remaining == b.remaining;
+    }
+
+  private:
+    const children* owner = nullptr;
+    uint16_t remaining = 0;
+  };
+
+  /// \return false if there already is a child at the nibble
+  bool insert(const std::pair<nibble, child>& value) {
+    if (contains(value.first)) {
+      return false;
+    }
+    insert_or_assign(value.first, value.second);
+    return true;
+  }
 
+  void insert_or_assign(nibble n, const child& c) {
+    auto bit = uint16_t(1 << n.value);
+    auto pos = rank(n);
+    if (existence & bit) {
+      slots[pos] = c;
+    } else {
+      slots.insert(slots.begin() + pos, c);
+      existence |= bit;
+    }
+    leaves = c.is_leaf() ? leaves | bit : leaves & ~bit;
+  }
+
+  void reserve(size_t n) {
+    slots.reserve(n);
+  }
+
+  bool contains(nibble n) const {
+    return existence & (1 << n.value);
+  }
+
+  const child* find(nibble n) const {
+    return contains(n) ? &slots[rank(n)] : nullptr;
+  }
+
+  const child& at(nibble n) const {
+    check(contains(n), fmt::format("no child at nibble {}", n.value));
+    return slots[rank(n)];
+  }
+
+  size_t size() const {
+    return slots.size();
+  }
+
+  bool empty() const {
+    return !existence;
+  }
+
+  uint16_t existence_bitmap() const {
+    return existence;
+  }
+
+  uint16_t leaf_bitmap() const {
+    return leaves;
+  }
+
+  iterator begin() const {
+    return {this, existence};
+  }
+
+  iterator end() const {
+    return {this, 0};
+  }
+
+  friend bool operator==(const children& a, const children& b) {
+    return std::tie(a.existence, a.leaves, a.slots) == std::tie(b.existence, b.leaves, b.slots);
+  }
+
+private:
+  size_t rank(nibble n) const {
+    return std::popcount(uint16_t(existence & ((1 << n.value) - 1)));
+  }
+
+  uint16_t existence = 0;
+  uint16_t leaves = 0;
+  std::vector<child> slots;
+};
+
+/// \remarks children must not be modified after construction, as the node hash is computed once on first use
 struct internal_node {
   internal_node() = default;
 
   internal_node(const jmt::children& ch): children(ch), leaf_count(sum_leaf_count(children)) {
     check(!children.empty(), "children must not be empty");
     if (children.size() == 1) {
-      check(!children.begin()->second.is_leaf(), "if there's only one child, it must not be a leaf");
+      check(!(*children.begin()).second.is_leaf(), "if there's only one child, it must not be a leaf");
     }
   }
 
   internal_node(jmt::children&& ch): children(std::move(ch)), leaf_count(sum_leaf_count(children)) {
     check(!children.empty(), "children must not be empty");
     if (children.size() == 1) {
-      check(!children.begin()->second.is_leaf(), "if there's only one child, it must not be a leaf");
+      check(!(*children.begin()).second.is_leaf(), "if there's only one child, it must not be a leaf");
     }
   }
 
@@ -163,42 +276,28 @@ struct internal_node {
   using bitmap_type = std::array<uint16_t, 2>;
 
   bitmap_type generate_bitmaps() const {
-    auto existence_bitmap = uint16_t(0);
-    auto leaf_bitmap = uint16_t(0);
-    for (const auto& c : children) {
-      auto i = c.first.value;
-      existence_bitmap |= uint16_t(1) << i;
-      if (c.second.is_leaf()) {
-        leaf_bitmap |= uint16_t(1) << i;
-      }
-    }
-    check((existence_bitmap | leaf_bitmap) == existence_bitmap);
-    return {existence_bitmap, leaf_bitmap};
+    return {children.existence_bitmap(), children.leaf_bitmap()};
   }
 
   Bytes32 hash() const {
-    return merkle_hash(0, 16, generate_bitmaps());
+    if (!cached_hash) {
+      cached_hash = merkle_hash(0, 16, generate_bitmaps());
+    }
+    return *cached_hash;
   }
 
-  // for deterministic serialization
-  // children_sorted();
-
   void serialize(std::vector<uint8_t>& binary) const {
     auto [existence_bitmap, leaf_bitmap] = generate_bitmaps();
     binary.push_back(existence_bitmap & 0xff);
     binary.push_back(existence_bitmap >> 8);
     binary.push_back(leaf_bitmap & 0xff);
     binary.push_back(leaf_bitmap >> 8);
-    auto count = std::popcount(existence_bitmap);
-    for (auto i = 0; i < count; ++i) {
-      auto next_child = std::countr_zero(existence_bitmap);
-      auto child = children.at(next_child);
+    for (const auto& [_, child] : children) {
       detail::serialize_u64_varint(child.version, binary);
       binary.insert(binary.end(), child.hash.begin(), child.hash.end());
       if (std::holds_alternative<internal>(child.node_type)) {
-        detail::serialize_u64_varint(leaf_count, binary);
+        detail::serialize_u64_varint(child.leaf_count(), binary);
       }
-      existence_bitmap &= ~(1 << next_child);
     }
   }
 
@@ -215,6 +314,7 @@ struct internal_node {
 
     jmt::children children;
     auto count = std::popcount(existence_bitmap);
+    children.reserve(count);
     for (auto i = 0; i < count; ++i) {
       auto next_child = std::countr_zero(existence_bitmap);
       Varuint64 v;
@@ -234,6 +334,7 @@ struct internal_node {
         ds >> leaf_count;
         type = internal{leaf_count};
       }
+      // children come in nibble order, so each one is appended to the slots
       children.insert_or_assign(next_child, jmt::child{hash, version, type});
       existence_bitmap &= ~child_bit;
     }
@@ -242,9 +343,8 @@ struct internal_node {
   }
 
   std::optional<std::reference_wrapper<const jmt::child>> child(nibble n) const {
-    auto ch = children.find(n);
-    if (ch != children.end()) {
-      return ch->second;
+    if (auto* ch = children.find(n)) {
+      return *ch;
     }
     return std::nullopt;
   }
@@ -276,7 +376,7 @@ struct internal_node {
     return {child_half_start, sibling_half_start};
   }
 
-  std::tuple<std::optional<node_key>, std::vector<Bytes32>> get_child_with_siblings(const node_key& key, nibble n) {
+  std::tuple<std::optional<node_key>, std::vector<Bytes32>> get_child_with_siblings(const node_key& key, nibble n) const {
     std::vector<Bytes32> siblings;
     auto [existence_bitmap, leaf_bitmap] = generate_bitmaps();
 
@@ -309,6 +409,9 @@ struct internal_node {
 
   jmt::children children;
   size_t leaf_count;
+
+private:
+  mutable std::optional<Bytes32> cached_hash;
 };
 
 inline std::array<uint8_t, 2> get_child_and_sibling_half_start(nibble n, uint8_t height) {
@@ -8,7 +8,9 @@
 #include <noir/core/core.h>
 #include <noir/crypto/hash/sha3.h>
 #include <noir/jmt/types/common.h>
+#include <algorithm>
 #include <optional>
+#include <span>
 
 namespace noir::jmt {
 
@@ -108,4 +110,187 @@ struct sparse_merkle_proof {
   std::vector<Bytes32> siblings;
 };
 
+/// \brief proof that a leaf and every leaf left of it make up the tree, given the siblings on the left of its path
+/// Only the siblings on the right of the path to the rightmost leaf are kept. The verifier supplies the left ones,
+/// either directly or by hashing all the leaves up to the rightmost one.
+struct sparse_merkle_range_proof {
+  /// \param left_siblings siblings on the left of the path to rightmost_known_leaf, from the leaf up
+  auto verify(const Bytes32& expected_root_hash,
+    sparse_merkle_leaf_node rightmost_known_leaf,
+    const std::vector<Bytes32>& left_siblings) const -> Result<void> {
+    auto num_siblings = left_siblings.size() + right_siblings.size();
+    noir_ensure(num_siblings <= 256, "sparse merkle range proof has more than 256 ({}) siblings", num_siblings);
+    auto left = left_siblings.begin();
+    auto right = right_siblings.begin();
+    auto hash = rightmost_known_leaf.hash();
+    for (auto depth = num_siblings; depth-- > 0;) {
+      sparse_merkle_internal_node node;
+      if (key_bit(rightmost_known_leaf.key, depth)) {
+        noir_ensure(left != left_siblings.end(), "not enough left siblings at depth {}", depth);
+        node = {*left++, hash};
+      } else {
+        noir_ensure(right != right_siblings.end(), "not enough right siblings at depth {}", depth);
+        node = {hash, *right++};
+      }
+      hash = node.hash();
+    }
+    noir_ensure(hash == expected_root_hash, "root hashes do not match. actual root hash: {}, expected: {}",
+      hash.to_string(), expected_root_hash.to_string());
+    return success();
+  }
+
+  /// \brief verifies that leaves, sorted by key, are all the leaves of the tree up to and including the last one
+  auto verify(const Bytes32& expected_root_hash, std::span<const sparse_merkle_leaf_node> leaves) const
+    -> Result<void> {
+    noir_ensure(!leaves.empty(), "no leaves to verify");
+    for (size_t i = 1; i < leaves.size(); ++i) {
+      noir_ensure(leaves[i - 1].key < leaves[i].key, "leaves are not sorted by key at {}", i);
+    }
+    const auto& rightmost = leaves.back();
+
+    // common prefix lengths with the rightmost leaf never decrease from left to right
+    auto prefix_len = [&](size_t i) { return common_prefix_bits_len(leaves[i].key, rightmost.key); };
+    auto depth = noir_ok(rightmost_leaf_depth(
+      rightmost.key, leaves.size() > 1 ? std::optional(prefix_len(leaves.size() - 2)) : std::nullopt));
+
+    // leaves branching off the path at depth d make up the left sibling at d
+    auto left_siblings = std::vector<Bytes32>();
+    auto end = leaves.size() - 1;
+    for (auto d = depth; d-- > 0;) {
+      if (!key_bit(rightmost.key, d)) {
+        continue;
+      }
+      auto begin = end;
+      while (begin > 0 && prefix_len(begin - 1) == d) {
+        --begin;
+      }
+      left_siblings.push_back(subtree_hash(leaves.subspan(begin, end - begin), d + 1));
+      end = begin;
+    }
+    noir_ensure(!end, "leaves are not in the subtrees left of the rightmost leaf");
+    return verify(expected_root_hash, rightmost, left_siblings);
+  }
+
+  /// \brief depth of the rightmost leaf in the tree the proof was made for
+  /// The leaf sits below the point where its path branches off from the leaf before it, at the first depth where every
+  /// right sibling has been passed.
+  /// \param prefix_len_with_previous common prefix length in bits with the leaf before it, nullopt if there is none
+  auto rightmost_leaf_depth(const Bytes32& rightmost_key, std::optional<size_t> prefix_len_with_previous) const
+    -> Result<size_t> {
+    auto depth = prefix_len_with_previous ? *prefix_len_with_previous + 1 : 0;
+    noir_ensure(depth <= 256, "leaves with the same key {}", rightmost_key.to_string());
+    auto zeros = size_t(0);
+    for (size_t d = 0; d < depth; ++d) {
+      zeros += !key_bit(rightmost_key, d);
+    }
+    noir_ensure(zeros <= right_siblings.size(), "more right siblings on the path than in the proof");
+    for (; zeros < right_siblings.size(); ++depth) {
+      noir_ensure(depth < 256, "not enough depth for {} right siblings", right_siblings.size());
+      zeros += !key_bit(rightmost_key, depth);
+    }
+    return depth;
+  }
+
+  /// \brief root hash of the subtree at depth holding exactly leaves, sorted by key
+  static Bytes32 subtree_hash(std::span<const sparse_merkle_leaf_node> leaves, size_t depth) {
+    if (leaves.empty()) {
+      return sparse_merkle_placeholder_hash;
+    } else if (leaves.size() == 1) {
+      return sparse_merkle_leaf_node(leaves[0]).hash();
+    }
+    auto mid = std::partition_point(
+      leaves.begin(), leaves.end(), [&](const auto& leaf) { return !key_bit(leaf.key, depth); });
+    auto left = leaves.subspan(0, mid - leaves.begin());
+    auto right = leaves.subspan(mid - leaves.begin());
+    return sparse_merkle_internal_node{subtree_hash(left, depth + 1), subtree_hash(right, depth + 1)}.hash();
+  }
+
+  /// siblings on the right of the path to the rightmost leaf, from the leaf up
+  std::vector<Bytes32> right_siblings;
+};
+
+/// \brief proof for many keys at once, sharing the part of their paths they have in common
+/// Walking down from the root, a subtree holding queried keys on both sides needs no sibling, as both halves are
+/// recomputed from the keys. A sibling is kept only where all the queried keys of a subtree go to one side.
+template<typename T>
+struct sparse_merkle_multi_proof {
+  /// \param element_keys sorted and unique, as passed to get_with_multi_proof
+  auto verify(const Bytes32& expected_root_hash,
+    std::span<const Bytes32> element_keys,
+    std::span<const std::optional<std::remove_reference_t<T>>> element_values) const -> Result<void> {
+    noir_ensure(!element_keys.empty(), "no keys to verify");
+    noir_ensure(element_keys.size() == element_values.size() && element_keys.size() == leaves.size() &&
+        element_keys.size() == depths.size(),
+      "numbers of keys ({}), values ({}), leaves ({}) and depths ({}) do not match", element_keys.size(),
+      element_values.size(), leaves.size(), depths.size());
+    for (size_t i = 0; i < element_keys.size(); ++i) {
+      const auto& key = element_keys[i];
+      noir_ensure(!i || element_keys[i - 1] < key, "keys are not sorted and unique at {}", i);
+      noir_ensure(depths[i] <= 256, "depth of key {} is more than 256 ({})", key.to_string(), depths[i]);
+      const auto& leaf = leaves[i];
+      if (element_values[i]) {
+        noir_ensure(leaf, "expected inclusion proof for key {}. found non-inclusion proof", key.to_string());
+        noir_ensure(key == leaf->key, "keys do not match. key in proof: {}, expected: {}", leaf->key.to_string(),
+          key.to_string());
+        Bytes32 hash;
+        default_hasher{}(*element_values[i], hash);
+        noir_ensure(hash == leaf->value_hash, "value hashes do not match. value hash in proof: {}, expected: {}",
+          leaf->value_hash.to_string(), hash.to_string());
+      } else if (leaf) {
+        noir_ensure(key != leaf->key, "expected non-inclusion proof, but key {} exists in proof", key.to_string());
+        noir_ensure(common_prefix_bits_len(key, leaf->key) >= depths[i],
+          "leaf in proof is not in the subtree of key {}", key.to_string());
+      }
+    }
+    auto next_sibling = size_t(0);
+    auto actual_root_hash = noir_ok(root_hash(element_keys, 0, element_keys.size(), 0, next_sibling));
+    noir_ensure(next_sibling == siblings.size(), "{} siblings left unused", siblings.size() - next_sibling);
+    noir_ensure(actual_root_hash == expected_root_hash,
+      "root hashes do not match. actual root hash: {}, expected: {}", actual_root_hash.to_string(),
+      expected_root_hash.to_string());
+    return success();
+  }
+
+  /// proven leaf of each key, or nullopt if the key's subtree is empty
+  std::vector<std::optional<sparse_merkle_leaf_node>> leaves;
+  /// depth of the subtree each key ends in
+  std::vector<uint16_t> depths;
+  /// siblings of the subtrees without queried keys, in depth first order
+  std::vector<Bytes32> siblings;
+
+private:
+  auto root_hash(std::span<const Bytes32> keys, size_t first, size_t last, size_t depth, size_t& next_sibling) const
+    -> Result<Bytes32> {
+    noir_ensure(depths[first] >= depth, "key {} ends above depth {}", keys[first].to_string(), depth);
+    if (depths[first] == depth) {
+      for (auto i = first + 1; i < last; ++i) {
+        noir_ensure(depths[i] == depth && leaves[i].has_value() == leaves[first].has_value() &&
+            (!leaves[i] || std::tie(leaves[i]->key, leaves[i]->value_hash) ==
+                             std::tie(leaves[first]->key, leaves[first]->value_hash)),
+          "keys {} and {} end in the same subtree with different leaves", keys[first].to_string(),
+          keys[i].to_string());
+      }
+      return leaves[first] ? sparse_merkle_leaf_node(*leaves[first]).hash() : sparse_merkle_placeholder_hash;
+    }
+    noir_ensure(depth < 256, "key {} does not end within 256 bits", keys[first].to_string());
+    auto mid = size_t(std::partition_point(keys.begin() + first, keys.begin() + last,
+                        [&](const auto& k) { return !key_bit(k, depth); }) -
+      keys.begin());
+    auto node = sparse_merkle_internal_node{};
+    if (first < mid && mid < last) {
+      node.left_child = noir_ok(root_hash(keys, first, mid, depth + 1, next_sibling));
+      node.right_child = noir_ok(root_hash(keys, mid, last, depth + 1, next_sibling));
+    } else {
+      noir_ensure(next_sibling < siblings.size(), "not enough siblings at depth {}", depth);
+      auto sibling = siblings[next_sibling++];
+      if (mid == last) {
+        node = {noir_ok(root_hash(keys, first, last, depth + 1, next_sibling)), sibling};
+      } else {
+        node = {sibling, noir_ok(root_hash(keys, first, last, depth + 1, next_sibling))};
+      }
+    }
+    return node.hash();
+  }
+};
+
 } // namespace noir::jmt
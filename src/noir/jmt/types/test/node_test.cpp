@@ -81,6 +81,42 @@ TEST_CASE("node: internal_validity", "[noir][jmt]") {
     "if there's only one child, it must not be a leaf");
 }
 
+TEST_CASE("node: children", "[noir][jmt]") {
+  auto hashes = std::vector<Bytes32>();
+  for (auto i = 0; i < 16; ++i) {
+    hashes.push_back(random_Bytes32());
+  }
+  jmt::children children;
+  for (auto n : {9, 3, 15, 0, 4}) {
+    CHECK(children.insert({n, child{hashes[n], 1, leaf{}}}));
+  }
+  CHECK(!children.insert({3, child{hashes[0], 2, leaf{}}}));
+  children.insert_or_assign(4, child{hashes[4], 2, jmt::internal{3}});
+
+  CHECK(children.size() == 5);
+  CHECK(children.existence_bitmap() == 0b1000'0010'0001'1001);
+  CHECK(children.leaf_bitmap() == 0b1000'0010'0000'1001);
+  CHECK(children.at(3).hash == hashes[3]);
+  CHECK(children.at(4).leaf_count() == 3);
+  CHECK(!children.find(5));
+  auto nibbles = std::vector<int>();
+  for (const auto& [n, c] : children) {
+    nibbles.push_back(n.value);
+    CHECK(c.hash == hashes[n.value]);
+  }
+  CHECK(nibbles == std::vector<int>{0, 3, 4, 9, 15});
+
+  // the same children inserted in another order
+  jmt::children other;
+  for (auto n : {0, 3, 4, 9, 15}) {
+    other.insert_or_assign(n, children.at(n));
+  }
+  CHECK(other == children);
+  auto parent = internal_node(children);
+  CHECK(parent.leaf_count == 7);
+  CHECK(parent.hash() == internal_node(other).hash());
+}
+
 TEST_CASE("node: leaf_hash", "[noir][jmt]") {
   auto address = random_Bytes32();
   auto blob = Bytes{2};
@@ -12,6 +12,9 @@ namespace noir::jmt {
 
 extern jmt::version pre_genesis_version;
 
+template<typename R, typename T>
+struct tree_cache_shard;
+
 template<typename T>
 struct frozen_tree_cache {
   node_batch<T> node_cache;
@@ -100,6 +103,19 @@ struct tree_cache {
     next_version += 1;
   }
 
+  /// \brief takes over the nodes put and deleted through shard
+  void merge(tree_cache_shard<R, T>& shard) {
+    for (auto& [node_key, node] : shard.node_cache) {
+      check(node_cache.insert({node_key, std::move(node)}).second,
+        fmt::format("node with key `{}` already exists in node_batch", node_key.to_string()));
+    }
+    shard.node_cache.clear();
+    num_new_leaves += shard.num_new_leaves;
+    stale_node_index_cache.merge(shard.stale_node_index_cache);
+    check(shard.stale_node_index_cache.empty(), "node gets stale twice unexpectedly");
+    num_stale_leaves += shard.num_stale_leaves;
+  }
+
   std::pair<std::vector<Bytes32>, tree_update_batch<T>> deltas() {
     return {frozen_cache.root_hashes,
       {frozen_cache.node_cache, frozen_cache.stale_node_index_cache, frozen_cache.node_stats}};
@@ -115,4 +131,52 @@ struct tree_cache {
   R& reader;
 };
 
+/// \brief tree_cache for building one subtree while other subtrees are built on other threads
+/// Nodes are put and deleted in the shard only, and reads of nodes not in the shard go to the parent, which must not
+/// change until the shard is merged back with tree_cache::merge. Shards of disjoint subtrees touch disjoint nodes, so
+/// merging them gives the same cache as building the subtrees one after another on the parent.
+template<typename R, typename T = typename R::value_type>
+struct tree_cache_shard {
+  explicit tree_cache_shard(tree_cache<R, T>& parent): parent(parent) {}
+
+  Result<node<T>> get_node(const jmt::node_key& node_key) {
+    auto it = node_cache.find(node_key);
+    if (it != node_cache.end()) {
+      return it->second;
+    }
+    return parent.get_node(node_key);
+  }
+
+  Result<void> put_node(const jmt::node_key& node_key, const node<T>& new_node) {
+    if (!node_cache.contains(node_key)) {
+      if (new_node.is_leaf())
+        num_new_leaves += 1;
+      node_cache.insert({node_key, new_node});
+    } else {
+      return Error::format("node with key `{}` already exists in node_batch", node_key.to_string());
+    }
+    return success();
+  }
+
+  void delete_node(const node_key& old_node_key, bool is_leaf) {
+    auto it = node_cache.find(old_node_key);
+    if (it == node_cache.end()) {
+      check(!stale_node_index_cache.contains(old_node_key) && !parent.stale_node_index_cache.contains(old_node_key),
+        "node gets stale twice unexpectedly");
+      stale_node_index_cache.insert(old_node_key);
+      if (is_leaf)
+        num_stale_leaves += 1;
+    } else {
+      node_cache.erase(it);
+      num_new_leaves -= 1;
+    }
+  }
+
+  std::unordered_map<node_key, node<T>> node_cache;
+  size_t num_new_leaves = 0;
+  std::set<node_key> stale_node_index_cache;
+  size_t num_stale_leaves = 0;
+  tree_cache<R, T>& parent;
+};
+
 } // namespace noir::jmt
@@ -8,37 +8,24 @@
 
 namespace noir::mempool {
 
-void LRUTxCache::reset() {
-  std::unique_lock g{mtx};
-  tx_keys.clear();
+void ClockTxCache::reset() {
+  tx_keys.reset();
 }
 
-bool LRUTxCache::push(const consensus::tx& tx) {
-  std::unique_lock g{mtx};
-
-  auto key = crypto::Sha256()(tx);
-  auto& list = tx_keys.get<0>();
-  auto& cache_map = tx_keys.get<1>();
-
-  if (auto moved = cache_map.find(key); moved != cache_map.end()) {
-    list.splice(list.end(), list, tx_keys.project<0>(moved));
-    return false;
-  }
-
-  if (list.size() >= size) {
-    list.pop_front();
-  }
-
-  list.push_back(key);
+bool ClockTxCache::push(const consensus::tx& tx) {
+  return push_key(crypto::Sha256()(tx));
+}
 
-  return true;
+bool ClockTxCache::push_key(const types::TxKey& key) {
+  return tx_keys.put(key, {});
 }
 
-void LRUTxCache::remove(const consensus::tx& tx) {
-  std::unique_lock g{mtx};
+void ClockTxCache::remove(const consensus::tx& tx) {
+  tx_keys.del(crypto::Sha256()(tx));
+}
 
-  auto key = crypto::Sha256()(tx);
-  tx_keys.get<1>().erase(key);
+size_t ClockTxCache::size() const {
+  return tx_keys.size();
 }
 
 } // namespace noir::mempool
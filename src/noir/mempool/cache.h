@@ -5,14 +5,12 @@
 //
 #pragma once
 #include <noir/common/bytes.h>
+#include <noir/common/clock_cache.h>
 #include <noir/common/concepts.h>
 #include <noir/consensus/tx.h>
 #include <tendermint/types/mempool.h>
-#include <boost/multi_index/ordered_index.hpp>
-#include <boost/multi_index/sequenced_index.hpp>
-#include <boost/multi_index_container.hpp>
 #include <concepts>
-#include <mutex>
+#include <variant>
 
 namespace noir::mempool {
 
@@ -23,32 +21,21 @@ concept TxCache = requires(T cache) {
   { cache.remove(consensus::tx{}) } -> std::same_as<void>;
 };
 
-class LRUTxCache {
+/// \brief remembers the keys of recently seen txs, evicting with CLOCK once cache_size keys are held
+class ClockTxCache {
 public:
   void reset();
   bool push(const consensus::tx& tx);
+  /// \brief same as push, for callers that already hold the tx key
+  bool push_key(const types::TxKey& key);
   void remove(const consensus::tx& tx);
+  size_t size() const;
 
-  LRUTxCache() = default;
-  LRUTxCache(int cache_size): size(cache_size) {}
+  ClockTxCache() = default;
+  ClockTxCache(int cache_size): tx_keys(cache_size) {}
 
 private:
-  // clang-format off
-  using TxKeys = boost::multi_index_container<
-    types::TxKey,
-    boost::multi_index::indexed_by<
-      boost::multi_index::sequenced<>,
-      boost::multi_index::ordered_unique<boost::multi_index::identity<Bytes>>
-    >
-  >;
-  // clang-format on
-
-  std::mutex mtx;
-  int size;
-
-public:
-  // FIXME: temporarily public for testing
-  TxKeys tx_keys;
+  clock_cache<types::TxKey, std::monostate> tx_keys;
 };
 
 } // namespace noir::mempool
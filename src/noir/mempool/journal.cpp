@@ -0,0 +1,286 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#include <noir/crypto/hash/crc32c.h>
+#include <noir/mempool/journal.h>
+#include <boost/endian/conversion.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace noir::mempool {
+
+namespace bip = boost::interprocess;
+namespace endian = boost::endian;
+
+namespace {
+  enum RecordType : uint8_t {
+    record_add = 1,
+    record_remove = 2,
+  };
+
+  constexpr size_t key_size = 32;
+  constexpr size_t remove_record_size = 1 + key_size;
+  constexpr size_t add_record_fixed_size = remove_record_size + 8 * 4 + 4;
+
+  void create_file(const std::filesystem::path& path, uint64_t size) {
+    if (path.has_parent_path()) {
+      std::filesystem::create_directories(path.parent_path());
+    }
+    std::ofstream(path, std::ios::binary | std::ios::app);
+    if (std::filesystem::file_size(path) < size) {
+      std::filesystem::resize_file(path, size);
+    }
+  }
+} // namespace
+
+auto TxJournal::open(const std::filesystem::path& path, uint64_t min_compact_bytes)
+  -> Result<std::unique_ptr<TxJournal>> {
+  auto journal = std::unique_ptr<TxJournal>(new TxJournal(path, min_compact_bytes));
+  if (auto ok = journal->map(min_file_size); !ok) {
+    return ok.error();
+  }
+  journal->scan();
+  return journal;
+}
+
+TxJournal::TxJournal(std::filesystem::path path, uint64_t min_compact_bytes)
+  : path(std::move(path)), min_compact_bytes(min_compact_bytes) {}
+
+TxJournal::~TxJournal() {
+  thread_pool.stop();
+}
+
+auto TxJournal::data() -> unsigned char* {
+  return static_cast<unsigned char*>(region.get_address());
+}
+
+auto TxJournal::map(uint64_t file_size) -> Result<void> {
+  try {
+    create_file(path, file_size);
+    auto mapped = bip::mapped_region(bip::file_mapping(path.c_str(), bip::read_write), bip::read_write);
+    region.swap(mapped);
+  } catch (const std::exception& e) {
+    return Error::format("failed to map mempool journal {}: {}", path.string(), e.what());
+  }
+  return success();
+}
+
+void TxJournal::scan() {
+  auto capacity = region.get_size();
+  auto pos = uint64_t(0);
+  while (pos + header_size <= capacity) {
+    auto* p = data() + pos;
+    auto crc = endian::load_big_u32(p);
+    auto len = endian::load_big_u32(p + 4);
+    if (len < remove_record_size || pos + header_size + len > capacity) {
+      break;
+    }
+    auto body = std::span<const unsigned char>(p + header_size, len);
+    if (crypto::Crc32c()(body) != crc) {
+      break;
+    }
+    auto type = body[0];
+    auto hash = types::TxKey(body.subspan(1, key_size));
+    auto size = uint32_t(header_size + len);
+    if (type == record_add && len >= add_record_fixed_size &&
+      add_record_fixed_size + endian::load_big_u32(body.data() + add_record_fixed_size - 4) <= len) {
+      if (auto it = live.find(hash); it != live.end()) {
+        live_bytes -= it->second.size;
+        dead_bytes += it->second.size;
+      }
+      live[hash] = {pos, size};
+      live_bytes += size;
+    } else if (type == record_remove) {
+      if (auto it = live.find(hash); it != live.end()) {
+        live_bytes -= it->second.size;
+        dead_bytes += it->second.size;
+        live.erase(it);
+      }
+      dead_bytes += size;
+    } else {
+      break;
+    }
+    pos += size;
+  }
+  end = pos;
+
+  // clears a record torn by a crash, so that it can't be read back once the space is reused
+  if (end + header_size <= capacity && endian::load_big_u32(data() + end + 4)) {
+    std::memset(data() + end, 0, capacity - end);
+  }
+}
+
+auto TxJournal::write(uint8_t type, const types::TxKey& hash, const Entry* entry) -> Result<uint32_t> {
+  auto len = entry ? add_record_fixed_size + entry->sender.size() + entry->tx.size() : remove_record_size;
+  auto size = header_size + len;
+  if (end + size > region.get_size()) {
+    if (auto ok = map(std::max(region.get_size() * 2, end + size)); !ok) {
+      return ok.error();
+    }
+  }
+
+  auto* p = data() + end + header_size;
+  p[0] = type;
+  std::memcpy(p + 1, hash.data(), key_size);
+  if (entry) {
+    auto* q = p + remove_record_size;
+    endian::store_big_u64(q, entry->height);
+    endian::store_big_u64(q + 8, entry->gas_wanted);
+    endian::store_big_u64(q + 16, entry->priority);
+    endian::store_big_u64(q + 24, entry->timestamp);
+    endian::store_big_u32(q + 32, entry->sender.size());
+    std::memcpy(q + 36, entry->sender.data(), entry->sender.size());
+    std::memcpy(q + 36 + entry->sender.size(), entry->tx.data(), entry->tx.size());
+  }
+  // the header goes last, so a record is only found once its body is in place
+  endian::store_big_u32(data() + end, crypto::Crc32c()(std::span<const unsigned char>(p, len)));
+  endian::store_big_u32(data() + end + 4, len);
+  end += size;
+  return uint32_t(size);
+}
+
+auto TxJournal::append(const Entry& entry) -> Result<void> {
+  std::scoped_lock _{mtx};
+  auto offset = end;
+  auto size = write(record_add, entry.hash, &entry);
+  if (!size) {
+    return size.error();
+  }
+  if (auto it = live.find(entry.hash); it != live.end()) {
+    live_bytes -= it->second.size;
+    dead_bytes += it->second.size;
+  }
+  live[entry.hash] = {offset, size.value()};
+  live_bytes += size.value();
+  return success();
+}
+
+auto TxJournal::remove(const types::TxKey& hash) -> Result<void> {
+  std::scoped_lock _{mtx};
+  auto it = live.find(hash);
+  if (it == live.end()) {
+    return success();
+  }
+  auto size = write(record_remove, hash, nullptr);
+  if (!size) {
+    return size.error();
+  }
+  live_bytes -= it->second.size;
+  dead_bytes += it->second.size + size.value();
+  live.erase(it);
+  compact_if_needed();
+  return success();
+}
+
+void TxJournal::compact_if_needed() {
+  if (dead_bytes < min_compact_bytes || dead_bytes <= live_bytes || compacting.exchange(true)) {
+    return;
+  }
+  async_thread_pool(thread_pool.get_executor(), [this]() {
+    std::scoped_lock _{mtx};
+    if (auto ok = compact_locked(); !ok) {
+      // the journal is left as it is, and compacted again after the next removal
+    }
+    compacting = false;
+  });
+}
+
+auto TxJournal::compact() -> Result<void> {
+  std::scoped_lock _{mtx};
+  return compact_locked();
+}
+
+auto TxJournal::compact_locked() -> Result<void> {
+  auto locations = std::vector<Location*>();
+  locations.reserve(live.size());
+  for (auto& [_, loc] : live) {
+    locations.push_back(&loc);
+  }
+  std::sort(locations.begin(), locations.end(), [](auto* a, auto* b) { return a->offset < b->offset; });
+
+  auto tmp_path = path;
+  tmp_path += ".compact";
+  auto offsets = std::vector<uint64_t>();
+  offsets.reserve(locations.size());
+  auto pos = uint64_t(0);
+  try {
+    std::filesystem::remove(tmp_path);
+    create_file(tmp_path, std::max(min_file_size, live_bytes * 2));
+    auto mapped = bip::mapped_region(bip::file_mapping(tmp_path.c_str(), bip::read_write), bip::read_write);
+    auto* dst = static_cast<unsigned char*>(mapped.get_address());
+    for (auto* loc : locations) {
+      std::memcpy(dst + pos, data() + loc->offset, loc->size);
+      offsets.push_back(pos);
+      pos += loc->size;
+    }
+    if (!mapped.flush()) {
+      throw std::runtime_error("flush failed");
+    }
+    std::filesystem::rename(tmp_path, path);
+    region.swap(mapped);
+  } catch (const std::exception& e) {
+    std::error_code ec;
+    std::filesystem::remove(tmp_path, ec);
+    return Error::format("failed to compact mempool journal {}: {}", path.string(), e.what());
+  }
+
+  for (size_t i = 0; i < locations.size(); i++) {
+    locations[i]->offset = offsets[i];
+  }
+  end = pos;
+  dead_bytes = 0;
+  num_compactions++;
+  return success();
+}
+
+auto TxJournal::load() -> std::vector<Entry> {
+  std::scoped_lock _{mtx};
+  auto locations = std::vector<Location>();
+  locations.reserve(live.size());
+  for (const auto& [_, loc] : live) {
+    locations.push_back(loc);
+  }
+  std::sort(locations.begin(), locations.end(), [](auto& a, auto& b) { return a.offset < b.offset; });
+
+  auto entries = std::vector<Entry>();
+  entries.reserve(locations.size());
+  for (const auto& loc : locations) {
+    auto body = std::span<const unsigned char>(data() + loc.offset + header_size, loc.size - header_size);
+    auto* q = body.data() + remove_record_size;
+    auto sender_size = endian::load_big_u32(q + 32);
+    auto sender = body.subspan(add_record_fixed_size, sender_size);
+    auto& entry = entries.emplace_back();
+    entry.hash = types::TxKey(body.subspan(1, key_size));
+    entry.height = int64_t(endian::load_big_u64(q));
+    entry.gas_wanted = int64_t(endian::load_big_u64(q + 8));
+    entry.priority = int64_t(endian::load_big_u64(q + 16));
+    entry.timestamp = tstamp(endian::load_big_u64(q + 24));
+    entry.sender = std::string(sender.begin(), sender.end());
+    entry.tx = Bytes(body.subspan(add_record_fixed_size + sender_size));
+  }
+  return entries;
+}
+
+auto TxJournal::sync() -> Result<void> {
+  std::scoped_lock _{mtx};
+  if (!region.flush(0, end)) {
+    return Error::format("failed to sync mempool journal {}", path.string());
+  }
+  return success();
+}
+
+auto TxJournal::size() -> size_t {
+  std::scoped_lock _{mtx};
+  return live.size();
+}
+
+auto TxJournal::used_bytes() -> uint64_t {
+  std::scoped_lock _{mtx};
+  return end;
+}
+
+} // namespace noir::mempool
@@ -0,0 +1,108 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#pragma once
+#include <noir/common/thread_pool.h>
+#include <noir/common/time.h>
+#include <noir/core/result.h>
+#include <tendermint/types/tx.h>
+#include <boost/functional/hash.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <unordered_map>
+
+namespace noir::mempool {
+
+/// \brief append-only journal of txs admitted to and removed from the mempool, so a restarted node can reload them
+/// Format: repeated 4 Bytes CRC32C sum + 4 Bytes length + record (header fields are big endian), where a record is
+/// 1 Byte type + 32 Bytes tx key, followed for an admission by 8 Bytes each of height, gas wanted, priority and
+/// timestamp, 4 Bytes sender length, the sender and the tx. The file is grown in steps and memory-mapped read-write,
+/// so an append is a copy into the page cache that survives a crash of the process; sync() is needed to survive a crash
+/// of the host. Reading stops at the first record that is zero or fails its checksum.
+///
+/// Once removed records take more than half of the file, the live ones are rewritten into a new file on a background
+/// thread, which is then renamed over the journal. Appends wait for the rewrite to finish.
+class TxJournal {
+public:
+  struct Entry {
+    types::Tx tx;
+    types::TxKey hash;
+    int64_t height;
+    int64_t gas_wanted;
+    int64_t priority;
+    std::string sender;
+    tstamp timestamp;
+  };
+
+  static constexpr size_t header_size = 8;
+  static constexpr uint64_t min_file_size = 1024 * 1024;
+  static constexpr uint64_t default_min_compact_bytes = 16 * 1024 * 1024;
+
+  /// \brief opens the journal at path, creating it if it doesn't exist, and indexes the records already in it
+  /// \param min_compact_bytes removed records must take at least this much before the journal is compacted
+  static auto open(const std::filesystem::path& path, uint64_t min_compact_bytes = default_min_compact_bytes)
+    -> Result<std::unique_ptr<TxJournal>>;
+
+  TxJournal(const TxJournal&) = delete;
+  TxJournal& operator=(const TxJournal&) = delete;
+  ~TxJournal();
+
+  auto append(const Entry& entry) -> Result<void>;
+  auto remove(const types::TxKey& hash) -> Result<void>;
+
+  /// \brief decodes every tx that was appended and not removed since
+  /// \return entries in the order they were appended
+  auto load() -> std::vector<Entry>;
+
+  /// \brief rewrites the journal with the live records only
+  auto compact() -> Result<void>;
+
+  /// \brief flushes the mapped file to disk
+  auto sync() -> Result<void>;
+
+  /// \brief number of live txs
+  auto size() -> size_t;
+
+  /// \brief bytes used in the file, including removed records
+  auto used_bytes() -> uint64_t;
+
+  /// \brief number of compactions that replaced the file
+  auto compactions() const -> uint64_t {
+    return num_compactions.load();
+  }
+
+private:
+  struct Location {
+    uint64_t offset;
+    uint32_t size;
+  };
+
+  TxJournal(std::filesystem::path path, uint64_t min_compact_bytes);
+
+  auto map(uint64_t file_size) -> Result<void>;
+  auto write(uint8_t type, const types::TxKey& hash, const Entry* entry) -> Result<uint32_t>;
+  void scan();
+  void compact_if_needed();
+  auto compact_locked() -> Result<void>;
+  auto data() -> unsigned char*;
+
+  std::filesystem::path path;
+  uint64_t min_compact_bytes;
+
+  std::mutex mtx;
+  boost::interprocess::mapped_region region;
+  uint64_t end = 0;
+  uint64_t live_bytes = 0;
+  uint64_t dead_bytes = 0;
+  std::unordered_map<types::TxKey, Location, boost::hash<types::TxKey>> live;
+
+  std::atomic<bool> compacting{false};
+  std::atomic<uint64_t> num_compactions{0};
+  named_thread_pool thread_pool{"mpjrnl", 1};
+};
+
+} // namespace noir::mempool
@@ -6,12 +6,16 @@
 #pragma once
 #include <noir/clist/clist.h>
 #include <noir/config/mempool.h>
+#include <noir/consensus/abci_types.h>
 #include <noir/core/core.h>
 #include <noir/mempool/cache.h>
+#include <noir/mempool/journal.h>
 #include <noir/mempool/priority_queue.h>
 #include <tendermint/proxy/app_conn.h>
 #include <tendermint/types/tx.h>
 #include <algorithm>
+#include <deque>
+#include <span>
 
 namespace noir::mempool {
 
@@ -27,13 +31,40 @@ struct ErrMempoolIsFull {
   }
 };
 
+struct Metrics {
+  /// number of times txs were rechecked
+  std::atomic<uint64_t> recheck_times;
+  /// number of rechecks stopped early because a newer block arrived
+  std::atomic<uint64_t> recheck_cancels;
+  /// number of txs sent to the app by the last recheck
+  std::atomic<int> last_recheck_txs;
+  /// wall time of the last recheck, in microseconds
+  std::atomic<int64_t> last_recheck_duration;
+  /// wall time of all rechecks, in microseconds
+  std::atomic<int64_t> recheck_duration;
+};
+
 template<abci::Client Client>
 class TxMempool {
 public:
+  TxMempool() = default;
+  TxMempool(
+    config::MempoolConfig* config, std::shared_ptr<proxy::AppConnMempool<Client>> proxy_app_conn, int64_t height)
+    : config(config),
+      proxy_app_conn(std::move(proxy_app_conn)),
+      notified_txs_available(false),
+      height(height),
+      size_bytes_(0),
+      cache(config->cache_size) {}
+
   // with_pre_check();
   // with_post_check();
   // with_metrics();
 
+  auto get_metrics() -> const Metrics& {
+    return metrics;
+  }
+
   auto size() {
     return tx_store.size();
   }
@@ -65,6 +96,105 @@ public:
 
   // check_tx();
 
+  /// \brief sends txs to the app for check_tx as one batch
+  /// Each tx is hashed once and checked against the size limit and the cache, which also rejects a tx repeated later in
+  /// the same batch. A tx already in the mempool records tx_info.sender_id as a peer that has it. The accepted txs are
+  /// queued to the app back to back and followed by a single flush. Txs the app connection failed to send are removed
+  /// from the cache again, while those sent before the failure stay in it.
+  /// No response callback is registered, as init_tx_callback is not implemented yet, so a tx isn't added to the
+  /// mempool here. The caller owns the returned ReqRes and reads the check_tx response through wait() or
+  /// set_callback().
+  /// \return for each tx in txs, the pending check_tx request or why the tx was rejected or not sent
+  auto check_txs(std::span<const types::Tx> txs, const TxInfo& tx_info)
+    -> std::vector<Result<std::shared_ptr<abci::ReqRes>>> {
+    std::shared_lock _{mtx};
+
+    auto results = std::vector<Result<std::shared_ptr<abci::ReqRes>>>();
+    results.reserve(txs.size());
+    auto pending = std::vector<size_t>();
+    auto reqs = std::vector<abci::RequestCheckTx>();
+
+    for (const auto& tx : txs) {
+      if (tx.size() > config->max_tx_bytes) {
+        results.push_back(Error::format("tx too large: max size is {}, but got {}", config->max_tx_bytes, tx.size()));
+        continue;
+      }
+
+      auto key = tx.key();
+      if (!cache.push_key(key)) {
+        // record a new peer for a tx we already have, so it isn't gossiped back
+        if (tx_info.sender_id) {
+          tx_store.get_or_set_peer_by_tx_hash(key, tx_info.sender_id);
+        }
+        results.push_back(Error("tx already exists in cache"));
+        continue;
+      }
+
+      pending.push_back(results.size());
+      results.push_back(std::shared_ptr<abci::ReqRes>());
+      auto& req = reqs.emplace_back();
+      req.set_tx(std::string(tx.begin(), tx.end()));
+      req.set_type(abci::CheckTxType::NEW);
+    }
+
+    if (reqs.empty()) {
+      return results;
+    }
+
+    auto sent = proxy_app_conn->check_txs_async(reqs);
+    for (size_t i = 0; i < pending.size(); i++) {
+      if (!sent[i]) {
+        // the tx never reached the app, so it must not be rejected as a duplicate when sent again
+        cache.remove(txs[pending[i]]);
+      }
+      results[pending[i]] = std::move(sent[i]);
+    }
+    return results;
+  }
+
+  /// \brief opens the journal at config->journal_path and puts the txs in it back into the mempool
+  /// Restored txs keep their priority, sender, height and timestamp and are added to the cache. Those that don't fit in
+  /// the mempool are dropped from the journal. The restored txs are then rechecked in a single pass if config->recheck
+  /// is set. From then on, txs added to or removed from the mempool are journaled.
+  /// \return number of restored txs
+  auto open_journal() -> Result<int> {
+    std::unique_lock _{mtx};
+
+    if (config->journal_path.empty()) {
+      return Error("mempool journal path is not set");
+    }
+    auto opened = TxJournal::open(std::filesystem::path(config->root_dir) / config->journal_path);
+    if (!opened) {
+      return opened.error();
+    }
+    auto& new_journal = opened.value();
+
+    auto num_txs = 0;
+    for (auto& entry : new_journal->load()) {
+      auto wtx = std::make_shared<WrappedTx>(WrappedTx{
+        .tx = std::move(entry.tx),
+        .hash = entry.hash,
+        .height = entry.height,
+        .gas_wanted = entry.gas_wanted,
+        .priority = entry.priority,
+        .sender = std::move(entry.sender),
+        .timestamp = entry.timestamp,
+      });
+      if (!can_add_tx(wtx) || !cache.push_key(entry.hash)) {
+        new_journal->remove(entry.hash);
+        continue;
+      }
+      insert_tx(wtx);
+      num_txs++;
+    }
+    journal = std::move(new_journal);
+
+    if (num_txs && config->recheck) {
+      update_re_check_txs();
+    }
+    return num_txs;
+  }
+
   auto remove_tx_by_key(const types::TxKey& tx_key) -> Result<void> {
     std::unique_lock _{mtx};
 
@@ -89,106 +219,130 @@ public:
 
   auto reap_max_bytes_max_gas(int64_t max_bytes, int64_t max_gas) {
     std::shared_lock _{mtx};
-
-    int64_t total_gas = 0;
-    int64_t total_size = 0;
-
-    auto wtxs = std::vector<std::shared_ptr<WrappedTx>>();
-    wtxs.reserve(priority_index.num_txs());
-    eo_defer([&]() {
-      for (const auto& wtx : wtxs) {
-        priority_index.push_tx(wtx);
-      }
-    });
-
-    auto txs = std::vector<types::Tx>();
-    txs.reserve(priority_index.num_txs());
-    while (priority_index.num_txs() > 0) {
-      auto wtx = priority_index.pop_tx();
-      txs.push_back(wtx->tx);
-      wtxs.push_back(wtx);
-      // auto size = types::compute_proto_size_for_txs();
-      auto size = 0;
-
-      if (max_bytes > -1 && (total_size + size) > max_bytes) {
-        // return txs...;
-      }
-
-      total_size += size;
-
-      auto gas = total_gas + wtx->gas_wanted;
-      if (max_gas > -1 && gas > max_gas) {
-        // return txs...;
-      }
-
-      total_gas = gas;
-    }
-
-    return txs;
+    return priority_index.reap_max_bytes_max_gas(max_bytes, max_gas);
   }
 
   auto reap_max_txs(int max) {
     std::shared_lock _{mtx};
+    return priority_index.reap_max_txs(max);
+  }
 
-    auto num_txs = priority_index.num_txs();
-    if (max < 0) {
-      max = num_txs;
+  /// \brief removes the txs committed in a block and rechecks the remaining txs against the new state
+  /// A recheck still running for the previous block is cancelled before mtx is taken, so the new block doesn't wait for
+  /// it to finish. Txs that were delivered successfully stay in the cache, so they are not accepted again.
+  auto update(int64_t block_height, std::span<const types::Tx> block_txs,
+    std::span<const abci::ResponseDeliverTx> deliver_tx_responses) -> Result<void> {
+    if (block_txs.size() != deliver_tx_responses.size()) {
+      return Error::format("mismatched number of txs ({}) and deliver_tx responses ({})", block_txs.size(),
+        deliver_tx_responses.size());
     }
 
-    auto cap = std::min(num_txs, max);
+    cancel_re_check_txs();
+    std::unique_lock _{mtx};
+
+    height = block_height;
+    notified_txs_available = false;
 
-    auto wtxs = std::vector<std::shared_ptr<WrappedTx>>();
-    wtxs.reserve(cap);
-    eo_defer([&]() {
-      for (const auto& wtx : wtxs) {
-        priority_index.push_tx(wtx);
+    for (size_t i = 0; i < block_txs.size(); i++) {
+      const auto& tx = block_txs[i];
+      if (deliver_tx_responses[i].code() == consensus::code_type_ok) {
+        cache.push(tx);
+      } else if (!config->keep_invalid_txs_in_cache) {
+        cache.remove(tx);
+      }
+
+      if (auto wtx = tx_store.get_tx_by_hash(tx.key()); wtx) {
+        remove_tx(wtx, false);
       }
-    });
-
-    // XXX: consider returning pointers not to copy all txs
-    auto txs = std::vector<types::Tx>();
-    txs.reserve(cap);
-    while (priority_index.num_txs() > 0 && txs.size() < max) {
-      auto wtx = priority_index.pop_tx();
-      txs.push_back(wtx->tx);
-      wtxs.push_back(wtx);
     }
 
-    return txs;
+    purge_expired_txs(block_height);
+
+    if (size()) {
+      if (config->recheck) {
+        update_re_check_txs();
+      } else {
+        notify_txs_available();
+      }
+    }
+    return success();
   }
 
-  // auto update();
+  /// \brief makes a recheck in progress stop before its next request
+  /// Called by update when a new block arrives, so that a recheck against the old state doesn't hold up the next
+  /// height. Doesn't take mtx, which the recheck holds.
+  void cancel_re_check_txs() {
+    recheck_generation++;
+  }
 
 private:
   // void init_tx_callback(const std::shared_ptr<WrappedTx>& wtx, ...);
 
   // void default_tx_callback();
 
-  // TODO
+  /// \brief sends every tx in the mempool to the app for recheck, from the highest priority down
+  /// At most config->recheck_window requests wait for a response at a time, and requests are flushed every
+  /// config->recheck_batch_size txs instead of one by one. The pass stops early on cancel_re_check_txs.
   void update_re_check_txs() {
     if (!size()) {
       throw std::runtime_error("attempted to update re-check_tx txs when mempool is empty");
     }
 
-    recheck_cursor = gossip_index.front();
-    recheck_end = gossip_index.back();
+    auto start = std::chrono::steady_clock::now();
+    auto generation = ++recheck_generation;
+    auto window = size_t(std::max(config->recheck_window, 1));
+    auto batch_size = std::max(config->recheck_batch_size, 1);
     // auto ctx = context::background();
 
-    for (auto e = gossip_index.front(); e; e = e->next()) {
-      if (!tx_store.is_tx_removed(e->value->hash)) {
-        auto& wtx = *e->value;
-        abci::RequestCheckTx req{};
-        req.set_tx(std::string(wtx.tx.begin(), wtx.tx.end()));
-        req.set_type(abci::CheckTxType::RECHECK);
-        if (auto ok = invoke(proxy_app_conn->check_tx_async(req)); !ok) {
+    auto in_flight = std::deque<std::shared_ptr<abci::ReqRes>>();
+    auto unflushed = 0;
+    auto flush = [&]() {
+      if (unflushed) {
+        if (auto ok = proxy_app_conn->flush_async(); !ok) {
           // logger->error(...);
         }
+        unflushed = 0;
       }
-    }
+    };
 
-    if (auto ok = invoke(proxy_app_conn->flush_async()); !ok) {
-      // logger->error(...);
+    auto num_txs = 0;
+    for (const auto& wtx : priority_index.get_txs_by_priority()) {
+      if (recheck_generation != generation) {
+        metrics.recheck_cancels++;
+        break;
+      }
+      if (tx_store.is_tx_removed(wtx->hash)) {
+        continue;
+      }
+
+      if (in_flight.size() >= window) {
+        flush();
+        in_flight.front()->wait();
+        in_flight.pop_front();
+      }
+
+      abci::RequestCheckTx req{};
+      req.set_tx(std::string(wtx->tx.begin(), wtx->tx.end()));
+      req.set_type(abci::CheckTxType::RECHECK);
+      auto ok = proxy_app_conn->check_tx_async(req);
+      if (!ok) {
+        // logger->error(...);
+        continue;
+      }
+      in_flight.push_back(std::move(ok.value()));
+      num_txs++;
+
+      if (++unflushed >= batch_size) {
+        flush();
+      }
     }
+    flush();
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    metrics.recheck_times++;
+    metrics.last_recheck_txs = num_txs;
+    metrics.last_recheck_duration = elapsed.count();
+    metrics.recheck_duration += elapsed.count();
   }
 
   auto can_add_tx(const std::shared_ptr<WrappedTx>& wtx) -> Result<void, ErrMempoolIsFull> {
@@ -215,6 +369,21 @@ private:
     wtx->gossip_el = std::move(gossip_el);
 
     size_bytes_ += wtx->size();
+
+    if (journal) {
+      auto entry = TxJournal::Entry{
+        .tx = wtx->tx,
+        .hash = wtx->hash,
+        .height = wtx->height,
+        .gas_wanted = wtx->gas_wanted,
+        .priority = wtx->priority,
+        .sender = wtx->sender,
+        .timestamp = wtx->timestamp,
+      };
+      if (auto ok = journal->append(entry); !ok) {
+        // logger->error(...);
+      }
+    }
   }
 
   void remove_tx(const std::shared_ptr<WrappedTx>& wtx, bool remove_from_cache) {
@@ -233,6 +402,12 @@ private:
     if (remove_from_cache) {
       cache.remove(wtx->tx);
     }
+
+    if (journal) {
+      if (auto ok = journal->remove(wtx->hash); !ok) {
+        // logger->error(...);
+      }
+    }
   }
 
   void purge_expired_txs(int64_t block_height) {
@@ -280,7 +455,7 @@ private:
 
 private:
   // std::shared_ptr<log::Logger> logger;
-  // metrics;
+  Metrics metrics;
   // TODO: change this to reference unless nullable
   config::MempoolConfig* config = nullptr;
   std::shared_ptr<proxy::AppConnMempool<Client>> proxy_app_conn;
@@ -292,14 +467,15 @@ private:
 
   std::atomic<int64_t> size_bytes_;
 
-  LRUTxCache cache;
+  ClockTxCache cache;
+
+  std::unique_ptr<TxJournal> journal;
 
   TxStore tx_store;
 
   clist::CList<std::shared_ptr<WrappedTx>> gossip_index;
 
-  clist::CElementPtr<std::shared_ptr<WrappedTx>> recheck_cursor;
-  clist::CElementPtr<std::shared_ptr<WrappedTx>> recheck_end;
+  std::atomic<uint64_t> recheck_generation;
 
   struct by_height;
   struct by_timestamp;
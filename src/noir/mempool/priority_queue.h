@@ -42,6 +42,57 @@ public:
     return {};
   }
 
+  /// \brief returns txs from the highest priority down, stopping before the first tx that would take the total proto
+  /// size over max_bytes or the total gas over max_gas; a negative limit is not checked
+  /// Txs are visited in place and returned as handles sharing ownership with their WrappedTx, so nothing is copied.
+  auto reap_max_bytes_max_gas(int64_t max_bytes, int64_t max_gas) -> std::vector<std::shared_ptr<const types::Tx>> {
+    std::shared_lock g{mtx};
+
+    int64_t total_size = 0;
+    int64_t total_gas = 0;
+
+    std::vector<std::shared_ptr<const types::Tx>> reaped;
+    auto& heap = txs.template get<TxPriorityQueue::by_priority>();
+    for (auto it = heap.rbegin(); it != heap.rend(); ++it) {
+      const auto& wtx = *it;
+      auto size = types::compute_proto_size_for_txs({&wtx->tx, 1});
+      if (max_bytes > -1 && total_size + size > max_bytes) {
+        break;
+      }
+      auto gas = total_gas + wtx->gas_wanted;
+      if (max_gas > -1 && gas > max_gas) {
+        break;
+      }
+      total_size += size;
+      total_gas = gas;
+      reaped.emplace_back(wtx, &wtx->tx);
+    }
+    return reaped;
+  }
+
+  /// \brief returns up to max txs from the highest priority down; a negative max returns all txs
+  auto reap_max_txs(int max) -> std::vector<std::shared_ptr<const types::Tx>> {
+    std::shared_lock g{mtx};
+
+    auto cap = max < 0 ? txs.size() : std::min<size_t>(txs.size(), max);
+
+    std::vector<std::shared_ptr<const types::Tx>> reaped;
+    reaped.reserve(cap);
+    auto& heap = txs.template get<TxPriorityQueue::by_priority>();
+    for (auto it = heap.rbegin(); it != heap.rend() && reaped.size() < cap; ++it) {
+      reaped.emplace_back(*it, &(*it)->tx);
+    }
+    return reaped;
+  }
+
+  /// \brief returns all txs from the highest priority down
+  auto get_txs_by_priority() -> std::vector<std::shared_ptr<WrappedTx>> {
+    std::shared_lock g{mtx};
+
+    auto& heap = txs.template get<TxPriorityQueue::by_priority>();
+    return {heap.rbegin(), heap.rend()};
+  }
+
   auto num_txs() -> int {
     std::shared_lock g{mtx};
     return txs.size();
@@ -8,6 +8,8 @@
 #include <noir/codec/datastream.h>
 #include <noir/crypto/rand.h>
 #include <noir/mempool/cache.h>
+#include <fmt/core.h>
+#include <thread>
 
 using namespace noir;
 using namespace noir::mempool;
@@ -16,7 +18,7 @@ TEST_CASE("CacheBenchmarks", "[noir][mempool]") {
   auto N = 100;
 
   BENCHMARK_ADVANCED("CacheInsertTime")(Catch::Benchmark::Chronometer meter) {
-    auto cache = LRUTxCache(N);
+    auto cache = ClockTxCache(N);
 
     auto txs = std::vector<Bytes>(N);
     for (uint64_t i = 0; i < N; i++) {
@@ -33,7 +35,7 @@ TEST_CASE("CacheBenchmarks", "[noir][mempool]") {
   };
 
   BENCHMARK_ADVANCED("CacheRemoveTime")(Catch::Benchmark::Chronometer meter) {
-    auto cache = LRUTxCache(N);
+    auto cache = ClockTxCache(N);
 
     auto txs = std::vector<Bytes>(N);
     for (uint64_t i = 0; i < N; i++) {
@@ -50,3 +52,43 @@ TEST_CASE("CacheBenchmarks", "[noir][mempool]") {
     });
   };
 }
+
+TEST_CASE("ConcurrentCacheBenchmarks", "[noir][mempool]") {
+  // twice as many txs as the cache holds, so about half of the pushes evict
+  static constexpr int cache_size = 10000;
+  static constexpr int num_txs = 2 * cache_size;
+  static constexpr int ops_per_thread = 50000;
+
+  auto txs = std::vector<Bytes>(num_txs);
+  for (auto& tx : txs) {
+    tx = Bytes(250);
+    crypto::rand_bytes(tx);
+  }
+
+  // each thread pushes a tx (insert or evict), checks it again as a duplicate (lookup), and removes every 8th
+  auto run = [&](ClockTxCache& cache, int num_threads) {
+    auto threads = std::vector<std::thread>();
+    for (auto t = 0; t < num_threads; t++) {
+      threads.emplace_back([&, t]() {
+        for (auto i = 0; i < ops_per_thread; i++) {
+          auto& tx = txs[(i * 7919 + t * 104729) % num_txs];
+          cache.push(tx);
+          cache.push(tx);
+          if (i % 8 == 0) {
+            cache.remove(tx);
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  };
+
+  for (auto num_threads : {1, 4, 16}) {
+    BENCHMARK_ADVANCED(fmt::format("PushLookupRemove_{}Threads", num_threads))(Catch::Benchmark::Chronometer meter) {
+      auto cache = ClockTxCache(cache_size);
+      meter.measure([&] { run(cache, num_threads); });
+    };
+  }
+}
@@ -12,7 +12,7 @@ using namespace noir;
 using namespace noir::mempool;
 
 TEST_CASE("CacheRemove", "[noir][mempool]") {
-  auto cache = LRUTxCache(100);
+  auto cache = ClockTxCache(100);
   auto num_txs = 10;
 
   auto txs = std::vector<Bytes>(num_txs);
@@ -25,11 +25,11 @@ TEST_CASE("CacheRemove", "[noir][mempool]") {
     txs[i] = tx_bytes;
     cache.push(tx_bytes);
 
-    CHECK((i + 1) == cache.tx_keys.size());
+    CHECK((i + 1) == cache.size());
   }
 
   for (auto i = 0; i < num_txs; i++) {
     cache.remove(txs[i]);
-    CHECK((num_txs - (i + 1)) == cache.tx_keys.size());
+    CHECK((num_txs - (i + 1)) == cache.size());
   }
 }
@@ -0,0 +1,64 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#include <catch2/catch_all.hpp>
+
+#include <noir/crypto/rand.h>
+#include <noir/mempool/mempool.h>
+#include <noir/mempool/test/noop_client.h>
+#include <fmt/core.h>
+
+using namespace noir;
+using namespace noir::mempool;
+
+namespace {
+
+auto make_mempool(config::MempoolConfig& config) -> std::unique_ptr<TxMempool<NoopClient>> {
+  auto client = std::make_shared<NoopClient>();
+  return std::make_unique<TxMempool<NoopClient>>(
+    &config, std::make_shared<proxy::AppConnMempool<NoopClient>>(client), 1);
+}
+
+auto make_txs(int count) -> std::vector<types::Tx> {
+  auto txs = std::vector<types::Tx>(count);
+  for (auto& tx : txs) {
+    tx = Bytes(250);
+    crypto::rand_bytes(tx);
+  }
+  return txs;
+}
+
+} // namespace
+
+TEST_CASE("CheckTxBenchmarks", "[noir][mempool]") {
+  static constexpr int num_txs = 10000;
+
+  auto config = config::MempoolConfig();
+  config.cache_size = num_txs;
+  auto txs = make_txs(num_txs);
+
+  // every run gets an empty mempool, as txs in the cache would be rejected without reaching the app
+  BENCHMARK_ADVANCED("CheckTx_OneByOne")(Catch::Benchmark::Chronometer meter) {
+    auto mps = std::vector<std::unique_ptr<TxMempool<NoopClient>>>(meter.runs());
+    std::generate(mps.begin(), mps.end(), [&]() { return make_mempool(config); });
+    meter.measure([&](int run) {
+      for (const auto& tx : txs) {
+        mps[run]->check_txs({&tx, 1}, {});
+      }
+    });
+  };
+
+  for (auto batch_size : {100, 1000, num_txs}) {
+    BENCHMARK_ADVANCED(fmt::format("CheckTxs_Batch{}", batch_size))(Catch::Benchmark::Chronometer meter) {
+      auto mps = std::vector<std::unique_ptr<TxMempool<NoopClient>>>(meter.runs());
+      std::generate(mps.begin(), mps.end(), [&]() { return make_mempool(config); });
+      meter.measure([&](int run) {
+        for (auto i = 0; i < num_txs; i += batch_size) {
+          mps[run]->check_txs(std::span(txs).subspan(i, batch_size), {});
+        }
+      });
+    };
+  }
+}
@@ -0,0 +1,71 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#include <catch2/catch_all.hpp>
+
+#include <noir/crypto/rand.h>
+#include <noir/mempool/mempool.h>
+#include <noir/mempool/test/noop_client.h>
+#include <fmt/core.h>
+
+using namespace noir;
+using namespace noir::mempool;
+
+TEST_CASE("JournalBenchmarks", "[noir][mempool]") {
+  static constexpr int num_txs = 100000;
+
+  auto dir = std::filesystem::temp_directory_path() / "noir_mempool_journal_bench";
+  std::filesystem::remove_all(dir);
+
+  auto config = config::MempoolConfig();
+  config.root_dir = dir.string();
+  config.journal_path = "journal";
+  config.size = num_txs;
+  config.cache_size = num_txs;
+
+  {
+    auto journal = TxJournal::open(dir / config.journal_path);
+    REQUIRE(journal);
+    for (auto i = 0; i < num_txs; i++) {
+      auto tx = Bytes(250);
+      crypto::rand_bytes(tx);
+      auto entry = TxJournal::Entry{
+        .tx = tx,
+        .hash = types::Tx(tx).key(),
+        .height = 1,
+        .gas_wanted = 1,
+        .priority = i % 1000,
+        .sender = i % 2 ? fmt::format("sender{}", i) : "",
+        .timestamp = i,
+      };
+      REQUIRE((*journal)->append(entry));
+    }
+    std::cout << fmt::format("journal of {} txs: {} bytes", num_txs, (*journal)->used_bytes()) << std::endl;
+  }
+
+  BENCHMARK("Journal_Load") {
+    return (*TxJournal::open(dir / config.journal_path))->load().size();
+  };
+
+  // restores into an empty mempool each run, including the recheck of every restored tx
+  BENCHMARK_ADVANCED("Mempool_Restore")(Catch::Benchmark::Chronometer meter) {
+    auto mps = std::vector<std::unique_ptr<TxMempool<NoopClient>>>(meter.runs());
+    std::generate(mps.begin(), mps.end(), [&]() {
+      return std::make_unique<TxMempool<NoopClient>>(
+        &config, std::make_shared<proxy::AppConnMempool<NoopClient>>(std::make_shared<NoopClient>()), 1);
+    });
+    meter.measure([&](int run) { return mps[run]->open_journal(); });
+  };
+
+  auto mp = TxMempool<NoopClient>(
+    &config, std::make_shared<proxy::AppConnMempool<NoopClient>>(std::make_shared<NoopClient>()), 1);
+  auto restored = mp.open_journal();
+  CHECK(restored);
+  CHECK(restored.value() == num_txs);
+  CHECK(mp.size() == num_txs);
+  CHECK(mp.get_metrics().last_recheck_txs == num_txs);
+
+  std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,152 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#include <catch2/catch_all.hpp>
+#include <noir/crypto/rand.h>
+#include <noir/mempool/journal.h>
+#include <fstream>
+#include <thread>
+
+using namespace noir;
+using namespace noir::mempool;
+
+namespace {
+
+auto make_entry(int64_t priority, const std::string& sender = "") -> TxJournal::Entry {
+  auto tx = Bytes(100);
+  crypto::rand_bytes(tx);
+  return {
+    .tx = tx,
+    .hash = types::Tx(tx).key(),
+    .height = 1,
+    .gas_wanted = 10,
+    .priority = priority,
+    .sender = sender,
+    .timestamp = 12345,
+  };
+}
+
+void check_entry(const TxJournal::Entry& actual, const TxJournal::Entry& expected) {
+  CHECK(actual.tx == expected.tx);
+  CHECK(actual.hash == expected.hash);
+  CHECK(actual.height == expected.height);
+  CHECK(actual.gas_wanted == expected.gas_wanted);
+  CHECK(actual.priority == expected.priority);
+  CHECK(actual.sender == expected.sender);
+  CHECK(actual.timestamp == expected.timestamp);
+}
+
+} // namespace
+
+TEST_CASE("TxJournal: Reopen", "[noir][mempool]") {
+  auto dir = std::filesystem::temp_directory_path() / "noir_mempool_journal_test";
+  std::filesystem::remove_all(dir);
+  auto path = dir / "journal";
+
+  auto entries = std::vector<TxJournal::Entry>();
+  for (auto i = 0; i < 100; i++) {
+    entries.push_back(make_entry(i, i % 2 ? "sender" + std::to_string(i) : ""));
+  }
+
+  {
+    auto journal = TxJournal::open(path);
+    REQUIRE(journal);
+    for (const auto& entry : entries) {
+      CHECK((*journal)->append(entry));
+    }
+    for (auto i = 0; i < 100; i += 3) {
+      CHECK((*journal)->remove(entries[i].hash));
+    }
+    CHECK((*journal)->sync());
+  }
+
+  SECTION("Load live txs in order") {
+    auto journal = TxJournal::open(path);
+    REQUIRE(journal);
+    auto loaded = (*journal)->load();
+    CHECK(loaded.size() == 66);
+    CHECK((*journal)->size() == 66);
+    auto it = loaded.begin();
+    for (auto i = 0; i < 100; i++) {
+      if (i % 3) {
+        check_entry(*it++, entries[i]);
+      }
+    }
+  }
+
+  SECTION("Compact") {
+    auto journal = TxJournal::open(path);
+    REQUIRE(journal);
+    auto used = (*journal)->used_bytes();
+    CHECK((*journal)->compact());
+    CHECK((*journal)->used_bytes() < used);
+    CHECK((*journal)->compactions() == 1);
+
+    auto extra = make_entry(1000);
+    CHECK((*journal)->append(extra));
+    journal = TxJournal::open(path);
+    REQUIRE(journal);
+    auto loaded = (*journal)->load();
+    CHECK(loaded.size() == 67);
+    check_entry(loaded.front(), entries[1]);
+    check_entry(loaded.back(), extra);
+  }
+
+  SECTION("Stop at a torn record") {
+    auto used = uint64_t(0);
+    {
+      auto journal = TxJournal::open(path);
+      REQUIRE(journal);
+      used = (*journal)->used_bytes();
+    }
+    // corrupts the last byte of the last record
+    {
+      auto file = std::fstream(path, std::ios::binary | std::ios::in | std::ios::out);
+      file.seekp(used - 1);
+      file.put(0x5a);
+    }
+    auto journal = TxJournal::open(path);
+    REQUIRE(journal);
+    // the removal of entries[99] is lost along with the record
+    CHECK((*journal)->used_bytes() < used);
+    CHECK((*journal)->load().size() == 67);
+
+    auto extra = make_entry(1000);
+    CHECK((*journal)->append(extra));
+    journal = TxJournal::open(path);
+    REQUIRE(journal);
+    CHECK((*journal)->load().back().hash == extra.hash);
+  }
+
+  std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("TxJournal: Compact in background", "[noir][mempool]") {
+  auto dir = std::filesystem::temp_directory_path() / "noir_mempool_journal_compact_test";
+  std::filesystem::remove_all(dir);
+  auto path = dir / "journal";
+
+  {
+    auto journal = TxJournal::open(path, 4096);
+    REQUIRE(journal);
+    auto kept = make_entry(0);
+    CHECK((*journal)->append(kept));
+    for (auto i = 0; i < 100; i++) {
+      auto entry = make_entry(i);
+      CHECK((*journal)->append(entry));
+      CHECK((*journal)->remove(entry.hash));
+    }
+    for (auto i = 0; i < 100 && !(*journal)->compactions(); i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    CHECK((*journal)->compactions() > 0);
+    CHECK((*journal)->size() == 1);
+  }
+
+  auto journal = TxJournal::open(path);
+  REQUIRE(journal);
+  CHECK((*journal)->load().size() == 1);
+  std::filesystem::remove_all(dir);
+}
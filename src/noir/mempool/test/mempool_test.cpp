@@ -7,12 +7,320 @@
 
 #include <tendermint/abci/client/socket_client.h>
 
+#include <noir/crypto/rand.h>
 #include <noir/mempool/mempool.h>
+#include <noir/mempool/test/noop_client.h>
 #include <noir/net/tcp_conn.h>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <limits>
+#include <thread>
 
 using namespace noir;
 using namespace noir::mempool;
 
+namespace {
+
+/// answers flushed check_tx requests from its own thread, oldest first, but only while window requests are waiting for
+/// a response, so that a recheck which keeps to its in-flight window always gets exactly window requests outstanding
+class WindowedClient : public NoopClient {
+public:
+  explicit WindowedClient(size_t window): window(window), thread([this]() { run(); }) {}
+
+  ~WindowedClient() {
+    {
+      std::scoped_lock _{mtx};
+      stopped = true;
+    }
+    cv.notify_all();
+    thread.join();
+  }
+
+  AsyncResult check_tx_async(const abci::RequestCheckTx& req) {
+    auto reqres = std::make_shared<abci::ReqRes>();
+    reqres->request = abci::to_request_check_tx(req);
+    reqres->response = std::make_unique<abci::Response>();
+    reqres->response->mutable_check_tx();
+    {
+      std::scoped_lock _{mtx};
+      if (req.type() == abci::CheckTxType::RECHECK) {
+        rechecked.push_back(types::Tx(Bytes(std::vector<unsigned char>(req.tx().begin(), req.tx().end()))).key());
+      }
+      unflushed.push_back(reqres);
+      outstanding++;
+      max_outstanding = std::max(max_outstanding, outstanding);
+    }
+    cv.notify_all();
+    if (on_check_tx) {
+      on_check_tx();
+    }
+    return reqres;
+  }
+
+  AsyncResult flush_async() {
+    {
+      std::scoped_lock _{mtx};
+      flushes++;
+      flushed.insert(flushed.end(), unflushed.begin(), unflushed.end());
+      unflushed.clear();
+    }
+    cv.notify_all();
+    auto reqres = std::make_shared<abci::ReqRes>();
+    reqres->done();
+    return reqres;
+  }
+
+  auto get_rechecked() {
+    std::scoped_lock _{mtx};
+    return rechecked;
+  }
+
+  size_t window;
+  size_t max_outstanding = 0;
+  std::function<void()> on_check_tx;
+
+private:
+  void run() {
+    std::unique_lock lock{mtx};
+    for (;;) {
+      cv.wait(lock, [&]() { return stopped || (outstanding >= window && !flushed.empty()); });
+      if (stopped) {
+        return;
+      }
+      auto reqres = std::move(flushed.front());
+      flushed.pop_front();
+      outstanding--;
+      lock.unlock();
+      reqres->done();
+      lock.lock();
+    }
+  }
+
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::deque<std::shared_ptr<abci::ReqRes>> unflushed;
+  std::deque<std::shared_ptr<abci::ReqRes>> flushed;
+  std::vector<types::TxKey> rechecked;
+  size_t outstanding = 0;
+  bool stopped = false;
+  std::thread thread;
+};
+
+/// fails every check_tx once max_sends requests have been sent, as a client whose connection to the app was lost
+class FailingClient : public NoopClient {
+public:
+  AsyncResult check_tx_async(const abci::RequestCheckTx& req) {
+    if (num_sends >= max_sends) {
+      return Error("connection lost");
+    }
+    num_sends++;
+    return NoopClient::check_tx_async(req);
+  }
+
+  int max_sends = std::numeric_limits<int>::max();
+  int num_sends = 0;
+};
+
+auto make_txs(int count) -> std::vector<types::Tx> {
+  auto txs = std::vector<types::Tx>(count);
+  for (auto& tx : txs) {
+    tx = Bytes(250);
+    crypto::rand_bytes(tx);
+  }
+  return txs;
+}
+
+/// writes a journal of num_txs txs with distinct priorities and points config at it
+auto make_journal(config::MempoolConfig& config, int num_txs) -> std::vector<TxJournal::Entry> {
+  auto dir = std::filesystem::temp_directory_path() / "noir_mempool_test";
+  std::filesystem::remove_all(dir);
+  config.root_dir = dir.string();
+  config.journal_path = "journal";
+
+  auto entries = std::vector<TxJournal::Entry>();
+  auto journal = TxJournal::open(dir / config.journal_path);
+  REQUIRE(journal);
+  for (auto i = 0; i < num_txs; i++) {
+    auto tx = Bytes(100);
+    crypto::rand_bytes(tx);
+    auto& entry = entries.emplace_back(TxJournal::Entry{
+      .tx = tx,
+      .hash = types::Tx(tx).key(),
+      .height = 1,
+      .gas_wanted = 1,
+      .priority = i,
+      .timestamp = i,
+    });
+    REQUIRE((*journal)->append(entry));
+  }
+  return entries;
+}
+
+/// opens the journal without a recheck, so that the next update starts the first recheck
+template<typename Client>
+auto make_mempool(config::MempoolConfig& config, const std::shared_ptr<Client>& client) {
+  auto mp = std::make_unique<TxMempool<Client>>(&config, std::make_shared<proxy::AppConnMempool<Client>>(client), 1);
+  auto recheck = std::exchange(config.recheck, false);
+  REQUIRE(mp->open_journal());
+  config.recheck = recheck;
+  return mp;
+}
+
+} // namespace
+
 TEST_CASE("mempool: ", "[noir][mempool]") {
   auto mp = TxMempool<abci::SocketClient<net::TcpConn>>();
 }
+
+TEST_CASE("mempool: check_txs", "[noir][mempool]") {
+  auto config = config::MempoolConfig();
+  auto client = std::make_shared<FailingClient>();
+  auto mp = TxMempool<FailingClient>(&config, std::make_shared<proxy::AppConnMempool<FailingClient>>(client), 1);
+
+  auto txs = make_txs(10);
+  txs.push_back(txs[0]);
+  txs.push_back(Bytes(config.max_tx_bytes + 1));
+
+  SECTION("batch") {
+    auto results = mp.check_txs(txs, {});
+    CHECK(results.size() == 12);
+    for (auto i = 0; i < 10; i++) {
+      CHECK(results[i]);
+      CHECK(results[i].value()->response->has_check_tx());
+    }
+    // repeated within the batch
+    CHECK(!results[10]);
+    CHECK(!results[11]);
+    CHECK(client->flushes == 1);
+
+    // seen in an earlier batch
+    results = mp.check_txs(std::span(txs).first(1), {});
+    CHECK(!results[0]);
+    CHECK(client->flushes == 1);
+  }
+
+  SECTION("app connection error") {
+    client->max_sends = 0;
+    auto results = mp.check_txs(txs, {});
+    for (const auto& result : results) {
+      CHECK(!result);
+    }
+
+    // the failed txs were not left in the cache
+    client->max_sends = std::numeric_limits<int>::max();
+    results = mp.check_txs(std::span(txs).first(10), {});
+    for (const auto& result : results) {
+      CHECK(result);
+    }
+  }
+
+  SECTION("app connection lost in the middle of a batch") {
+    client->max_sends = 4;
+    auto results = mp.check_txs(txs, {});
+    for (auto i = 0; i < 4; i++) {
+      CHECK(results[i]);
+    }
+    for (auto i = 4; i < 10; i++) {
+      CHECK(!results[i]);
+    }
+    CHECK(client->flushes == 1);
+
+    // only the txs that were not sent may be sent again
+    client->max_sends = std::numeric_limits<int>::max();
+    results = mp.check_txs(std::span(txs).first(10), {});
+    for (auto i = 0; i < 4; i++) {
+      CHECK(!results[i]);
+    }
+    for (auto i = 4; i < 10; i++) {
+      CHECK(results[i]);
+    }
+  }
+}
+
+TEST_CASE("mempool: update", "[noir][mempool]") {
+  auto config = config::MempoolConfig();
+  auto entries = make_journal(config, 100);
+  auto client = std::make_shared<NoopClient>();
+  auto mp = make_mempool(config, client);
+  REQUIRE(mp->size() == 100);
+
+  auto block_txs = std::vector<types::Tx>();
+  auto responses = std::vector<abci::ResponseDeliverTx>(10);
+  for (auto i = 0; i < 10; i++) {
+    block_txs.emplace_back(entries[i].tx);
+  }
+  responses[9].set_code(1);
+  CHECK(!mp->update(2, block_txs, std::span(responses).first(9)));
+  CHECK(mp->size() == 100);
+
+  CHECK(mp->update(2, block_txs, responses));
+  CHECK(mp->size() == 90);
+  CHECK(mp->get_metrics().recheck_times == 1);
+  CHECK(mp->get_metrics().last_recheck_txs == 90);
+
+  // committed txs stay in the cache, but a failed one may be sent again
+  auto results = mp->check_txs(block_txs, {});
+  for (auto i = 0; i < 9; i++) {
+    CHECK(!results[i]);
+  }
+  CHECK(results[9]);
+}
+
+TEST_CASE("mempool: recheck flush batching", "[noir][mempool]") {
+  auto config = config::MempoolConfig();
+  config.recheck_batch_size = 8;
+  make_journal(config, 100);
+  auto client = std::make_shared<NoopClient>();
+  auto mp = make_mempool(config, client);
+
+  auto flushes = client->flushes;
+  CHECK(mp->update(2, {}, {}));
+  CHECK(mp->get_metrics().last_recheck_txs == 100);
+  // one flush per batch, including the last partial one
+  CHECK(client->flushes - flushes == 13);
+}
+
+TEST_CASE("mempool: recheck in-flight window", "[noir][mempool]") {
+  auto config = config::MempoolConfig();
+  config.recheck_window = 8;
+  config.recheck_batch_size = 3;
+  auto entries = make_journal(config, 100);
+  auto client = std::make_shared<WindowedClient>(config.recheck_window);
+  auto mp = make_mempool(config, client);
+
+  CHECK(mp->update(2, {}, {}));
+  CHECK(mp->get_metrics().last_recheck_txs == 100);
+  CHECK(client->max_outstanding == size_t(config.recheck_window));
+
+  // txs are rechecked from the highest priority down
+  auto rechecked = client->get_rechecked();
+  REQUIRE(rechecked.size() == 100);
+  for (auto i = 0; i < 100; i++) {
+    CHECK(rechecked[i] == entries[99 - i].hash);
+  }
+}
+
+TEST_CASE("mempool: recheck cancellation", "[noir][mempool]") {
+  auto config = config::MempoolConfig();
+  make_journal(config, 100);
+  auto client = std::make_shared<WindowedClient>(config.recheck_window);
+  auto mp = make_mempool(config, client);
+
+  // a new block arriving in the middle of a recheck
+  client->on_check_tx = [&]() {
+    if (client->get_rechecked().size() == 10) {
+      mp->cancel_re_check_txs();
+    }
+  };
+  CHECK(mp->update(2, {}, {}));
+  CHECK(client->get_rechecked().size() == 10);
+  CHECK(mp->get_metrics().recheck_cancels == 1);
+  CHECK(mp->get_metrics().last_recheck_txs == 10);
+
+  // the next recheck runs in full
+  client->on_check_tx = nullptr;
+  CHECK(mp->update(3, {}, {}));
+  CHECK(mp->get_metrics().recheck_cancels == 1);
+  CHECK(mp->get_metrics().last_recheck_txs == 100);
+}
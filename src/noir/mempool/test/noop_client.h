@@ -0,0 +1,131 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#pragma once
+#include <noir/application/noop_app.h>
+#include <noir/core/core.h>
+#include <tendermint/abci/client/client.h>
+#include <tendermint/abci/types/messages.h>
+
+namespace noir::mempool {
+
+/// answers check_tx in process through noop_app, so benchmarks measure the mempool and client overhead only
+class NoopClient {
+public:
+  using AsyncResult = Result<std::shared_ptr<abci::ReqRes>>;
+  template<typename T>
+  using SyncResult = Result<std::unique_ptr<T>>;
+
+  void set_response_callback(abci::Callback cb) {}
+  Result<void> error() {
+    return success();
+  }
+
+  AsyncResult check_tx_async(const abci::RequestCheckTx& req) {
+    auto reqres = std::make_shared<abci::ReqRes>();
+    reqres->request = abci::to_request_check_tx(req);
+    reqres->response = std::make_unique<abci::Response>();
+    if (auto res = app.check_tx_async(); res) {
+      reqres->response->mutable_check_tx()->Swap(res.get());
+    } else {
+      reqres->response->mutable_check_tx();
+    }
+    reqres->done();
+    reqres->invoke_callback();
+    return reqres;
+  }
+  AsyncResult flush_async() {
+    flushes++;
+    auto reqres = std::make_shared<abci::ReqRes>();
+    reqres->done();
+    return reqres;
+  }
+  Result<void> flush_sync() {
+    flushes++;
+    return success();
+  }
+
+  AsyncResult echo_async(const std::string&) {
+    return Error("not implemented");
+  }
+  AsyncResult info_async(const abci::RequestInfo&) {
+    return Error("not implemented");
+  }
+  AsyncResult deliver_tx_async(const abci::RequestDeliverTx&) {
+    return Error("not implemented");
+  }
+  AsyncResult query_async(const abci::RequestQuery&) {
+    return Error("not implemented");
+  }
+  AsyncResult commit_async() {
+    return Error("not implemented");
+  }
+  AsyncResult init_chain_async(const abci::RequestInitChain&) {
+    return Error("not implemented");
+  }
+  AsyncResult begin_block_async(const abci::RequestBeginBlock&) {
+    return Error("not implemented");
+  }
+  AsyncResult end_block_async(const abci::RequestEndBlock&) {
+    return Error("not implemented");
+  }
+  AsyncResult list_snapshots_async(const abci::RequestListSnapshots&) {
+    return Error("not implemented");
+  }
+  AsyncResult offer_snapshot_async(const abci::RequestOfferSnapshot&) {
+    return Error("not implemented");
+  }
+  AsyncResult load_snapshot_chunk_async(const abci::RequestLoadSnapshotChunk&) {
+    return Error("not implemented");
+  }
+  AsyncResult apply_snapshot_chunk_async(const abci::RequestApplySnapshotChunk&) {
+    return Error("not implemented");
+  }
+
+  SyncResult<abci::ResponseEcho> echo_sync(const std::string&) {
+    return Error("not implemented");
+  }
+  SyncResult<abci::ResponseInfo> info_sync(const abci::RequestInfo&) {
+    return Error("not implemented");
+  }
+  SyncResult<abci::ResponseDeliverTx> deliver_tx_sync(const abci::RequestDeliverTx&) {
+    return Error("not implemented");
+  }
+  SyncResult<abci::ResponseCheckTx> check_tx_sync(const abci::RequestCheckTx&) {
+    return Error("not implemented");
+  }
+  SyncResult<abci::ResponseQuery> query_sync(const abci::RequestQuery&) {
+    return Error("not implemented");
+  }
+  SyncResult<abci::ResponseCommit> commit_sync() {
+    return Error("not implemented");
+  }
+  SyncResult<abci::ResponseInitChain> init_chain_sync(const abci::RequestInitChain&) {
+    return Error("not implemented");
+  }
+  SyncResult<abci::ResponseBeginBlock> begin_block_sync(const abci::RequestBeginBlock&) {
+    return Error("not implemented");
+  }
+  SyncResult<abci::ResponseEndBlock> end_block_sync(const abci::RequestEndBlock&) {
+    return Error("not implemented");
+  }
+  SyncResult<abci::ResponseListSnapshots> list_snapshots_sync(const abci::RequestListSnapshots&) {
+    return Error("not implemented");
+  }
+  SyncResult<abci::ResponseOfferSnapshot> offer_snapshot_sync(const abci::RequestOfferSnapshot&) {
+    return Error("not implemented");
+  }
+  SyncResult<abci::ResponseLoadSnapshotChunk> load_snapshot_chunk_sync(const abci::RequestLoadSnapshotChunk&) {
+    return Error("not implemented");
+  }
+  SyncResult<abci::ResponseApplySnapshotChunk> apply_snapshot_chunk_sync(const abci::RequestApplySnapshotChunk&) {
+    return Error("not implemented");
+  }
+
+  application::noop_app app;
+  int flushes = 0;
+};
+
+} // namespace noir::mempool
@@ -183,4 +183,69 @@ TEST_CASE("TxPriorityQueue", "[noir][mempool]") {
     // XXX: remove_tx with heap_index out of range is unsupported
     // pq.remove_tx(...);
   }
+
+  SECTION("ReapMaxBytesMaxGas") {
+    auto pq = TxPriorityQueue();
+    auto num_txs = 100;
+
+    // tx i has priority i and gas i, and takes 1 + 1 + 10 bytes in proto
+    for (auto i = 1; i <= num_txs; i++) {
+      auto tx = Bytes(10);
+      CHECK(crypto::rand_bytes(tx));
+      pq.push_tx(std::make_shared<WrappedTx>(WrappedTx{
+        .tx = tx,
+        .gas_wanted = i,
+        .priority = i,
+      }));
+    }
+
+    auto reaped = pq.reap_max_bytes_max_gas(-1, -1);
+    CHECK(reaped.size() == num_txs);
+    CHECK(types::compute_proto_size_for_txs({reaped.front().get(), 1}) == 12);
+
+    CHECK(pq.reap_max_bytes_max_gas(12 * 5, -1).size() == 5);
+    CHECK(pq.reap_max_bytes_max_gas(12 * 5 - 1, -1).size() == 4);
+    CHECK(pq.reap_max_bytes_max_gas(-1, 100 + 99 + 98).size() == 3);
+    CHECK(pq.reap_max_bytes_max_gas(-1, 99).size() == 0);
+    CHECK(pq.reap_max_bytes_max_gas(12 * 5, 100 + 99).size() == 2);
+    CHECK(pq.reap_max_bytes_max_gas(0, 0).empty());
+
+    // reaping leaves the queue as is and hands out the stored txs
+    CHECK(pq.num_txs() == num_txs);
+    auto top = pq.pop_tx();
+    CHECK(reaped.front().get() == &top->tx);
+  }
+
+  SECTION("ReapMaxTxs") {
+    auto pq = TxPriorityQueue();
+    for (auto i = 1; i <= 10; i++) {
+      pq.push_tx(std::make_shared<WrappedTx>(WrappedTx{
+        .tx = Bytes{static_cast<unsigned char>(i)},
+        .priority = i,
+      }));
+    }
+
+    CHECK(pq.reap_max_txs(-1).size() == 10);
+    CHECK(pq.reap_max_txs(20).size() == 10);
+    CHECK(pq.reap_max_txs(0).empty());
+    auto reaped = pq.reap_max_txs(3);
+    CHECK(reaped.size() == 3);
+    CHECK((*reaped[0])[0] == 10);
+    CHECK((*reaped[2])[0] == 8);
+    CHECK(pq.num_txs() == 10);
+  }
+
+  SECTION("GetTxsByPriority") {
+    auto pq = TxPriorityQueue();
+    for (auto i : {3, 1, 4, 5, 2}) {
+      pq.push_tx(std::make_shared<WrappedTx>(WrappedTx{.priority = i}));
+    }
+
+    auto txs = pq.get_txs_by_priority();
+    CHECK(txs.size() == 5);
+    for (auto i = 0; i < txs.size(); i++) {
+      CHECK(txs[i]->priority == 5 - i);
+    }
+    CHECK(pq.num_txs() == 5);
+  }
 }
@@ -0,0 +1,48 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#include <catch2/catch_all.hpp>
+
+#include <noir/crypto/rand.h>
+#include <noir/mempool/priority_queue.h>
+#include <fmt/core.h>
+#include <random>
+
+using namespace noir;
+using namespace noir::mempool;
+
+TEST_CASE("ReapBenchmarks", "[noir][mempool]") {
+  static constexpr int num_txs = 100000;
+  static constexpr int tx_size = 250;
+
+  auto pq = TxPriorityQueue();
+  auto gen = std::mt19937(1);
+  auto rng = std::uniform_int_distribution<>(0, 999999);
+  for (auto i = 0; i < num_txs; i++) {
+    auto tx = Bytes(tx_size);
+    crypto::rand_bytes(tx);
+    pq.push_tx(std::make_shared<WrappedTx>(WrappedTx{
+      .tx = tx,
+      .gas_wanted = 1,
+      .priority = rng(gen),
+      .timestamp = i,
+    }));
+  }
+
+  // a block of the default 21MB max bytes fits about 87k of these txs, and 1MB about 4k
+  for (int64_t max_bytes : {1024 * 1024, 22020096}) {
+    BENCHMARK(fmt::format("ReapMaxBytesMaxGas_{}", max_bytes)) {
+      return pq.reap_max_bytes_max_gas(max_bytes, -1);
+    };
+  }
+
+  BENCHMARK("ReapMaxBytesMaxGas_Unbounded") {
+    return pq.reap_max_bytes_max_gas(-1, -1);
+  };
+
+  BENCHMARK("ReapMaxTxs_5000") {
+    return pq.reap_max_txs(5000);
+  };
+}
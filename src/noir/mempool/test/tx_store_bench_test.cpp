@@ -0,0 +1,66 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#include <catch2/catch_all.hpp>
+
+#include <noir/crypto/rand.h>
+#include <noir/mempool/tx.h>
+#include <fmt/core.h>
+#include <thread>
+
+using namespace noir;
+using namespace noir::mempool;
+
+namespace {
+
+auto make_txs(int count, int num_senders) -> std::vector<std::shared_ptr<WrappedTx>> {
+  auto wtxs = std::vector<std::shared_ptr<WrappedTx>>();
+  wtxs.reserve(count);
+  for (auto i = 0; i < count; i++) {
+    auto tx = Bytes(250);
+    crypto::rand_bytes(tx);
+    wtxs.push_back(std::make_shared<WrappedTx>(WrappedTx{
+      .tx = tx,
+      .priority = i,
+      .sender = fmt::format("sender_{}", i % num_senders),
+      .timestamp = i,
+    }));
+  }
+  return wtxs;
+}
+
+/// each thread admits its own slice of txs the way check_tx does: lookup by hash, insert, then record the peer
+void admit(TxStore& store, const std::vector<std::shared_ptr<WrappedTx>>& wtxs, int num_threads) {
+  auto threads = std::vector<std::thread>();
+  for (auto t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t]() {
+      for (auto i = size_t(t); i < wtxs.size(); i += num_threads) {
+        auto& wtx = wtxs[i];
+        if (!store.get_tx_by_hash(wtx->tx.key())) {
+          store.set_tx(wtx);
+        }
+        store.get_or_set_peer_by_tx_hash(wtx->hash, t);
+        store.get_tx_by_sender(wtx->sender);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+} // namespace
+
+TEST_CASE("TxStoreBenchmarks", "[noir][mempool]") {
+  static constexpr int num_txs = 100000;
+  auto wtxs = make_txs(num_txs, 10000);
+
+  for (auto num_threads : {1, 4, 16}) {
+    BENCHMARK_ADVANCED(fmt::format("Admit_{}Threads", num_threads))(Catch::Benchmark::Chronometer meter) {
+      auto stores = std::vector<TxStore>(meter.runs());
+      meter.measure([&](int i) { admit(stores[i], wtxs, num_threads); });
+    };
+  }
+}
@@ -122,6 +122,39 @@ TEST_CASE("TxStore", "[noir][mempool]") {
     CHECK(!res);
   }
 
+  SECTION("ReplaceTxBySender") {
+    auto txs = TxStore();
+    auto wtx1 = std::make_shared<WrappedTx>(WrappedTx{
+      .tx = Bytes(std::span("test_tx_1")),
+      .priority = 1,
+      .sender = "foo",
+      .timestamp = std::chrono::system_clock::now().time_since_epoch().count(),
+    });
+    auto wtx2 = std::make_shared<WrappedTx>(WrappedTx{
+      .tx = Bytes(std::span("test_tx_2")),
+      .priority = 2,
+      .sender = "foo",
+      .timestamp = std::chrono::system_clock::now().time_since_epoch().count(),
+    });
+
+    txs.set_tx(wtx1);
+    txs.set_tx(wtx1);
+    CHECK(txs.size() == 1);
+
+    txs.set_tx(wtx2);
+    CHECK(txs.get_tx_by_sender("foo") == wtx2);
+
+    // removing the replaced tx keeps the sender pointing at the newer one
+    txs.remove_tx(wtx1);
+    CHECK(wtx1->removed);
+    CHECK(txs.get_tx_by_sender("foo") == wtx2);
+    CHECK(txs.size() == 1);
+
+    txs.remove_tx(wtx2);
+    CHECK(!txs.get_tx_by_sender("foo"));
+    CHECK(txs.size() == 0);
+  }
+
   SECTION("Size") {
     auto tx_store = TxStore();
     auto num_txs = 1000;
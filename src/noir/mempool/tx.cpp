@@ -4,7 +4,7 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 //
 #include <noir/mempool/tx.h>
-#include <range/v3/view/enumerate.hpp>
+#include <cstring>
 #include <mutex>
 
 namespace noir::mempool {
@@ -21,16 +21,32 @@ auto WrappedTx::ptr() -> WrappedTx* {
   return this;
 }
 
+auto TxStore::TxKeyHash::operator()(const types::TxKey& key) const -> size_t {
+  size_t h;
+  std::memcpy(&h, key.data() + 8, sizeof(h)); // bytes 0-7 pick the shard
+  return h;
+}
+
+auto TxStore::hash_shard(const types::TxKey& hash) -> HashShard& {
+  return hash_shards[hash[0] % num_shards];
+}
+
+auto TxStore::sender_shard(const std::string& sender) -> SenderShard& {
+  return sender_shards[std::hash<std::string>{}(sender) % num_shards];
+}
+
 auto TxStore::size() -> int {
-  std::shared_lock g{mtx};
-  return txs.size();
+  return num_txs.load();
 }
 
 auto TxStore::get_all_txs() -> std::vector<std::shared_ptr<WrappedTx>> {
-  std::shared_lock g{mtx};
-  auto wtxs = std::vector<std::shared_ptr<WrappedTx>>(txs.size());
-  for (auto [i, wtx] : ranges::views::enumerate(txs.get<TxStore::by_key>())) {
-    wtxs[i] = wtx;
+  auto wtxs = std::vector<std::shared_ptr<WrappedTx>>();
+  wtxs.reserve(size());
+  for (auto& shard : hash_shards) {
+    std::shared_lock g{shard.mtx};
+    for (const auto& [_, wtx] : shard.txs) {
+      wtxs.push_back(wtx);
+    }
   }
   return wtxs;
 }
@@ -40,70 +56,94 @@ auto TxStore::get_tx_by_sender(const std::string& sender) -> std::shared_ptr<Wra
   if (sender.empty()) {
     return nullptr;
   }
-  std::shared_lock g{mtx};
-  auto& sender_txs = txs.get<TxStore::by_sender>();
-  if (auto wtx = sender_txs.find(sender); wtx != sender_txs.end()) {
-    return *wtx;
+  auto& shard = sender_shard(sender);
+  std::shared_lock g{shard.mtx};
+  if (auto wtx = shard.txs.find(sender); wtx != shard.txs.end()) {
+    return wtx->second;
   }
   return nullptr;
 }
 
 auto TxStore::get_tx_by_hash(const types::TxKey& hash) -> std::shared_ptr<WrappedTx> {
-  std::shared_lock g{mtx};
-  auto& hash_txs = txs.get<TxStore::by_key>();
-  if (auto wtx = hash_txs.find(hash); wtx != hash_txs.end()) {
-    return *wtx;
+  auto& shard = hash_shard(hash);
+  std::shared_lock g{shard.mtx};
+  if (auto wtx = shard.txs.find(hash); wtx != shard.txs.end()) {
+    return wtx->second;
   }
   return nullptr;
 }
 
 auto TxStore::is_tx_removed(const types::TxKey& hash) -> bool {
-  std::shared_lock g{mtx};
-  auto& hash_txs = txs.get<TxStore::by_key>();
-  if (auto wtx = hash_txs.find(hash); wtx != hash_txs.end()) {
-    return (*wtx)->removed;
+  auto& shard = hash_shard(hash);
+  std::shared_lock g{shard.mtx};
+  if (auto wtx = shard.txs.find(hash); wtx != shard.txs.end()) {
+    return wtx->second->removed;
   }
   return false;
 }
 
 void TxStore::set_tx(const std::shared_ptr<WrappedTx>& wtx) {
-  std::unique_lock g{mtx};
-  txs.insert(wtx);
+  wtx->hash = wtx->key();
+  {
+    auto& shard = hash_shard(wtx->hash);
+    std::unique_lock g{shard.mtx};
+    if (auto [it, inserted] = shard.txs.insert_or_assign(wtx->hash, wtx); inserted) {
+      num_txs++;
+    }
+  }
+  if (!wtx->sender.empty()) {
+    auto& shard = sender_shard(wtx->sender);
+    std::unique_lock g{shard.mtx};
+    shard.txs.insert_or_assign(wtx->sender, wtx);
+  }
 }
 
 void TxStore::remove_tx(const std::shared_ptr<WrappedTx>& wtx) {
-  std::unique_lock g{mtx};
-  txs.erase(wtx->tx.key());
-  wtx->removed = true;
+  {
+    auto& shard = hash_shard(wtx->hash);
+    std::unique_lock g{shard.mtx};
+    if (shard.txs.erase(wtx->hash)) {
+      num_txs--;
+    }
+    wtx->removed = true;
+  }
+  if (!wtx->sender.empty()) {
+    auto& shard = sender_shard(wtx->sender);
+    std::unique_lock g{shard.mtx};
+    // the sender may already have been taken over by a newer tx
+    if (auto it = shard.txs.find(wtx->sender); it != shard.txs.end() && it->second == wtx) {
+      shard.txs.erase(it);
+    }
+  }
 }
 
 auto TxStore::tx_has_peer(const types::TxKey& hash, uint16_t peer_id) -> bool {
-  std::shared_lock g{mtx};
+  auto& shard = hash_shard(hash);
+  std::shared_lock g{shard.mtx};
 
-  auto& hash_txs = txs.get<TxStore::by_key>();
-  auto wtx = hash_txs.find(hash);
-  if (wtx == hash_txs.end()) {
+  auto wtx = shard.txs.find(hash);
+  if (wtx == shard.txs.end()) {
     return false;
   }
-  return (*wtx)->peers.contains(peer_id);
+  return wtx->second->peers.contains(peer_id);
 }
 
 auto TxStore::get_or_set_peer_by_tx_hash(const types::TxKey& hash, uint16_t peer_id)
   -> std::pair<std::shared_ptr<WrappedTx>, bool> {
-  std::unique_lock g{mtx};
+  auto& shard = hash_shard(hash);
+  std::unique_lock g{shard.mtx};
 
-  auto& hash_txs = txs.get<TxStore::by_key>();
-  auto wtx = hash_txs.find(hash);
-  if (wtx == hash_txs.end()) {
+  auto wtx = shard.txs.find(hash);
+  if (wtx == shard.txs.end()) {
     return {nullptr, false};
   }
 
-  if ((*wtx)->peers.contains(peer_id)) {
-    return {*wtx, true};
+  if (wtx->second->peers.contains(peer_id)) {
+    return {wtx->second, true};
   }
 
-  (*wtx)->peers.insert(peer_id);
-  return {*wtx, false};
+  wtx->second->peers.insert(peer_id);
+  return {wtx->second, false};
 }
 
 auto WrappedTxList::size() -> int {
@@ -9,14 +9,13 @@
 #include <noir/consensus/types/node_id.h>
 #include <tendermint/types/mempool.h>
 #include <tendermint/types/tx.h>
-#include <boost/multi_index/key.hpp>
-#include <boost/multi_index/member.hpp>
-#include <boost/multi_index/ordered_index.hpp>
-#include <boost/multi_index_container.hpp>
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <set>
 #include <shared_mutex>
+#include <unordered_map>
 
 namespace noir::mempool {
 
@@ -45,6 +44,10 @@ struct WrappedTx {
   auto ptr() -> WrappedTx*;
 };
 
+/// \brief stores txs with unique indexes by hash and by sender
+/// Both indexes are split into shards with their own locks, chosen by tx hash and by sender respectively, so
+/// admission, gossip lookups and removal after a block only contend on txs that land in the same shard. set_tx and
+/// remove_tx update the two indexes one after the other, each under its own shard lock.
 class TxStore {
 public:
   auto size() -> int;
@@ -52,33 +55,35 @@ public:
   auto get_tx_by_sender(const std::string& sender) -> std::shared_ptr<WrappedTx>;
   auto get_tx_by_hash(const types::TxKey& hash) -> std::shared_ptr<WrappedTx>;
   auto is_tx_removed(const types::TxKey& hash) -> bool;
+  /// \brief inserts wtx, replacing any tx stored under the same hash or sender; sets wtx->hash from its tx
   void set_tx(const std::shared_ptr<WrappedTx>& wtx);
   void remove_tx(const std::shared_ptr<WrappedTx>& wtx);
   auto tx_has_peer(const types::TxKey& hash, uint16_t peer_id) -> bool;
   auto get_or_set_peer_by_tx_hash(const types::TxKey& hash, uint16_t peer_id)
     -> std::pair<std::shared_ptr<WrappedTx>, bool>;
 
-  struct by_key;
-  struct by_sender;
+  static constexpr size_t num_shards = 16;
 
 private:
-  template<typename T>
-  using tag = boost::multi_index::tag<T>;
-
-  // clang-format off
-  using Txs = boost::multi_index_container<
-    std::shared_ptr<WrappedTx>,
-    boost::multi_index::indexed_by<
-      // FIXME: According to original implementation, following two indices should be ordered_unique,
-      // but put these ordered_non_unique temporarily for testing
-      boost::multi_index::ordered_non_unique<tag<by_key>, boost::multi_index::key<&WrappedTx::key>>,
-      boost::multi_index::ordered_non_unique<tag<by_sender>, boost::multi_index::key<&WrappedTx::sender>>
-    >
-  >;
-  // clang-format on
-
-  std::shared_mutex mtx;
-  Txs txs;
+  /// tx hashes are already uniformly distributed, so a slice of them is used as is
+  struct TxKeyHash {
+    auto operator()(const types::TxKey& key) const -> size_t;
+  };
+
+  template<typename Key, typename Hash>
+  struct Shard {
+    std::shared_mutex mtx;
+    std::unordered_map<Key, std::shared_ptr<WrappedTx>, Hash> txs;
+  };
+  using HashShard = Shard<types::TxKey, TxKeyHash>;
+  using SenderShard = Shard<std::string, std::hash<std::string>>;
+
+  auto hash_shard(const types::TxKey& hash) -> HashShard&;
+  auto sender_shard(const std::string& sender) -> SenderShard&;
+
+  std::array<HashShard, num_shards> hash_shards;
+  std::array<SenderShard, num_shards> sender_shards;
+  std::atomic<int> num_txs{0};
 };
 
 class WrappedTxList {
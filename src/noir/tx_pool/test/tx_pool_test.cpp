@@ -9,10 +9,10 @@
 #include <noir/common/plugin_interface.h>
 #include <noir/common/thread_pool.h>
 #include <noir/core/codec.h>
-#include <noir/tx_pool/LRU_cache.h>
 #include <noir/tx_pool/tx_pool.h>
 #include <noir/tx_pool/unapplied_tx_queue.h>
 #include <algorithm>
+#include <limits>
 #include <thread>
 
 using namespace noir;
@@ -384,6 +384,68 @@ TEST_CASE("unapplied_tx_queue: Indexing", "[noir][tx_pool]") {
   }
 }
 
+TEST_CASE("unapplied_tx_queue: Sender lanes", "[noir][tx_pool]") {
+  unapplied_tx_queue tx_queue;
+  auto make_tx = [](const std::string& sender, uint64_t nonce, uint64_t gas, const std::string& body) {
+    auto addr = str_to_addr(sender);
+    return wrapped_tx(addr, std::make_shared<consensus::tx>(body.begin(), body.end()), gas, nonce);
+  };
+
+  auto alice0 = make_tx("alice", 0, 10, "alice0");
+  auto alice1 = make_tx("alice", 1, 100, "alice1");
+  auto bob0 = make_tx("bob", 0, 50, "bob0");
+  auto bob2 = make_tx("bob", 2, 500, "bob2");
+  for (auto* wtx : {&alice1, &alice0, &bob0, &bob2}) {
+    CHECK(tx_queue.add_tx(*wtx));
+  }
+  CHECK(tx_queue.num_senders() == 2);
+  CHECK(tx_queue.is_ready(alice0.sender, 0));
+  CHECK(!tx_queue.is_ready(alice1.sender, 1));
+
+  SECTION("Reap in nonce order") {
+    // bob2 waits for the missing nonce 1, and alice1 only follows alice0 despite its higher gas
+    auto txs = tx_queue.reap(std::numeric_limits<uint64_t>::max(), std::numeric_limits<uint64_t>::max());
+    CHECK(txs.size() == 3);
+    CHECK(*txs[0] == *bob0.tx_ptr);
+    CHECK(*txs[1] == *alice0.tx_ptr);
+    CHECK(*txs[2] == *alice1.tx_ptr);
+
+    txs = tx_queue.reap(std::numeric_limits<uint64_t>::max(), 60);
+    CHECK(txs.size() == 2);
+    CHECK(*txs[0] == *bob0.tx_ptr);
+    CHECK(*txs[1] == *alice0.tx_ptr);
+  }
+
+  SECTION("Replace tx") {
+    auto replacement = make_tx("alice", 0, 1000, "alice0'");
+    CHECK(tx_queue.replace_tx(replacement));
+    CHECK(tx_queue.size() == 4);
+    CHECK(!tx_queue.has(alice0.hash));
+    CHECK(tx_queue.get_tx(alice0.sender, 0)->hash == replacement.hash);
+
+    auto txs = tx_queue.reap(std::numeric_limits<uint64_t>::max(), std::numeric_limits<uint64_t>::max());
+    CHECK(*txs[0] == *replacement.tx_ptr);
+
+    // fail case
+    auto missing = make_tx("carol", 0, 10, "carol0");
+    CHECK(!tx_queue.replace_tx(missing));
+    auto duplicate = make_tx("alice", 1, 10, "bob0");
+    CHECK(!tx_queue.replace_tx(duplicate));
+    CHECK(tx_queue.has(alice1.hash));
+  }
+
+  SECTION("Erase tx") {
+    CHECK(tx_queue.erase(alice0.hash));
+    CHECK(tx_queue.is_ready(alice1.sender, 1));
+    CHECK(tx_queue.erase(bob0.hash));
+    CHECK(tx_queue.is_ready(bob2.sender, 2));
+    CHECK(tx_queue.erase(alice1.hash));
+    CHECK(tx_queue.num_senders() == 1);
+    tx_queue.clear();
+    CHECK(tx_queue.num_senders() == 0);
+  }
+}
+
 TEST_CASE("tx_pool: Add/Get tx", "[noir][tx_pool]") {
   auto test_helper = std::make_unique<::test_helper>();
   auto test_app = std::make_shared<test_application>();
@@ -690,12 +752,12 @@ TEST_CASE("tx_pool: Broadcast tx", "[noir][tx_pool]") {
   thread->stop();
 }
 
-TEST_CASE("LRU_cache: Cache basic test", "[noir][tx_pool]") {
+TEST_CASE("clock_cache: Cache basic test", "[noir][tx_pool]") {
   auto test_helper = std::make_unique<::test_helper>();
   uint tx_count = 1000;
   uint cache_size = 1000;
 
-  LRU_cache<tx_hash, consensus::tx_ptr> c{cache_size};
+  clock_cache<tx_hash, consensus::tx_ptr> c{cache_size};
 
   struct test_tx {
     consensus::tx_ptr tx;
@@ -0,0 +1,91 @@
+// This file is part of NOIR.
+//
+// Copyright (c) 2022 Haderech Pte. Ltd.
+// SPDX-License-Identifier: AGPL-3.0-or-later
+//
+#include <catch2/catch_all.hpp>
+#include <noir/codec/scale.h>
+#include <noir/tx_pool/unapplied_tx_queue.h>
+#include <fmt/core.h>
+#include <algorithm>
+#include <limits>
+#include <random>
+
+using namespace noir;
+using namespace noir::consensus;
+using namespace noir::tx_pool;
+
+namespace {
+
+constexpr uint64_t num_txs = 1000000;
+constexpr uint64_t num_senders = 10000;
+
+/// num_txs txs spread round-robin over num_senders senders, so each sender holds a contiguous run of nonces
+auto make_wtxs(uint64_t id_offset = 0) -> std::vector<wrapped_tx> {
+  std::mt19937_64 generator{0};
+  std::uniform_int_distribution<uint64_t> dist_gas{1, 0xFFFF};
+  std::vector<address_type> senders;
+  senders.reserve(num_senders);
+  for (uint64_t i = 0; i < num_senders; i++) {
+    auto sender = fmt::format("sender{}", i);
+    senders.emplace_back(sender.begin(), sender.end());
+  }
+
+  std::vector<wrapped_tx> wtxs;
+  wtxs.reserve(num_txs);
+  for (uint64_t i = 0; i < num_txs; i++) {
+    auto tx = std::make_shared<consensus::tx>(codec::scale::encode(id_offset + i));
+    wtxs.emplace_back(senders[i % num_senders], tx, dist_gas(generator), i / num_senders);
+  }
+  return wtxs;
+}
+
+auto make_queue(std::vector<wrapped_tx>& wtxs) -> std::unique_ptr<unapplied_tx_queue> {
+  auto queue = std::make_unique<unapplied_tx_queue>(std::numeric_limits<uint64_t>::max());
+  for (auto& wtx : wtxs) {
+    queue->add_tx(wtx);
+  }
+  return queue;
+}
+
+} // namespace
+
+TEST_CASE("UnappliedTxQueueBenchmarks", "[noir][tx_pool]") {
+  auto wtxs = make_wtxs();
+  // same sender and nonce as wtxs, different tx bytes
+  auto replacements = make_wtxs(num_txs);
+
+  BENCHMARK_ADVANCED("AddTx")(Catch::Benchmark::Chronometer meter) {
+    auto queues = std::vector<std::unique_ptr<unapplied_tx_queue>>(meter.runs());
+    std::generate(queues.begin(), queues.end(),
+      []() { return std::make_unique<unapplied_tx_queue>(std::numeric_limits<uint64_t>::max()); });
+    meter.measure([&](int run) {
+      for (auto& wtx : wtxs) {
+        queues[run]->add_tx(wtx);
+      }
+    });
+  };
+
+  auto queue = make_queue(wtxs);
+  CHECK(queue->size() == num_txs);
+  CHECK(queue->num_senders() == num_senders);
+
+  BENCHMARK_ADVANCED("ReplaceTx")(Catch::Benchmark::Chronometer meter) {
+    // alternates between the two sets so every run replaces each tx exactly once
+    meter.measure([&](int run) {
+      auto& next = (run % 2) ? wtxs : replacements;
+      for (const auto& wtx : next) {
+        queue->replace_tx(wtx);
+      }
+    });
+  };
+
+  for (uint64_t max_bytes : {uint64_t(1024 * 1024), uint64_t(22020096), std::numeric_limits<uint64_t>::max()}) {
+    BENCHMARK(fmt::format("Reap_MaxBytes{}", max_bytes)) {
+      return queue->reap(max_bytes, std::numeric_limits<uint64_t>::max());
+    };
+  }
+
+  auto txs = queue->reap(std::numeric_limits<uint64_t>::max(), std::numeric_limits<uint64_t>::max());
+  CHECK(txs.size() == num_txs);
+}
@@ -47,6 +47,7 @@ void tx_pool::set_program_options(CLI::App& cfg) {
     ->add_option("--ttl_num_blocks", "Block height until tx expires in the pool. If it is '0', tx never expires")
     ->default_val(0);
   tx_pool_options->add_option("--gas_price_bump", "The minimum gas price for nonce override.")->default_val(1000);
+  tx_pool_options->add_option("--recheck_batch_size", "The number of txs rechecked between flushes.")->default_val(64);
 }
 
 void tx_pool::plugin_initialize(const CLI::App& config) {
@@ -59,6 +60,7 @@ void tx_pool::plugin_initialize(const CLI::App& config) {
     config_.ttl_duration = tx_pool_options->get_option("--ttl_duration")->as<tstamp>();
     config_.ttl_num_blocks = tx_pool_options->get_option("--ttl_num_blocks")->as<uint64_t>();
     config_.gas_price_bump = tx_pool_options->get_option("--gas_price_bump")->as<uint64_t>();
+    config_.recheck_batch_size = tx_pool_options->get_option("--recheck_batch_size")->as<uint32_t>();
   }
   FC_LOG_AND_RETHROW()
 }
@@ -135,12 +137,11 @@ void tx_pool::add_tx(
         fmt::format(
           "gas price is not enough for nonce override (tx_hash: {}, nonce: {})", tx_hash.to_string(), res.nonce));
     }
-    tx_queue_.erase(old_wtx.hash);
   }
 
   auto wtx = consensus::wrapped_tx(res.sender, tx_ptr, res.gas_wanted, res.nonce, block_height_);
 
-  if (!tx_queue_.add_tx(wtx)) {
+  if (!(old.has_value() ? tx_queue_.replace_tx(wtx) : tx_queue_.add_tx(wtx))) {
     if (!config_.keep_invalid_txs_in_cache) {
       tx_cache_.del(tx_hash);
     }
@@ -156,29 +157,7 @@ void tx_pool::add_tx(
 std::vector<std::shared_ptr<const consensus::tx>> tx_pool::reap_max_bytes_max_gas(
   uint64_t max_bytes, uint64_t max_gas) {
   std::scoped_lock lock(mutex_);
-  std::vector<std::shared_ptr<const consensus::tx>> txs;
-  auto rbegin = tx_queue_.rbegin<unapplied_tx_queue::by_gas>(max_gas);
-  auto rend = tx_queue_.rend<unapplied_tx_queue::by_gas>(0);
-  txs.reserve(max_gas / rbegin->gas());
-  uint64_t bytes = 0;
-  uint64_t gas = 0;
-  for (auto itr = rbegin; itr != rend; itr++) {
-    auto& wtx = itr->wtx;
-    auto& tx_ptr = wtx.tx_ptr;
-    if (gas + wtx.gas > max_gas) {
-      continue;
-    }
-
-    if (bytes + tx_ptr->size() > max_bytes) {
-      break;
-    }
-
-    bytes += tx_ptr->size();
-    gas += wtx.gas;
-    txs.push_back(tx_ptr);
-  }
-
-  return txs;
+  return tx_queue_.reap(max_bytes, max_gas);
 }
 
 std::vector<std::shared_ptr<const consensus::tx>> tx_pool::reap_max_txs(uint64_t tx_count) {
@@ -202,6 +181,8 @@ void tx_pool::update(uint64_t block_height,
   std::vector<consensus::response_deliver_tx> responses,
   precheck_func* new_precheck,
   postcheck_func* new_postcheck) {
+  // a recheck for the previous block holds mutex_, so it is stopped before the lock is taken
+  cancel_recheck();
   std::scoped_lock lock(mutex_);
   block_height_ = block_height;
 
@@ -251,12 +232,27 @@ void tx_pool::update(uint64_t block_height,
 }
 
 void tx_pool::update_recheck_txs() {
-  for (auto itr = tx_queue_.begin(); itr != tx_queue_.end(); itr++) {
+  auto generation = ++recheck_generation_;
+  auto batch_size = std::max<uint32_t>(config_.recheck_batch_size, 1);
+  uint32_t unflushed = 0;
+
+  // highest gas first, the same order txs are reaped in
+  auto rend = tx_queue_.rend<unapplied_tx_queue::by_gas>();
+  for (auto itr = tx_queue_.rbegin<unapplied_tx_queue::by_gas>(); itr != rend; itr++) {
+    if (recheck_generation_ != generation) {
+      break;
+    }
     auto& wtx = itr->wtx;
     proxy_app_->check_tx_async(consensus::request_check_tx{
       .tx = *wtx.tx_ptr,
       .type = consensus::check_tx_type::recheck,
     });
+    if (++unflushed >= batch_size) {
+      proxy_app_->flush_async();
+      unflushed = 0;
+    }
+  }
+  if (unflushed) {
     proxy_app_->flush_async();
   }
 }
@@ -283,6 +279,10 @@ void tx_pool::flush_app_conn() {
   proxy_app_->flush_sync();
 }
 
+void tx_pool::cancel_recheck() {
+  recheck_generation_++;
+}
+
 void tx_pool::broadcast_tx(const consensus::tx& tx) {
   dlog(fmt::format("broadcast tx (tx_hash: {})", consensus::get_tx_hash(tx).to_string()));
   auto new_env = std::make_shared<p2p::envelope>();
@@ -5,11 +5,11 @@
 //
 #pragma once
 
+#include <noir/common/clock_cache.h>
 #include <noir/common/plugin_interface.h>
 #include <noir/consensus/abci_types.h>
 #include <noir/consensus/app_connection.h>
 #include <noir/consensus/tx.h>
-#include <noir/tx_pool/LRU_cache.h>
 #include <noir/tx_pool/unapplied_tx_queue.h>
 #include <appbase/application.hpp>
 #include <fc/exception/exception.hpp>
@@ -29,6 +29,7 @@ struct config {
   tstamp ttl_duration{0};
   uint64_t ttl_num_blocks = 0;
   uint64_t gas_price_bump = 1000;
+  uint32_t recheck_batch_size = 64;
 };
 
 class tx_pool : public appbase::plugin<tx_pool> {
@@ -42,9 +43,10 @@ private:
   std::mutex mutex_;
   config config_;
   unapplied_tx_queue tx_queue_;
-  LRU_cache<consensus::tx_hash, consensus::tx_ptr> tx_cache_;
+  clock_cache<consensus::tx_hash, consensus::tx_ptr> tx_cache_;
 
   uint64_t block_height_ = 0;
+  std::atomic<uint64_t> recheck_generation_ = 0;
 
   precheck_func* precheck_ = nullptr;
   postcheck_func* postcheck_ = nullptr;
@@ -87,6 +89,8 @@ public:
   bool empty() const;
   void flush();
   void flush_app_conn();
+  /// stops a recheck in progress; update() calls it when a new block arrives, before taking the lock
+  void cancel_recheck();
 
 private:
   void check_tx_internal(const consensus::tx_hash& tx_hash, const consensus::tx_ptr& tx);
@@ -10,8 +10,10 @@
 #include <boost/multi_index/composite_key.hpp>
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/mem_fun.hpp>
+#include <boost/multi_index/member.hpp>
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index_container.hpp>
+#include <queue>
 
 namespace noir::tx_pool {
 
@@ -24,11 +26,11 @@ struct unapplied_tx {
   const uint64_t nonce() const {
     return wtx.nonce;
   }
-  const consensus::address_type sender() const {
+  const consensus::address_type& sender() const {
     return wtx.sender;
   }
-  const std::string hash() const {
-    return wtx.hash.to_string();
+  const consensus::tx_hash& hash() const {
+    return wtx.hash;
   }
   const uint64_t height() const {
     return wtx.height;
@@ -44,6 +46,14 @@ struct unapplied_tx {
   explicit unapplied_tx(const consensus::wrapped_tx& other): wtx(other) {}
 };
 
+/// \brief the txs of one sender that are waiting in the queue
+/// Only the head, the tx with the lowest nonce, can be executed next; the rest of the lane is found through by_nonce.
+struct sender_lane {
+  consensus::address_type sender;
+  uint64_t nonce;
+  uint64_t gas;
+};
+
 class unapplied_tx_queue {
 public:
   struct by_hash;
@@ -60,20 +70,16 @@ private:
     boost::multi_index::indexed_by<
       boost::multi_index::hashed_unique<
         boost::multi_index::tag<by_hash>,
-        boost::multi_index::const_mem_fun<unapplied_tx, const std::string, &unapplied_tx::hash>
+        boost::multi_index::const_mem_fun<unapplied_tx, const consensus::tx_hash&, &unapplied_tx::hash>
       >,
       boost::multi_index::ordered_non_unique<
         boost::multi_index::tag<by_gas>,
         boost::multi_index::const_mem_fun<unapplied_tx, const uint64_t, &unapplied_tx::gas>
       >,
-      boost::multi_index::hashed_non_unique<
-        boost::multi_index::tag<by_sender>,
-        boost::multi_index::const_mem_fun<unapplied_tx, const consensus::address_type, &unapplied_tx::sender>
-      >,
       boost::multi_index::ordered_unique<
         boost::multi_index::tag<by_nonce>,
         boost::multi_index::composite_key<unapplied_tx,
-          boost::multi_index::const_mem_fun<unapplied_tx, const consensus::address_type, &unapplied_tx::sender>,
+          boost::multi_index::const_mem_fun<unapplied_tx, const consensus::address_type&, &unapplied_tx::sender>,
           boost::multi_index::const_mem_fun<unapplied_tx, const uint64_t, &unapplied_tx::nonce>
         >
       >,
@@ -87,13 +93,50 @@ private:
       >
     >
   > unapplied_tx_queue_type;
+
+  // lane heads, indexed by sender and by the gas of the head tx
+  typedef boost::multi_index::multi_index_container<
+    sender_lane,
+    boost::multi_index::indexed_by<
+      boost::multi_index::hashed_unique<
+        boost::multi_index::tag<by_sender>,
+        boost::multi_index::member<sender_lane, consensus::address_type, &sender_lane::sender>
+      >,
+      boost::multi_index::ordered_non_unique<
+        boost::multi_index::tag<by_gas>,
+        boost::multi_index::member<sender_lane, uint64_t, &sender_lane::gas>
+      >
+    >
+  > sender_lanes_type;
   // clang-format on
 
   unapplied_tx_queue_type queue_;
+  sender_lanes_type lanes_;
   uint64_t max_tx_queue_bytes_size_ = 1024 * 1024 * 1024;
   uint64_t size_in_bytes_ = 0;
   size_t incoming_count_ = 0;
 
+  /// points the sender's lane at its lowest remaining nonce, or drops the lane when the sender has no txs left
+  void update_lane(const consensus::address_type& sender) {
+    auto& lanes = lanes_.get<by_sender>();
+    auto lane = lanes.find(sender);
+    auto head = queue_.get<by_nonce>().lower_bound(std::make_tuple(std::cref(sender)));
+    if (head == queue_.get<by_nonce>().end() || head->sender() != sender) {
+      if (lane != lanes.end()) {
+        lanes.erase(lane);
+      }
+      return;
+    }
+    if (lane == lanes.end()) {
+      lanes.insert(sender_lane{sender, head->nonce(), head->gas()});
+    } else if (lane->nonce != head->nonce() || lane->gas != head->gas()) {
+      lanes.modify(lane, [&](auto& l) {
+        l.nonce = head->nonce();
+        l.gas = head->gas();
+      });
+    }
+  }
+
 public:
   unapplied_tx_queue() = default;
 
@@ -115,6 +158,7 @@ public:
 
   void clear() {
     queue_.clear();
+    lanes_.clear();
     size_in_bytes_ = 0;
     incoming_count_ = 0;
   }
@@ -124,11 +168,11 @@ public:
   }
 
   bool has(const consensus::tx_hash& tx_hash) const {
-    return queue_.get<by_hash>().find(tx_hash.to_string()) != queue_.get<by_hash>().end();
+    return queue_.get<by_hash>().find(tx_hash) != queue_.get<by_hash>().end();
   }
 
   std::optional<const consensus::wrapped_tx> get_tx(const consensus::tx_hash& tx_hash) const {
-    auto itr = queue_.get<by_hash>().find(tx_hash.to_string());
+    auto itr = queue_.get<by_hash>().find(tx_hash);
     if (itr == queue_.get<by_hash>().end()) {
       return {};
     }
@@ -153,11 +197,89 @@ public:
     if (res.second) {
       size_in_bytes_ += bytes_size(wtx);
       incoming_count_++;
+      update_lane(wtx.sender);
     }
 
     return true;
   }
 
+  /// \brief replaces the tx of the same sender and nonce in place
+  /// \return false if there is no such tx, wtx's hash is already queued, or the queue would overflow
+  bool replace_tx(const consensus::wrapped_tx& wtx) {
+    auto& nonce_index = queue_.get<by_nonce>();
+    auto itr = nonce_index.find(std::make_tuple(std::cref(wtx.sender), wtx.nonce));
+    if (itr == nonce_index.end()) {
+      return false;
+    }
+
+    auto old = itr->wtx;
+    auto old_size = bytes_size(old);
+    auto size = bytes_size(wtx);
+    if (size_in_bytes_ - old_size + size > max_tx_queue_bytes_size_) {
+      return false;
+    }
+    // rolls back instead of dropping the old tx when wtx's hash is already queued
+    if (!nonce_index.modify(itr, [&](auto& tx) { tx.wtx = wtx; }, [&](auto& tx) { tx.wtx = old; })) {
+      return false;
+    }
+    size_in_bytes_ = size_in_bytes_ - old_size + size;
+    update_lane(wtx.sender);
+    return true;
+  }
+
+  /// \brief true if the tx is the lowest nonce of its sender, so nothing else from the sender has to run before it
+  bool is_ready(const consensus::address_type& sender, uint64_t nonce) const {
+    auto lane = lanes_.get<by_sender>().find(sender);
+    return lane != lanes_.get<by_sender>().end() && lane->nonce == nonce;
+  }
+
+  size_t num_senders() const {
+    return lanes_.size();
+  }
+
+  /// \brief returns txs in an order they can be executed in, picking the ready tx with the most gas each time
+  /// A sender's txs come out in nonce order, and a lane stops at a nonce gap. A tx over the remaining gas is skipped
+  /// along with the rest of its lane; the first tx over the remaining bytes ends the reap.
+  std::vector<std::shared_ptr<const consensus::tx>> reap(uint64_t max_bytes, uint64_t max_gas) const {
+    // lane heads come in gas order from by_gas; only the txs following a reaped head go through the heap
+    using nonce_iterator = unapplied_tx_queue_type::index<by_nonce>::type::const_iterator;
+    auto cmp = [](const nonce_iterator& a, const nonce_iterator& b) { return a->gas() < b->gas(); };
+    auto next_txs = std::priority_queue<nonce_iterator, std::vector<nonce_iterator>, decltype(cmp)>(cmp);
+    auto& nonce_index = queue_.get<by_nonce>();
+    auto& gas_index = lanes_.get<by_gas>();
+    auto lane = gas_index.rbegin();
+
+    std::vector<std::shared_ptr<const consensus::tx>> txs;
+    uint64_t bytes = 0;
+    uint64_t gas = 0;
+    while (lane != gas_index.rend() || !next_txs.empty()) {
+      nonce_iterator itr;
+      if (!next_txs.empty() && (lane == gas_index.rend() || next_txs.top()->gas() > lane->gas)) {
+        itr = next_txs.top();
+        next_txs.pop();
+      } else {
+        itr = nonce_index.find(std::make_tuple(std::cref(lane->sender), lane->nonce));
+        lane++;
+      }
+      auto& wtx = itr->wtx;
+      if (gas + wtx.gas > max_gas) {
+        continue;
+      }
+      if (bytes + wtx.tx_ptr->size() > max_bytes) {
+        break;
+      }
+      bytes += wtx.tx_ptr->size();
+      gas += wtx.gas;
+      txs.push_back(wtx.tx_ptr);
+
+      if (auto next = std::next(itr); next != nonce_index.end() && next->sender() == wtx.sender &&
+          next->nonce() == wtx.nonce + 1) {
+        next_txs.push(next);
+      }
+    }
+    return txs;
+  }
+
   template<typename Tag>
   using iterator = typename unapplied_tx_queue_type::index<Tag>::type::iterator;
 
@@ -222,10 +344,6 @@ public:
   }
 
   bool erase(const consensus::tx_hash& tx_hash) {
-    return erase(tx_hash.to_string());
-  }
-
-  bool erase(const std::string& tx_hash) {
     auto itr = queue_.get<by_hash>().find(tx_hash);
     if (itr == queue_.get<by_hash>().end()) {
       return false;
@@ -233,7 +351,9 @@ public:
 
     incoming_count_--;
     size_in_bytes_ -= bytes_size(itr->wtx);
+    auto sender = itr->sender();
     queue_.get<by_hash>().erase(itr);
+    update_lane(sender);
     return true;
   }
 
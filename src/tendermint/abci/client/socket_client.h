@@ -7,6 +7,7 @@
 #include <noir/net/conn.h>
 #include <tendermint/abci/client/client.h>
 #include <tendermint/abci/types/messages.h>
+#include <span>
 #include <tendermint/service/service.h>
 #include <eo/sync.h>
 #include <eo/time.h>
@@ -112,6 +113,31 @@ public:
     return queue_request_async(to_request_check_tx(req));
   }
 
+  /// \brief queues a check_tx request per tx followed by a single flush
+  /// All requests enter the request queue from one coroutine instead of one invoke per request. Once the connection has
+  /// failed, queued requests are drained without being sent, so every request gets the connection error.
+  std::vector<Result<std::shared_ptr<ReqRes>>> check_txs_async(std::span<const RequestCheckTx> reqs) {
+    auto requests = std::vector<std::unique_ptr<Request>>();
+    requests.reserve(reqs.size() + 1);
+    for (const auto& req : reqs) {
+      requests.push_back(to_request_check_tx(req));
+    }
+    requests.push_back(to_request_flush());
+
+    auto queued = queue_requests(std::move(requests));
+    auto ok = queued ? error() : Result<void>(queued.error());
+    auto results = std::vector<Result<std::shared_ptr<ReqRes>>>();
+    results.reserve(reqs.size());
+    for (size_t i = 0; i < reqs.size(); i++) {
+      if (!ok) {
+        results.push_back(ok.error());
+      } else {
+        results.push_back(std::move(queued.value()[i]));
+      }
+    }
+    return results;
+  }
+
   Result<std::shared_ptr<ReqRes>> query_async(const RequestQuery& req) {
     return queue_request_async(to_request_query(req));
   }
@@ -297,6 +323,27 @@ private:
     return reqres;
   }
 
+  Result<std::vector<std::shared_ptr<ReqRes>>> queue_requests(std::vector<std::unique_ptr<Request>> reqs) {
+    auto reqres = std::vector<std::shared_ptr<ReqRes>>();
+    reqres.reserve(reqs.size());
+    for (auto& req : reqs) {
+      reqres.push_back(std::make_shared<ReqRes>());
+      std::swap(reqres.back()->request, req);
+    }
+
+    invoke([&]() -> func<> {
+      for (const auto& r : reqres) {
+        auto select = Select{(req_queue << r)};
+        switch (co_await select.index()) {
+        case 0:
+          co_await select.template process<0>();
+        }
+      }
+    });
+
+    return reqres;
+  }
+
   Result<std::shared_ptr<ReqRes>> queue_request_async(std::unique_ptr<Request> req) {
     auto ok = queue_request(std::move(req));
     if (!ok) {
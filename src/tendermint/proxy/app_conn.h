@@ -7,6 +7,7 @@
 #include <noir/core/core.h>
 #include <tendermint/abci/client/client.h>
 #include <tendermint/abci/types.pb.h>
+#include <span>
 
 namespace noir::proxy {
 
@@ -27,6 +28,32 @@ public:
     return app_conn->check_tx_async(req);
   }
 
+  /// \brief sends a check_tx per request followed by a single flush
+  /// Sending stops at the first request the client fails to queue, and its error is reported for that request and every
+  /// request after it. The requests queued before it keep their ReqRes even if the flush fails, as they go out with the
+  /// next flush.
+  /// \return for each request, its ReqRes or why it was not sent
+  auto check_txs_async(std::span<const abci::RequestCheckTx> reqs)
+    -> std::vector<Result<std::shared_ptr<abci::ReqRes>>> {
+    if constexpr (requires { app_conn->check_txs_async(reqs); }) {
+      return app_conn->check_txs_async(reqs);
+    } else {
+      auto results = std::vector<Result<std::shared_ptr<abci::ReqRes>>>();
+      results.reserve(reqs.size());
+      for (const auto& req : reqs) {
+        results.push_back(app_conn->check_tx_async(req));
+        if (!results.back()) {
+          auto err = results.back().error();
+          results.resize(reqs.size(), err);
+          break;
+        }
+      }
+      // a failed flush doesn't take back the queued requests, so they stay in results
+      (void)app_conn->flush_async();
+      return results;
+    }
+  }
+
   auto check_tx_sync(const abci::RequestCheckTx& req) -> Result<std::unique_ptr<abci::ResponseCheckTx>> {
     return app_conn->check_tx_sync(req);
   }
@@ -7,6 +7,8 @@
 #include <noir/common/bytes.h>
 #include <noir/crypto/hash/sha2.h>
 #include <tendermint/types/mempool.h>
+#include <bit>
+#include <span>
 
 // FIXME: put this under tendermint later
 namespace noir::types {
@@ -22,4 +24,14 @@ struct Tx : public Bytes {
   }
 };
 
+/// \brief returns the encoded size of txs as the repeated txs field of tendermint.types.Data
+/// Each tx takes a one-byte field tag and its varint length on top of its bytes, so no encoding is needed.
+inline int64_t compute_proto_size_for_txs(std::span<const Tx> txs) {
+  int64_t size = 0;
+  for (const auto& tx : txs) {
+    size += 1 + (std::bit_width(tx.size() | 1) + 6) / 7 + tx.size();
+  }
+  return size;
+}
+
 } // namespace noir::types